@@ -0,0 +1,61 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <dynamo/asyncFileWriter.hpp>
+#include <dynamo/fileCompression.hpp>
+#include <boost/iostreams/device/file.hpp>
+#include <iostream>
+
+namespace dynamo {
+  AsyncFileWriter::AsyncFileWriter(size_t maxQueued):
+    magnet::thread::WorkerQueue<detail::FileJob>(maxQueued, "Failed to write a file in the background")
+  { start(); }
+
+  AsyncFileWriter::~AsyncFileWriter()
+  {
+    const std::string error = stop();
+    if (!error.empty())
+      std::cerr << "AsyncFileWriter: A file was not written\n" << error << std::endl;
+  }
+
+  void 
+  AsyncFileWriter::write(const std::string& fileName, std::string& data)
+  {
+    detail::FileJob job;
+    job.fileName = fileName;
+    job.data.swap(data);
+    push(job);
+  }
+
+  void 
+  AsyncFileWriter::process(detail::FileJob& job)
+  {
+    namespace io = boost::iostreams;
+
+    //Release the buffer, whatever happens to the file
+    std::string data;
+    data.swap(job.data);
+
+    io::filtering_ostream os;
+    pushCompressor(os, job.fileName);
+    os.push(io::file_sink(job.fileName, std::ios_base::out | std::ios_base::binary));
+    os.write(data.data(), data.size());
+    if (!os)
+      M_throw() << "Could not write to the file " << job.fileName;
+    //Closing the chain writes the end of any compressed stream
+    os.reset();
+  }
+}
@@ -0,0 +1,82 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include <magnet/thread/workerQueue.hpp>
+#include <string>
+
+namespace dynamo {
+  namespace detail {
+    //! \brief A file to be written by the \ref AsyncFileWriter.
+    struct FileJob
+    {
+      std::string fileName;
+      std::string data;
+    };
+
+    inline void swap(FileJob& a, FileJob& b)
+    {
+      a.fileName.swap(b.fileName);
+      a.data.swap(b.data);
+    }
+  }
+
+  /*! \brief Writes buffers of data to files using a background
+      thread.
+
+    This allows the event loop to render a file into memory (which is
+    fast) and continue with the simulation while the file is
+    compressed and written to disk (which is slow). The compression
+    is selected by the file extension, as for the files written
+    directly by the \ref Simulation (see \ref pushCompressor), but
+    bzip2 files are compressed by the writer thread alone.
+
+    The number of buffers held by the writer is bounded. If the disk
+    cannot keep up, \ref write blocks until a buffer has been written
+    so the memory used cannot grow without limit.
+   */
+  class AsyncFileWriter: private magnet::thread::WorkerQueue<detail::FileJob>
+  {
+  public:
+    /*! \brief Constructor, this starts the writer thread.
+      
+      \param maxQueued The largest number of buffers held by the
+      writer (including the one being written).
+     */
+    AsyncFileWriter(size_t maxQueued = 2);
+
+    //! \brief Writes out any queued buffers before stopping the thread.
+    ~AsyncFileWriter();
+
+    /*! \brief Queue a buffer to be written to a file.
+
+      \param fileName The path of the file to write, which is created
+      or overwritten.
+      \param data The contents of the file. The buffer is swapped
+      out, leaving data empty.
+
+      If a previous write failed, the error is thrown from here (or
+      from \ref flush).
+     */
+    void write(const std::string& fileName, std::string& data);
+
+    //! \brief Block until all of the queued buffers have been written.
+    void flush() { wait(); }
+
+  private:
+    virtual void process(detail::FileJob& job);
+  };
+}
@@ -63,9 +63,9 @@ namespace dynamo {
       ("n-threads,N", po::value<unsigned int>(),
        "Number of threads to spawn for concurrent processing. (Only utilised by certain engine/sim configurations)")
       ("out-config-file,o", po::value<std::string>(),
-       "Default config output file,(config.%ID.end.xml.bz2)")
+       "Default config output file,(config.%ID.end.xml.bz2). A .bin, .bin.bz2 or .bin.gz extension writes the binary format. A .bz2 file is compressed using the --n-threads threads, a .gz file is written faster but larger.")
       ("out-data-file", po::value<std::string>(),
-       "Default result output file (output.%ID.xml.bz2)")
+       "Default result output file (output.%ID.xml.bz2). A .gz extension selects gzip compression.")
       ("config-file", po::value<std::vector<std::string> >(),
        "Specify a config file to load, or just list them on the command line")
       ;
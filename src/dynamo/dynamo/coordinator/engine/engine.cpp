@@ -22,6 +22,10 @@
 #include <dynamo/outputplugins/0partproperty/misc.hpp>
 #include <dynamo/systems/visualizer.hpp>
 #include <dynamo/systems/snapshot.hpp>
+#include <dynamo/systems/reorder.hpp>
+#include <dynamo/schedulers/profiler.hpp>
+#include <dynamo/outputplugins/pipeline.hpp>
+#include <dynamo/dynamics/dynamics.hpp>
 #include <limits>
 
 
@@ -50,6 +54,13 @@ namespace dynamo {
       ("unwrapped", "Don't apply the boundary conditions of the system when writing out the particle positions.")
       ("snapshot", boost::program_options::value<double>(),
        "Sets the system time inbetween saving snapshots of the system.")
+      ("reorder", boost::program_options::value<double>(),
+       "Sets the system time inbetween renumbering the particles along a space-filling curve to improve memory locality.")
+      ("profile", "Profile the time spent in each phase of the event loop, by event source and type, and add it to the output file.")
+      ("profile-csv", boost::program_options::value<std::string>(),
+       "Also write the cumulative event loop profile to this CSV file at each periodic output (implies --profile).")
+      ("particle-soa", "Maintain a structure-of-arrays copy of the particle positions and velocities for the vectorised event predictors.")
+      ("async-output", "Process the output plugins which only use the particle changes of the events (e.g., MeanFreeLength, CollisionMatrix, EventEffects) in batches on a separate thread.")
       ;
   
     opts.add(simopts);
@@ -89,6 +100,32 @@ namespace dynamo {
     Sim.loadXMLfile(filename.c_str());
     
     Sim.status = CONFIG_LOADED;
+
+    if (vm.count("particle-soa"))
+      Sim.dynamics->enableParticleSoA();
+
+    if (vm.count("async-output"))
+      {
+	if (dynamic_cast<const EReplicaExchangeSimulation*>(this) != NULL)
+	  M_throw() << "Asynchronous output is not available for replica exchange simulations";
+
+	Sim.outputPipeline.reset(new OutputPipeline(&Sim));
+      }
+
+    if (vm.count("profile") || vm.count("profile-csv"))
+      {
+	std::string csvFile;
+	if (vm.count("profile-csv"))
+	  {
+	    if (dynamic_cast<const EReplicaExchangeSimulation*>(this) != NULL)
+	      M_throw() << "The CSV profile is not available for replica exchange simulations";
+
+	    csvFile = vm["profile-csv"].as<std::string>();
+	  }
+
+	Sim.profiler.reset(new EventProfiler(&Sim, csvFile));
+      }
+
     Sim.endEventCount = vm["events"].as<size_t>();
   
     if (vm["events"].as<size_t>() 
@@ -107,6 +144,9 @@ namespace dynamo {
     if (vm.count("snapshot"))
       Sim.systems.push_back(shared_ptr<System>(new SSnapshot(&Sim, vm["snapshot"].as<double>(), "SnapshotEvent", !vm.count("unwrapped"))));
 
+    if (vm.count("reorder"))
+      Sim.systems.push_back(shared_ptr<System>(new SReorder(&Sim, vm["reorder"].as<double>(), "ReorderEvent")));
+
     if (vm.count("load-plugin"))
       {
 	BOOST_FOREACH(const std::string& tmpString, 
@@ -26,6 +26,7 @@
 #include <boost/random/uniform_int.hpp>
 #include <fstream>
 #include <limits>
+#include <cmath>
 #include <signal.h>
 
 namespace dynamo {
@@ -49,7 +50,9 @@ namespace dynamo {
        "  1: \tAlternating sets of pairs (~Nsims/2 attempts per swap event)\n"
        "  2: \tRandom pair per swap\n"
        "  3: \t5 * Nsim random pairs per swap\n"
-       "  4: \tRandom selection of the above methods")
+       "  4: \tRandom selection of the above methods\n"
+       "  5: \tAlternating sets of pairs, each pair is swapped as soon as\n"
+       "    \tboth have finished (no barrier between the Simulations)")
       ;
   
     opts.add(ropts);
@@ -63,7 +66,8 @@ namespace dynamo {
     replexSwapCalls(0),
     round_trips(0),
     SeqSelect(false),
-    nSims(0)
+    nSims(0),
+    _replicaFailed(false)
   {
     if (vm["events"].as<size_t>() != std::numeric_limits<size_t>::max())
       M_throw() << "You cannot use collisions to control a replica exchange simulation\n"
@@ -214,6 +218,8 @@ namespace dynamo {
       {
       case NoSwapping:
 	break;
+      case AsynchronousPairs:
+	M_throw() << "Asynchronous replica exchanges are attempted in runAsynchronous()";
       case SinglePair:
 	{
 	  if (temperatureList.size() == 2)
@@ -285,37 +291,51 @@ namespace dynamo {
     //Update the counters indicating the replexSwap count
     ++replexSwapCalls;
 
-    for (size_t i(0); i < nSims; ++i)
-      ++(Simulations[i].replexExchangeNumber);
+    for (size_t tempID(0); tempID < temperatureList.size(); ++tempID)
+      ReplexTemperatureTicker(tempID);
+  }
+
+  void 
+  EReplicaExchangeSimulation::ReplexTemperatureTicker(const size_t tempID)
+  {
+    simData& dat = temperatureList[tempID].second;
+
+    ++(Simulations[dat.simID].replexExchangeNumber);
 
     //Now update the histogramming
-    BOOST_FOREACH(replexPair& dat, temperatureList)
-      if (SimDirection[dat.second.simID])
-	{
-	  if (SimDirection[dat.second.simID] > 0)
-	    ++dat.second.upSims;
-	  else
-	    ++dat.second.downSims;
-	}
+    if (SimDirection[dat.simID])
+      {
+	if (SimDirection[dat.simID] > 0)
+	  ++dat.upSims;
+	else
+	  ++dat.downSims;
+      }
 
-    if (SimDirection[temperatureList.front().second.simID] == -1)
+    if (tempID == 0)
       {
-	if (roundtrip[temperatureList.front().second.simID])
-	  ++round_trips;
+	if (SimDirection[dat.simID] == -1)
+	  {
+	    if (roundtrip[dat.simID])
+	      ++round_trips;
+	    
+	    roundtrip[dat.simID] = true;
+	  }
 	
-	roundtrip[temperatureList.front().second.simID] = true;
+	SimDirection[dat.simID] = 1; //Going up
       }
- 
-    if (SimDirection[temperatureList.back().second.simID] == 1)
+
+    if (tempID == temperatureList.size() - 1)
       {
-	if (roundtrip[temperatureList.back().second.simID])
-	  ++round_trips;
+	if (SimDirection[dat.simID] == 1)
+	  {
+	    if (roundtrip[dat.simID])
+	      ++round_trips;
+	    
+	    roundtrip[dat.simID] = true;
+	  }
 
-	roundtrip[temperatureList.back().second.simID] = true;
+	SimDirection[dat.simID] = -1; //Going down
       }
-
-    SimDirection[temperatureList.front().second.simID] = 1; //Going up
-    SimDirection[temperatureList.back().second.simID] = -1; //Going down
   }
 
   void 
@@ -343,7 +363,7 @@ namespace dynamo {
   }
 
   void
-  EReplicaExchangeSimulation::outputData()
+  EReplicaExchangeSimulation::outputReplexStats()
   {
     {
       std::fstream replexof("replex.dat",std::ios::out | std::ios::trunc);
@@ -367,9 +387,30 @@ namespace dynamo {
 	       << "\nTime_spent_replexing " <<  boost::posix_time::to_simple_string(end_Time - start_Time)
 	       << "\nReplex Rate " << static_cast<double>(replexSwapCalls) / static_cast<double>((end_Time - start_Time).total_seconds())
 	       << "\n";	
+
+      //The throughput of each temperature, the wait time is the time
+      //spent idle at the exchanges
+      replexof << "\nT Runs Events Run_time Wait_time Events/s Busy_fraction Attempts Swaps\n";
+      BOOST_FOREACH(const replexPair& myPair, temperatureList)
+	replexof << myPair.second.realTemperature << " " 
+		 << myPair.second.runs << " " 
+		 << myPair.second.events << " " 
+		 << myPair.second.runTime << " " 
+		 << myPair.second.waitTime << " " 
+		 << myPair.second.events / myPair.second.runTime << " " 
+		 << myPair.second.runTime / (myPair.second.runTime + myPair.second.waitTime) << " "
+		 << myPair.second.attempts << " "
+		 << myPair.second.swaps
+		 << "\n";
     
       replexof.close();
     }    
+  }
+
+  void
+  EReplicaExchangeSimulation::outputData()
+  {
+    outputReplexStats();
   
     int i = 0;
   
@@ -378,187 +419,368 @@ namespace dynamo {
       ((magnet::string::search_replace(outputFormat, "%ID", boost::lexical_cast<std::string>(i++))).c_str());
   }
 
-  void EReplicaExchangeSimulation::runSimulation()
+  double 
+  EReplicaExchangeSimulation::wallTime() const
   {
-    clock_gettime(CLOCK_MONOTONIC, &_startTime);
-    start_Time = boost::posix_time::second_clock::local_time();
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    
+    return double(now.tv_sec) - double(_startTime.tv_sec)
+      + 1e-9 * (double(now.tv_nsec) - double(_startTime.tv_nsec));
+  }
 
-    while (((Simulations[0].systemTime / Simulations[0].units.unitTime()) < replicaEndTime)
-	   && (Simulations[0].eventCount < vm["events"].as<size_t>()))
+  void 
+  EReplicaExchangeSimulation::handleSIGINT()
+  {
+    //Clear the writes to screen
+    std::cout.flush();
+    std::cerr << "\n<S>hutdown, <D>ata or <P>eek at data output:";
+    
+    char c;
+    //Clear the input buffer
+    std::cin.clear();
+    setvbuf(stdin, NULL, _IONBF, 0);
+    c=getchar();
+    setvbuf(stdin, NULL, _IOLBF, 0);
+    switch (c)
       {
-	if (_SIGINT)
-	  {
-	    //Clear the writes to screen
-	    std::cout.flush();
-	    std::cerr << "\n<S>hutdown, <D>ata or <P>eek at data output:";
-	      
-	    char c;
-	    //Clear the input buffer
-	    std::cin.clear();
-	    setvbuf(stdin, NULL, _IONBF, 0);
-	    c=getchar();
-	    setvbuf(stdin, NULL, _IOLBF, 0);
-	    switch (c)
-	      {
-	      case 's':
-	      case 'S':
-		{
-		  replicaEndTime = 0.0;
-		  for (unsigned int i = 0; i < nSims; i++)
-		    Simulations[i].simShutdown();
-		  continue;
-		  break;
-		}
-	      case 'p':
-	      case 'P':
-		{
-		  end_Time = boost::posix_time::second_clock::local_time();
-		  
-		  size_t i = 0;
-		  BOOST_FOREACH(replexPair p1, temperatureList)
-		    {
-		      Simulations[p1.second.simID].endEventCount = vm["events"].as<size_t>();
-		      Simulations[p1.second.simID].outputData((magnet::string::search_replace(std::string("peek.data.%ID.xml.bz2"), 
-											      "%ID", boost::lexical_cast<std::string>(i++))));
-		    }
-		  
-		  {
-		    std::fstream replexof("replex.dat",std::ios::out | std::ios::trunc);
-		    
-		    BOOST_FOREACH(const replexPair& myPair, temperatureList)
-		      replexof << myPair.second.realTemperature << " " 
-			       << myPair.second.swaps << " " 
-			       << (static_cast<double>(myPair.second.swaps) 
-				   / static_cast<double>(myPair.second.attempts))  << " "
-			       << myPair.second.upSims << " "
-			       << myPair.second.downSims
-			       << "\n";
-		    
-		    replexof.close();      
-		  }
-		  
-		  {      
-		    std::fstream replexof("replex.stats", std::ios::out | std::ios::trunc);
-		    
-		    replexof << "Number_of_replex_cycles " << replexSwapCalls
-			     << "\nTime_spent_replexing " <<  boost::posix_time::to_simple_string(end_Time - start_Time)
-			     << "\nReplex Rate " << static_cast<double>(replexSwapCalls) / static_cast<double>((end_Time - start_Time).total_seconds())
-			     << "\n";	
-		    
-		    replexof.close();
-		  }		  
-		  break;
-		}
-	      case 'd':
-	      case 'D':
-		{
-		  std::cout << "Replica Exchange, ReplexSwap No." << replexSwapCalls 
-			    << ", Round Trips " << round_trips
-			    << "\n        T   ID     NColl   A-Ratio     Swaps    UpSims     DownSims\n";
-
-		  BOOST_FOREACH(const replexPair& dat, temperatureList)
-		    {       
-		      std::cout << std::setw(9)
-				<< Simulations[dat.second.simID].ensemble->getReducedEnsembleVals()[2] 
-				<< " " << std::setw(4)
-				<< dat.second.simID
-				<< " " << std::setw(8)
-				<< Simulations[dat.second.simID].eventCount/1000 << "k" 
-				<< " " << std::setw(9)
-				<< ( static_cast<double>(dat.second.swaps) / dat.second.attempts)
-				<< " " << std::setw(9)
-				<< dat.second.swaps 
-				<< " " << std::setw(9)
-				<< dat.second.upSims
-				<< " "
-				<< (SimDirection[dat.second.simID] > 0 ? "/\\" : "  ")
-				<< " " << std::setw(9)
-				<< dat.second.downSims
-				<< " "
-				<< (SimDirection[dat.second.simID] < 0 ? "\\/" : "  ")
-				<< "\n";
-		    }
-		  break;
-		}
-	      }
-	      
-	    _SIGINT = false;
+      case 's':
+      case 'S':
+	{
+	  replicaEndTime = 0.0;
+	  for (unsigned int i = 0; i < nSims; i++)
+	    Simulations[i].simShutdown();
+	  break;
+	}
+      case 'p':
+      case 'P':
+	{
+	  end_Time = boost::posix_time::second_clock::local_time();
+	  
+	  size_t i = 0;
+	  BOOST_FOREACH(replexPair p1, temperatureList)
 	    {
-	      struct sigaction new_action;
-	      new_action.sa_handler = Coordinator::signal_handler;
-	      sigemptyset(&new_action.sa_mask);
-	      new_action.sa_flags = 0;
-	      sigaction(SIGINT, &new_action, NULL);
+	      Simulations[p1.second.simID].endEventCount = vm["events"].as<size_t>();
+	      Simulations[p1.second.simID].outputData((magnet::string::search_replace(std::string("peek.data.%ID.xml.bz2"), 
+										      "%ID", boost::lexical_cast<std::string>(i++))));
 	    }
-	  }
-	  {
-	    //Run the simulations. We also generate all tasks at once
-	    //and submit them all at once to minimise lock contention.
-	    std::vector<magnet::function::Task*> tasks(nSims, NULL);
 	  
-	    for (size_t i(0); i < nSims; ++i)
-	      tasks[i] = magnet::function::Task::makeTask(&Simulation::runSimulation, &static_cast<Simulation&>(Simulations[i]), true);
+	  outputReplexStats();
+	  break;
+	}
+      case 'd':
+      case 'D':
+	{
+	  std::cout << "Replica Exchange, ReplexSwap No." << replexSwapCalls 
+		    << ", Round Trips " << round_trips
+		    << "\n        T   ID     NColl   A-Ratio     Swaps    UpSims     DownSims\n";
+	  
+	  BOOST_FOREACH(const replexPair& dat, temperatureList)
+	    {       
+	      std::cout << std::setw(9)
+			<< Simulations[dat.second.simID].ensemble->getReducedEnsembleVals()[2] 
+			<< " " << std::setw(4)
+			<< dat.second.simID
+			<< " " << std::setw(8)
+			<< Simulations[dat.second.simID].eventCount/1000 << "k" 
+			<< " " << std::setw(9)
+			<< ( static_cast<double>(dat.second.swaps) / dat.second.attempts)
+			<< " " << std::setw(9)
+			<< dat.second.swaps 
+			<< " " << std::setw(9)
+			<< dat.second.upSims
+			<< " "
+			<< (SimDirection[dat.second.simID] > 0 ? "/\\" : "  ")
+			<< " " << std::setw(9)
+			<< dat.second.downSims
+			<< " "
+			<< (SimDirection[dat.second.simID] < 0 ? "\\/" : "  ")
+			<< "\n";
+	    }
+	  break;
+	}
+      }
+    
+    _SIGINT = false;
+    {
+      struct sigaction new_action;
+      new_action.sa_handler = Coordinator::signal_handler;
+      sigemptyset(&new_action.sa_mask);
+      new_action.sa_flags = 0;
+      sigaction(SIGINT, &new_action, NULL);
+    }
+  }
 
-	    threads.queueTasks(tasks);
-	    threads.wait();//This syncs the systems for the replica exchange
-		  
-	    //Swap calculation
-	    ReplexSwap(ReplexMode);
-		  
-	    ReplexSwapTicker();
-		  
-	    //Reset the stop events
-	    for (size_t i = nSims; i != 0;)
-	      {
-		//Reset the stop event
-		shared_ptr<SystHalt> tmpRef = std::tr1::dynamic_pointer_cast<SystHalt>
-		  (Simulations[--i].systems["ReplexHalt"]);
-		
+  void
+  EReplicaExchangeSimulation::resetHalt(const size_t tempID)
+  {
+    Simulation& sim = Simulations[temperatureList[tempID].second.simID];
+
+    //Reset the stop event
+    shared_ptr<SystHalt> tmpRef = std::tr1::dynamic_pointer_cast<SystHalt>
+      (sim.systems["ReplexHalt"]);
+    
 #ifdef DYNAMO_DEBUG
-		if (!tmpRef)
-		  M_throw() << "Could not find the time halt event error";
+    if (!tmpRef)
+      M_throw() << "Could not find the time halt event error";
 #endif			
-		//Each simulations exchange time is inversly proportional to its temperature
-		double tFactor 
-		  = std::sqrt(temperatureList.begin()->second.realTemperature
-			      / Simulations[i].ensemble->getReducedEnsembleVals()[2]); 
+    //Each simulations exchange time is inversly proportional to its temperature
+    double tFactor 
+      = std::sqrt(temperatureList.begin()->second.realTemperature
+		  / sim.ensemble->getReducedEnsembleVals()[2]); 
+    
+    tmpRef->increasedt(vm["replex-interval"].as<double>() * tFactor);
+    
+    sim.ptrScheduler->rebuildSystemEvents();
+    
+    //Reset the max collisions
+    sim.endEventCount = vm["events"].as<size_t>();
+  }
 
-		tmpRef->increasedt(vm["replex-interval"].as<double>() * tFactor);
+  void
+  EReplicaExchangeSimulation::printProgress()
+  {
+    double duration = wallTime();
+    
+    double fractionComplete = (Simulations[0].systemTime / Simulations[0].units.unitTime()) / replicaEndTime;
+    double seconds_remaining_double = duration * (1/ fractionComplete - 1);
+    size_t seconds_remaining = seconds_remaining_double;
+    
+    if (seconds_remaining_double < std::numeric_limits<size_t>::max())
+      {
+	size_t ETA_hours = seconds_remaining / 3600;
+	size_t ETA_mins = (seconds_remaining / 60) % 60;
+	size_t ETA_secs = seconds_remaining % 60;
+	
+	std::cout << "\rReplica Exchange No." << replexSwapCalls << ", ETA ";
+	if (ETA_hours)
+	  std::cout << ETA_hours << "hr ";
+	
+	if (ETA_mins)
+	  std::cout << ETA_mins << "min ";
+	
+	std::cout << ETA_secs << "s        ";
+	std::cout.flush();
+      }
+  }
 
-		Simulations[i].ptrScheduler->rebuildSystemEvents();
+  void
+  EReplicaExchangeSimulation::runReplica(size_t tempID, size_t simID)
+  {
+    Simulation& sim = Simulations[simID];
+
+    const double start = wallTime();
+    const size_t startEvents = sim.eventCount;
 
-		//Reset the max collisions
-		Simulations[i].endEventCount = vm["events"].as<size_t>();
+    try {
+      sim.runSimulation(true);
+    }
+    catch (...)
+      {
+	//Report the interval as finished so runAsynchronous() does not
+	//wait forever, the ThreadPool passes on the exception
+	magnet::thread::ScopedLock lock(_finishedMutex);
+	_replicaFailed = true;
+	_finishedRuns.push_back(tempID);
+	_finishedCondition.notify_one();
+	throw;
+      }
+
+    //Only this thread touches the data of this temperature until the
+    //interval is reported as finished
+    simData& dat = temperatureList[tempID].second;
+    dat.finishTime = wallTime();
+    dat.runTime += dat.finishTime - start;
+    dat.events += sim.eventCount - startEvents;
+    ++dat.runs;
+
+    magnet::thread::ScopedLock lock(_finishedMutex);
+    _finishedRuns.push_back(tempID);
+    _finishedCondition.notify_one();
+  }
+
+  size_t
+  EReplicaExchangeSimulation::asyncPartner(const size_t tempID, const size_t step) const
+  {
+    //The same alternating pairs as the AlternatingSequence mode
+    const size_t first = (step % 2) ? 0 : 1;
+    
+    if (tempID < first)
+      return temperatureList.size();
+
+    if (!((tempID - first) % 2))
+      return (tempID + 1 < temperatureList.size()) ? tempID + 1 : temperatureList.size();
+
+    return tempID - 1;
+  }
+
+  void 
+  EReplicaExchangeSimulation::runAsynchronous()
+  {
+    const size_t nTemps = temperatureList.size();
+
+    //Every temperature runs the same number of intervals, this is
+    //the number of intervals the coldest temperature needs to reach
+    //the end time (the first interval ends immediately).
+    const size_t maxSteps = (replicaEndTime > 0) 
+      ? size_t(std::ceil(replicaEndTime / vm["replex-interval"].as<double>())) + 1 : 0;
+
+    //The number of exchange phases each temperature has finished
+    std::vector<size_t> steps(nTemps, 0);
+    //If a temperature is waiting for its partner to finish
+    std::vector<char> waiting(nTemps, false);
+    //The temperatures ready to run their next interval
+    std::vector<size_t> ready;
+    size_t running = 0;
+
+    if (maxSteps)
+      for (size_t tempID(0); tempID < nTemps; ++tempID)
+	ready.push_back(tempID);
+
+    for (;;)
+      {
+	if (!_SIGINT && (replicaEndTime > 0))
+	  {
+	    std::vector<magnet::function::Task*> tasks;
+	    BOOST_FOREACH(const size_t& tempID, ready)
+	      {
+		simData& dat = temperatureList[tempID].second;
+		dat.waitTime += wallTime() - dat.finishTime;
+		tasks.push_back(magnet::function::Task::makeTask(&EReplicaExchangeSimulation::runReplica, this,
+								 tempID, size_t(dat.simID)));
 	      }
+	    running += tasks.size();
+	    ready.clear();
+	    threads.queueTasks(tasks);
+	  }
 
-	    timespec endTime;
-	    clock_gettime(CLOCK_MONOTONIC, &endTime);
-	    
-	    double duration = double(endTime.tv_sec) - double(_startTime.tv_sec)
-	      + 1e-9 * (double(endTime.tv_nsec) - double(_startTime.tv_nsec));
-	    
-	    double fractionComplete = (Simulations[0].systemTime / Simulations[0].units.unitTime()) / replicaEndTime;
-	    double seconds_remaining_double = duration * (1/ fractionComplete - 1);
-	    size_t seconds_remaining = seconds_remaining_double;
+	if (!running)
+	  {
+	    //Every Simulation is paused, so the data can be safely
+	    //accessed
+	    if (_SIGINT)
+	      {
+		handleSIGINT();
+		continue;
+	      }
+
+	    break;
+	  }
+
+	std::vector<size_t> finished;
+	{
+	  magnet::thread::ScopedLock lock(_finishedMutex);
+	  while (_finishedRuns.empty())
+	    {
+	      if (threads.getThreadCount())
+		_finishedCondition.wait(_finishedMutex);
+	      else
+		{
+		  //The tasks are only run in the wait() of a ThreadPool
+		  //without threads
+		  lock.unlock();
+		  threads.wait();
+		  lock.lock();
+		}
+	    }
+	  finished.swap(_finishedRuns);
+	}
+
+	//Let the ThreadPool throw the exception of the failed
+	//interval
+	if (_replicaFailed)
+	  threads.wait();
+
+	running -= finished.size();
+
+	BOOST_FOREACH(const size_t& tempID, finished)
+	  {
+	    const size_t partner = asyncPartner(tempID, steps[tempID]);
 	    
-	    if (seconds_remaining_double < std::numeric_limits<size_t>::max())
+	    //The partner may be waiting for its partner of another step
+	    if ((partner != nTemps) && !(waiting[partner] && (steps[partner] == steps[tempID])))
 	      {
-		size_t ETA_hours = seconds_remaining / 3600;
-		size_t ETA_mins = (seconds_remaining / 60) % 60;
-		size_t ETA_secs = seconds_remaining % 60;
-		
-		std::cout << "\rReplica Exchange No." << replexSwapCalls << ", ETA ";
-		if (ETA_hours)
-		  std::cout << ETA_hours << "hr ";
-		
-		if (ETA_mins)
-		  std::cout << ETA_mins << "min ";
+		waiting[tempID] = true;
+		continue;
+	      }
+
+	    if (partner != nTemps)
+	      {
+		waiting[partner] = false;
+		AttemptSwap(std::min(tempID, partner), std::max(tempID, partner));
+	      }
+
+	    size_t exchanged[2] = {tempID, partner};
+	    for (size_t i(0); i < ((partner != nTemps) ? 2 : 1); ++i)
+	      {
+		const size_t ID = exchanged[i];
+		ReplexTemperatureTicker(ID);
+		resetHalt(ID);
+
+		if (ID == 0)
+		  {
+		    ++replexSwapCalls;
+		    printProgress();
+		  }
 		
-		std::cout << ETA_secs << "s        ";
-		std::cout.flush();
+		if (++steps[ID] < maxSteps)
+		  ready.push_back(ID);
 	      }
 	  }
       }
+  }
+
+  void EReplicaExchangeSimulation::runSimulation()
+  {
+    clock_gettime(CLOCK_MONOTONIC, &_startTime);
+    start_Time = boost::posix_time::second_clock::local_time();
+
+    if (ReplexMode == AsynchronousPairs)
+      {
+	runAsynchronous();
+	end_Time = boost::posix_time::second_clock::local_time();
+	return;
+      }
+
+    while (((Simulations[0].systemTime / Simulations[0].units.unitTime()) < replicaEndTime)
+	   && (Simulations[0].eventCount < vm["events"].as<size_t>()))
+      {
+	if (_SIGINT)
+	  {
+	    handleSIGINT();
+	    continue;
+	  }
+
+	{
+	  //Run the simulations. We also generate all tasks at once
+	  //and submit them all at once to minimise lock contention.
+	  std::vector<magnet::function::Task*> tasks(nSims, NULL);
+	  
+	  for (size_t i(0); i < nSims; ++i)
+	    tasks[i] = magnet::function::Task::makeTask(&EReplicaExchangeSimulation::runReplica, this, 
+							i, size_t(temperatureList[i].second.simID));
+	  
+	  threads.queueTasks(tasks);
+	  threads.wait();//This syncs the systems for the replica exchange
+	  _finishedRuns.clear();
+
+	  //The time each simulation spent waiting at the barrier
+	  const double syncTime = wallTime();
+	  BOOST_FOREACH(replexPair& dat, temperatureList)
+	    dat.second.waitTime += syncTime - dat.second.finishTime;
+	  
+	  //Swap calculation
+	  ReplexSwap(ReplexMode);
+	  
+	  ReplexSwapTicker();
+	  
+	  //Reset the stop events
+	  for (size_t i(0); i < nSims; ++i)
+	    resetHalt(i);
+	  
+	  printProgress();
+	}
+      }
     end_Time = boost::posix_time::second_clock::local_time();
   }
 
@@ -21,6 +21,7 @@
 #pragma once
 
 #include <dynamo/coordinator/engine/engine.hpp>
+#include <magnet/thread/mutex.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <ctime>
 
@@ -33,7 +34,10 @@ namespace dynamo {
    * are swapped along with a rescaling of the particles velocities.
    *
    * This class uses the ThreadPool to parallelise the running of the
-   * simulations.
+   * simulations. In the asynchronous swap mode there is no barrier
+   * between the replica exchange phases, each pair of neighbouring
+   * temperatures is exchanged as soon as both have finished their
+   * interval (see runAsynchronous()).
    */
   class EReplicaExchangeSimulation: public Engine
   {
@@ -88,8 +92,12 @@ namespace dynamo {
 			neighbour*/
       RandomPairs = 3, /*!< For 5*No. of Simulations, pick two random
 			 Simulations and attempt to swap them*/
-      RandomSelection = 4 /*!< Pick randomly between RandomPairs and
+      RandomSelection = 4, /*!< Pick randomly between RandomPairs and
 			    AlternatingSequence.*/
+      AsynchronousPairs = 5 /*!< Swap alternating neighbouring pairs
+			      as soon as both have finished their
+			      interval, without waiting for the other
+			      Simulations.*/
     } Replex_Mode_Type;
 
     /*! \brief A structure to hold replica exchange data on a single
@@ -104,7 +112,8 @@ namespace dynamo {
        */
       explicit simData(int ID, double rT):
 	simID(ID), swaps(0), attempts(0), upSims(0), downSims(0),
-	realTemperature(rT)
+	realTemperature(rT), runs(0), events(0), runTime(0), waitTime(0),
+	finishTime(0)
       {}
 
       /*! \brief compares simData by their contained simulation ID's
@@ -129,6 +138,18 @@ namespace dynamo {
       size_t downSims;
       /*! \brief The temperature of this simulation point */
       double realTemperature;
+      /*! \brief The number of intervals run at this temperature.*/
+      size_t runs;
+      /*! \brief The number of events run at this temperature.*/
+      size_t events;
+      /*! \brief The wall time (in seconds) spent running intervals.*/
+      double runTime;
+      /*! \brief The wall time (in seconds) spent waiting for other
+          Simulations before the next interval.*/
+      double waitTime;
+      /*! \brief When the last interval finished (in seconds since
+          the start of the run).*/
+      double finishTime;
     };
 
     typedef std::pair<double, simData> replexPair;
@@ -190,6 +211,15 @@ namespace dynamo {
 
     timespec _startTime;
 
+    /*! \brief The temperature indices of the finished intervals, which
+     * have not been processed by runAsynchronous() yet.
+     */
+    std::vector<size_t> _finishedRuns;
+    //! \brief Set if an interval finished by throwing an exception.
+    bool _replicaFailed;
+    magnet::thread::Mutex _finishedMutex;
+    magnet::thread::Condition _finishedCondition;
+
     /*! \brief Initialises this class ready for the replica exchange.
      */
     virtual void preSimInit();
@@ -232,5 +262,52 @@ namespace dynamo {
      * \param id2 Second Simulation to attempt to exchange.
      */
     void AttemptSwap(const unsigned int id1, const unsigned int id2);
+
+    /*! \brief Update the replica exchange data of a single
+     * temperature after an exchange phase.
+     */
+    void ReplexTemperatureTicker(const size_t tempID);
+
+    /*! \brief Set the next halt time of the Simulation at a
+     * temperature.
+     */
+    void resetHalt(const size_t tempID);
+
+    /*! \brief Run a single interval of the Simulation at a
+     * temperature, collecting the throughput statistics.
+     *
+     * This is executed in the ThreadPool.
+     */
+    void runReplica(size_t tempID, size_t simID);
+
+    /*! \brief Run the Simulations, exchanging neighbouring pairs
+     * as soon as both have finished their interval.
+     *
+     * The pairs alternate as in the AlternatingSequence mode. A
+     * Simulation only has to wait for its partner in the current
+     * exchange, so the slower (hotter) Simulations do not hold up the
+     * rest of the temperatures.
+     */
+    void runAsynchronous();
+
+    /*! \brief The partner temperature of a temperature in the
+     * asynchronous exchange phase step, or temperatureList.size() if
+     * it has none.
+     */
+    size_t asyncPartner(const size_t tempID, const size_t step) const;
+
+    /*! \brief Handle a SIGINT, by shutting down, outputting or
+     * printing the data.
+     */
+    void handleSIGINT();
+
+    //! \brief Write the replex.dat and replex.stats files.
+    void outputReplexStats();
+
+    //! \brief Print the estimated time remaining.
+    void printProgress();
+
+    //! \brief The wall time since the start of the run, in seconds.
+    double wallTime() const;
   };
 }
@@ -92,6 +92,9 @@ namespace dynamo {
 
     setupSim(simulation, vm["config-file"].as<std::vector<std::string> >()[0]);
 
+    //Only one simulation is run, so it may use the threads itself
+    simulation.threads = &threads;
+
     simulation.initialise();
 
     postSimInit(simulation);
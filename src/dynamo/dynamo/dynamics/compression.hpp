@@ -34,6 +34,10 @@ namespace dynamo {
     DynCompression(dynamo::Simulation*, double);
     virtual double SphereSphereInRoot(const Particle& p1, const Particle& p2, double d) const;
     virtual double SphereSphereOutRoot(const Particle& p1, const Particle& p2, double d) const;  
+    virtual void SphereSphereInRoot(const Particle& p1, const size_t* IDs, const double* d, double* dt, const size_t N) const
+    { Dynamics::SphereSphereInRoot(p1, IDs, d, dt, N); }
+    virtual void SphereSphereOutRoot(const Particle& p1, const size_t* IDs, const double* d, double* dt, const size_t N) const
+    { Dynamics::SphereSphereOutRoot(p1, IDs, d, dt, N); }
     virtual double sphereOverlap(const Particle& p1, const Particle& p2, const double& d) const;
     virtual PairEventData SmoothSpheresColl(const IntEvent&, const double&, const double&, const EEventType&) const;
     virtual PairEventData SphereWellEvent(const IntEvent&, const double&, const double&) const;
@@ -19,10 +19,13 @@
 #include <dynamo/species/inertia.hpp>
 #include <dynamo/simulation.hpp>
 #include <dynamo/2particleEventData.hpp>
+#include <dynamo/NparticleEventData.hpp>
 #include <dynamo/units/units.hpp>
 #include <dynamo/BC/LEBC.hpp>
+#include <dynamo/particleDataLoader.hpp>
 #include <magnet/xmlwriter.hpp>
 #include <magnet/xmlreader.hpp>
+#include <magnet/stream/binary.hpp>
 #include <boost/foreach.hpp>
 
 namespace dynamo {
@@ -51,6 +54,12 @@ namespace dynamo {
   Dynamics::initialise()
   {
     streamFreq = 10 * Sim->N;
+
+    if (_particleSoAEnabled)
+      {
+	_particleSoA.gather(Sim->particles);
+	dout << "Maintaining a structure-of-arrays copy of the particle data" << std::endl;
+      }
     
     if (hasOrientationData())
       {
@@ -98,26 +107,11 @@ namespace dynamo {
   { M_throw() << "Not implemented for this Dynamics."; }
 
   void 
-  Dynamics::loadParticleXMLData(const magnet::xml::Node& XML)
+  Dynamics::loadParticleXMLData(const magnet::xml::Node& XML, ParticleDataLoader& data)
   {
-    dout << "Loading Particle Data" << std::endl;
-
-    bool outofsequence = false;  
-  
-    for (magnet::xml::Node node = XML.getNode("ParticleData").fastGetNode("Pt"); 
-	 node.valid(); ++node)
-      {
-	if (!node.hasAttribute("ID")
-	    || node.getAttribute("ID").as<size_t>() != Sim->particles.size())
-	  outofsequence = true;
-      
-	Particle part(node, Sim->particles.size());
-	part.getVelocity() *= Sim->units.unitVelocity();
-	part.getPosition() *= Sim->units.unitLength();
-	Sim->particles.push_back(part);
-      }
+    Sim->particles.swap(data.getParticles());
 
-    if (outofsequence)
+    if (data.outOfSequence())
       dout << "Particle ID's out of sequence!\n"
 	   << "This can result in incorrect capture map loads etc.\n"
 	   << "Erase any capture maps in the configuration file so they are regenerated." << std::endl;
@@ -128,13 +122,15 @@ namespace dynamo {
 
     if (XML.getNode("ParticleData").hasAttribute("OrientationData"))
       {
+	if ((data.getOrientations().size() != Sim->N)
+	    || (data.getAngularVelocities().size() != Sim->N))
+	  M_throw() << "The orientation data is missing for some particles";
+
 	orientationData.resize(Sim->N);
-	size_t i(0);
-	for (magnet::xml::Node node = XML.getNode("ParticleData").fastGetNode("Pt"); 
-	     node.valid(); ++node, ++i)
+	for (size_t i(0); i < Sim->N; ++i)
 	  {
-	    orientationData[i].orientation << node.getNode("U");
-	    orientationData[i].angularVelocity << node.getNode("O");
+	    orientationData[i].orientation = data.getOrientations()[i];
+	    orientationData[i].angularVelocity = data.getAngularVelocities()[i];
       
 	    double oL = orientationData[i].orientation.nrm();
       
@@ -183,6 +179,124 @@ namespace dynamo {
     XML << magnet::xml::endtag("ParticleData");
   }
 
+  void
+  Dynamics::loadParticleBinaryData(const magnet::xml::Node& XML, std::istream& is)
+  {
+    dout << "Loading Binary Particle Data" << std::endl;
+
+    const magnet::xml::Node dataNode = XML.getNode("ParticleData");
+    const size_t N = dataNode.getAttribute("N").as<size_t>();
+
+    Sim->particles.reserve(N);
+    double data[2 * NDIM];
+    for (size_t i(0); i < N; ++i)
+      {
+	magnet::stream::readBinary(is, data, 2 * NDIM);
+
+	Vector pos, vel;
+	for (size_t iDim(0); iDim < NDIM; ++iDim)
+	  {
+	    pos[iDim] = data[iDim];
+	    vel[iDim] = data[NDIM + iDim];
+	  }
+
+	Particle part(pos, vel, i);
+	part.getVelocity() *= Sim->units.unitVelocity();
+	part.getPosition() *= Sim->units.unitLength();
+	Sim->particles.push_back(part);
+      }
+
+    std::vector<unsigned char> staticFlags(N);
+    if (N)
+      magnet::stream::readBinary(is, &staticFlags[0], N);
+
+    for (size_t i(0); i < N; ++i)
+      if (staticFlags[i])
+	Sim->particles[i].clearState(Particle::DYNAMIC);
+
+    Sim->N = Sim->particles.size();
+
+    dout << "Particle count " << Sim->N << std::endl;
+
+    if (dataNode.hasAttribute("OrientationData"))
+      {
+	orientationData.resize(Sim->N);
+	for (size_t i(0); i < N; ++i)
+	  {
+	    magnet::stream::readBinary(is, data, 2 * NDIM);
+
+	    for (size_t iDim(0); iDim < NDIM; ++iDim)
+	      {
+		orientationData[i].orientation[iDim] = data[iDim];
+		orientationData[i].angularVelocity[iDim] = data[NDIM + iDim];
+	      }
+
+	    double oL = orientationData[i].orientation.nrm();
+      
+	    if (!(oL > 0.0))
+	      M_throw() << "Particle ID " << i 
+			<< " orientation vector is zero!";
+      
+	    //Makes the vector a unit vector
+	    orientationData[i].orientation /= oL;
+	  }
+      }
+  }
+
+  void
+  Dynamics::outputParticleBinaryHeader(magnet::xml::XmlStream& XML) const
+  {
+    XML << magnet::xml::tag("ParticleData")
+	<< magnet::xml::attr("N") << Sim->N
+	<< magnet::xml::attr("Format") << "Binary";
+  
+    if (hasOrientationData())
+      XML << magnet::xml::attr("OrientationData") << "Y";
+
+    XML << magnet::xml::endtag("ParticleData");
+  }
+
+  void
+  Dynamics::outputParticleBinaryData(std::ostream& os, bool applyBC) const
+  {
+    double data[2 * NDIM];
+    std::vector<unsigned char> staticFlags(Sim->N);
+
+    for (size_t i = 0; i < Sim->N; ++i)
+      {
+	Particle tmp(Sim->particles[i]);
+	if (applyBC) 
+	  Sim->BCs->applyBC(tmp.getPosition(), tmp.getVelocity());
+      
+	tmp.getVelocity() *= (1.0 / Sim->units.unitVelocity());
+	tmp.getPosition() *= (1.0 / Sim->units.unitLength());
+
+	for (size_t iDim(0); iDim < NDIM; ++iDim)
+	  {
+	    data[iDim] = tmp.getPosition()[iDim];
+	    data[NDIM + iDim] = tmp.getVelocity()[iDim];
+	  }
+
+	magnet::stream::writeBinary(os, data, 2 * NDIM);
+	staticFlags[i] = !tmp.testState(Particle::DYNAMIC);
+      }
+
+    if (Sim->N)
+      magnet::stream::writeBinary(os, &staticFlags[0], Sim->N);
+
+    if (hasOrientationData())
+      for (size_t i = 0; i < Sim->N; ++i)
+	{
+	  for (size_t iDim(0); iDim < NDIM; ++iDim)
+	    {
+	      data[iDim] = orientationData[i].orientation[iDim];
+	      data[NDIM + iDim] = orientationData[i].angularVelocity[iDim];
+	    }
+
+	  magnet::stream::writeBinary(os, data, 2 * NDIM);
+	}
+  }
+
   double 
   Dynamics::getParticleKineticEnergy(const Particle& part) const
   {
@@ -239,6 +353,55 @@ namespace dynamo {
 
     BOOST_FOREACH(rotData& rdat, orientationData)
       rdat.angularVelocity *= scalefactor;      
+
+    if (_particleSoAEnabled)
+      _particleSoA.gather(Sim->particles);
+  }
+
+  void
+  Dynamics::reorderParticles(const std::vector<size_t>& order)
+  {
+    reorderParticleData(orientationData, order);
+
+    if (_particleSoAEnabled)
+      _particleSoA.gather(Sim->particles);
+  }
+
+  void 
+  Dynamics::updateParticleSoA(const NEventData& pdat) const
+  {
+    if (!_particleSoAEnabled) return;
+
+    BOOST_FOREACH(const ParticleEventData& dat, pdat.L1partChanges)
+      _particleSoA.store(Sim->particles[dat.getParticleID()]);
+
+    BOOST_FOREACH(const PairEventData& dat, pdat.L2partChanges)
+      {
+	_particleSoA.store(Sim->particles[dat.particle1_.getParticleID()]);
+	_particleSoA.store(Sim->particles[dat.particle2_.getParticleID()]);
+      }
+  }
+
+  void
+  Dynamics::SphereSphereInRoot(const Particle& p1, const size_t* IDs, const double* d, double* dt, const size_t N) const
+  {
+    for (size_t i(0); i < N; ++i)
+      {
+	Particle& p2(Sim->particles[IDs[i]]);
+	updateParticle(p2);
+	dt[i] = SphereSphereInRoot(p1, p2, d[i]);
+      }
+  }
+
+  void
+  Dynamics::SphereSphereOutRoot(const Particle& p1, const size_t* IDs, const double* d, double* dt, const size_t N) const
+  {
+    for (size_t i(0); i < N; ++i)
+      {
+	Particle& p2(Sim->particles[IDs[i]]);
+	updateParticle(p2);
+	dt[i] = SphereSphereOutRoot(p1, p2, d[i]);
+      }
   }
 
   PairEventData 
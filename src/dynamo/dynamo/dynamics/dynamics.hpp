@@ -19,6 +19,7 @@
 #include <dynamo/base.hpp>
 #include <dynamo/eventtypes.hpp>
 #include <dynamo/particle.hpp>
+#include <dynamo/particleSoA.hpp>
 #include <dynamo/simulation.hpp>
 #include <magnet/math/matrix.hpp>
 
@@ -29,6 +30,8 @@ namespace dynamo {
   class ParticleEventData;
   class IntEvent;
   class Event;
+  class NEventData;
+  class ParticleDataLoader;
 
   /*! \brief Provides the primitivve event-detection and processing
    routines for all events.
@@ -67,7 +70,8 @@ namespace dynamo {
       SimBase(tmp, "Dynamics"),
       partPecTime(0.0),
       streamCount(0),
-      streamFreq(1)
+      streamFreq(1),
+      _particleSoAEnabled(false)
     {};
 
     virtual ~Dynamics() {}
@@ -80,13 +84,20 @@ namespace dynamo {
      */
     virtual void swapSystem(Dynamics& oDynamics) {}
 
-    /*! \brief Parses the XML data to see if it can load XML particle
-      data or if it needs to decode the binary data. Then loads the
-      particle data.
+    /*! \brief Called when the particle IDs are renumbered (see \ref
+      Simulation::reorderParticles).
+
+      The new particle with ID i was previously the particle with ID
+      order[i]. Any per-particle data must be permuted to match.
+     */
+    virtual void reorderParticles(const std::vector<size_t>& order);
+
+    /*! \brief Loads the particle data read from an XML file.
      
       \param XML The root xml::Node of the xml::Document which has the ParticleData tag within.
+      \param data The particle data, streamed from the file as it was read.
      */
-    virtual void loadParticleXMLData(const magnet::xml::Node& XML);
+    virtual void loadParticleXMLData(const magnet::xml::Node& XML, ParticleDataLoader& data);
   
     /*! \brief Writes the XML particle data, either the base64 header or
       the entire XML form.
@@ -95,6 +106,34 @@ namespace dynamo {
      */
     void outputParticleXMLData(magnet::xml::XmlStream& XML, bool applyBC) const;
 
+    /*! \brief Loads the particle data of a binary configuration file
+      (see \ref outputParticleBinaryData).
+
+      \param XML The root xml::Node of the header of the binary
+      configuration file.
+      \param is The stream, positioned at the start of the particle data.
+     */
+    void loadParticleBinaryData(const magnet::xml::Node& XML, std::istream& is);
+
+    /*! \brief Writes the ParticleData tag of the XML header of a
+      binary configuration file.
+     */
+    void outputParticleBinaryHeader(magnet::xml::XmlStream& XML) const;
+
+    /*! \brief Writes the particle data of a binary configuration file.
+
+      The positions and velocities of each particle are written as six
+      doubles, followed by a byte for each particle which is non-zero
+      if the particle is static. If the system has orientation data,
+      the orientation and angular velocity of each particle then
+      follow as six doubles. The data is in the units of the
+      configuration file.
+
+      \param os The stream to write the particle data to.
+      \param applyBC Wether to apply the boundary conditions to the final particle positions before writing them out.
+     */
+    void outputParticleBinaryData(std::ostream& os, bool applyBC) const;
+
     /*! \brief Returns the degrees of freedom per particle.
      */
     inline size_t getParticleDOF() const { return NDIM + 2 * hasOrientationData(); }
@@ -179,7 +218,35 @@ namespace dynamo {
      
       \return Time of the next event, or HUGE_VAL if no event.
      */
-    virtual double SphereSphereOutRoot(const IDRange& p1, const IDRange& p2, double d) const = 0;  
+    virtual double SphereSphereOutRoot(const IDRange& p1, const IDRange& p2, double d) const = 0;
+
+    /*! \brief Determines if and when a sphere will intersect each
+      sphere in a list of partner particles.
+
+      This is a batched version of SphereSphereInRoot, used when
+      scheduling all of the neighbour events of a particle at
+      once. The default implementation updates each partner and calls
+      the single pair version, but derived Dynamics may stream the
+      partners from the \ref ParticleSoA instead so that the loop can
+      be vectorised.
+
+      \param p1 The particle to test, this must be up to date.
+      \param IDs The IDs of the N partner particles, these need not be
+      up to date.
+      \param d The N interaction diameters/distances.
+      \param dt The N times of the next events (output), or HUGE_VAL
+      if no event.
+      \param N The number of partner particles.
+     */
+    virtual void SphereSphereInRoot(const Particle& p1, const size_t* IDs, const double* d, double* dt, const size_t N) const;
+
+    /*! \brief Determines if and when a sphere will stop intersecting
+      each sphere in a list of partner particles.
+
+      This is a batched version of SphereSphereOutRoot, see the
+      batched SphereSphereInRoot for a description of the parameters.
+     */
+    virtual void SphereSphereOutRoot(const Particle& p1, const size_t* IDs, const double* d, double* dt, const size_t N) const;
 
     /*! \brief Determines if two spheres are overlapping
      
@@ -600,6 +667,9 @@ namespace dynamo {
 
       partPecTime = 0;
       streamCount = 0;
+
+      if (_particleSoAEnabled)
+	_particleSoA.gather(Sim->particles);
     }
 
     /*! \brief Free streams a particle up to the current time.
@@ -609,8 +679,14 @@ namespace dynamo {
      */
     inline void updateParticle(Particle& part) const
     {
+      //Particles which are up to date are not written to, which
+      //allows the events of up to date particles to be predicted in
+      //parallel (see Scheduler::rebuildList).
+      if (isUpToDate(part)) return;
+
       streamParticle(part, part.getPecTime() + partPecTime);
       part.getPecTime() = -partPecTime;
+      if (_particleSoAEnabled) _particleSoA.store(part);
     }
 
     inline bool isUpToDate(const Particle& part) const
@@ -654,6 +730,9 @@ namespace dynamo {
 	  BOOST_FOREACH(Particle& part, Sim->particles)
 	    part.getPecTime() += partPecTime;
 
+	  if (_particleSoAEnabled)
+	    _particleSoA.shiftPecTimes(partPecTime);
+
 	  partPecTime = 0;
 	  streamCount = 0;
 	}
@@ -708,6 +787,39 @@ namespace dynamo {
      */
     std::pair<Vector, Vector> getCOMPosVel(const IDRange& particles) const;
 
+    /*! \brief Request that a structure-of-arrays copy of the
+        particle kinematics is maintained (see \ref ParticleSoA).
+
+	This must be called before the Dynamics is initialised.
+     */
+    void enableParticleSoA() { _particleSoAEnabled = true; }
+
+    //! \brief Test if the structure-of-arrays copy is maintained.
+    bool particleSoAEnabled() const { return _particleSoAEnabled; }
+
+    /*! \brief Access the structure-of-arrays copy of the particle
+        kinematics.
+
+	The peculiar times stored are relative to the current \ref
+	partPecTime, i.e., the delay of particle i is
+	pecTime()[i] + getParticlePecTimeOffset().
+     */
+    const ParticleSoA& getParticleSoA() const { return _particleSoA; }
+
+    //! \brief The system wide part of the delayed states time offset.
+    double getParticlePecTimeOffset() const { return partPecTime; }
+
+    /*! \brief Refresh the structure-of-arrays copy for all particles
+        changed by an event.
+	
+	Called by \ref Simulation::signalParticleUpdate.
+     */
+    void updateParticleSoA(const NEventData&) const;
+
+    //! \brief Refresh the structure-of-arrays copy for a single particle.
+    inline void updateParticleSoA(const Particle& part) const
+    { if (_particleSoAEnabled) _particleSoA.store(part); }
+
   protected:
     friend class GCellsShearing;
 
@@ -722,6 +834,7 @@ namespace dynamo {
       streamParticle(part, dt + partPecTime + part.getPecTime());
 
       part.getPecTime() = - dt - partPecTime;
+      if (_particleSoAEnabled) _particleSoA.store(part);
     }
   
     /*! \brief The time by which the delayed state differs from the actual.*/
@@ -741,6 +854,11 @@ namespace dynamo {
     virtual void streamParticle(Particle& part, const double& dt) const = 0;
 
     mutable std::vector<rotData> orientationData;
+
+    /*! \brief The structure-of-arrays copy of the particle
+        kinematics, only maintained if \ref _particleSoAEnabled.*/
+    mutable ParticleSoA _particleSoA;
+    bool _particleSoAEnabled;
   };
 }
 
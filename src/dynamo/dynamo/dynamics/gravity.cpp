@@ -453,6 +453,13 @@ namespace dynamo {
     M_throw() << "Not implemented yet";
   }
 
+  void
+  DynGravity::reorderParticles(const std::vector<size_t>& order)
+  {
+    Dynamics::reorderParticles(order);
+    reorderParticleData(_tcList, order);
+  }
+
   void
   DynGravity::initialise()
   {
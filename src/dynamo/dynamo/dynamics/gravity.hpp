@@ -34,6 +34,10 @@ namespace dynamo {
     virtual double SphereSphereInRoot(const IDRange& p1, const IDRange& p2, double d) const;
     virtual double SphereSphereOutRoot(const Particle& p1, const Particle& p2, double d) const;
     virtual double SphereSphereOutRoot(const IDRange& p1, const IDRange& p2, double d) const;
+    virtual void SphereSphereInRoot(const Particle& p1, const size_t* IDs, const double* d, double* dt, const size_t N) const
+    { Dynamics::SphereSphereInRoot(p1, IDs, d, dt, N); }
+    virtual void SphereSphereOutRoot(const Particle& p1, const size_t* IDs, const double* d, double* dt, const size_t N) const
+    { Dynamics::SphereSphereOutRoot(p1, IDs, d, dt, N); }
     virtual void streamParticle(Particle&, const double&) const;
     virtual double getSquareCellCollision2(const Particle&, const Vector &, const Vector &) const;
     virtual int getSquareCellCollision3(const Particle&, const Vector &, const Vector &) const;
@@ -46,6 +50,7 @@ namespace dynamo {
     virtual PairEventData SmoothSpheresColl(const IntEvent&, const double&, const double&, const EEventType& eType) const;
     virtual std::pair<double, Dynamics::TriangleIntersectingPart>  getSphereTriangleEvent(const Particle& part, const Vector & A, const Vector & B, const Vector & C, const double dist) const;
     virtual ParticleEventData runPlaneEvent(Particle&, const Vector &, const double&, double) const;
+    virtual void reorderParticles(const std::vector<size_t>& order);
 
   protected:
     double elasticV;
@@ -22,6 +22,8 @@
 #include <dynamo/NparticleEventData.hpp>
 
 #include <dynamo/BC/BC.hpp>
+#include <dynamo/BC/PBC.hpp>
+#include <dynamo/BC/None.hpp>
 #include <dynamo/simulation.hpp>
 #include <dynamo/species/species.hpp>
 #include <dynamo/schedulers/sorters/event.hpp>
@@ -40,6 +42,7 @@
 #include <magnet/math/matrix.hpp>
 #include <magnet/xmlwriter.hpp>
 #include <boost/math/special_functions/fpclassify.hpp>
+#include <typeinfo>
 
 namespace dynamo {
   double
@@ -101,6 +104,132 @@ namespace dynamo {
     return magnet::intersection::ray_inv_sphere_bfc(r12, v12, d);
   }
 
+  bool
+  DynNewtonian::loadSphereBatch(const Particle& p1, const size_t* IDs, const size_t N) const
+  {
+    if (!_particleSoAEnabled) return false;
+
+    //Only the simple periodic and infinite boundary conditions are
+    //inlined here, the others (e.g., Lees-Edwards) also alter the
+    //relative velocity.
+    const bool periodic(typeid(*Sim->BCs) == typeid(BCPeriodic));
+    if (!periodic && !dynamic_cast<const BCNone*>(Sim->BCs.get()))
+      return false;
+
+#ifdef DYNAMO_DEBUG
+    if (!isUpToDate(p1))
+      M_throw() << "Particle " << p1.getID() << " is not up to date";
+
+    for (size_t i(0); i < N; ++i)
+      if (!_particleSoA.matches(Sim->particles[IDs[i]]))
+	M_throw() << "The structure-of-arrays copy of particle " << IDs[i]
+		  << " is out of date";
+#endif
+
+    if (_batchR[0].size() < N)
+      for (size_t n(0); n < NDIM; ++n)
+	{
+	  _batchR[n].resize(N);
+	  _batchV[n].resize(N);
+	}
+
+    const double* const pecTime(_particleSoA.pecTime());
+    for (size_t n(0); n < NDIM; ++n)
+      {
+	const double* const pos(_particleSoA.pos(n));
+	const double* const vel(_particleSoA.vel(n));
+	const double r1(p1.getPosition()[n]);
+	const double v1(p1.getVelocity()[n]);
+	double* const r12(&_batchR[n][0]);
+	double* const v12(&_batchV[n][0]);
+
+	//Stream the partners to the current time as they are gathered,
+	//this is the same calculation as updateParticle
+	for (size_t i(0); i < N; ++i)
+	  {
+	    const size_t id(IDs[i]);
+	    r12[i] = r1 - (pos[id] + vel[id] * (pecTime[id] + partPecTime));
+	    v12[i] = v1 - vel[id];
+	  }
+
+	if (periodic)
+	  {
+	    const double L(Sim->primaryCellSize[n]);
+	    for (size_t i(0); i < N; ++i)
+	      r12[i] -= L * rint(r12[i] / L);
+	  }
+      }
+
+    return true;
+  }
+
+  void
+  DynNewtonian::SphereSphereInRoot(const Particle& p1, const size_t* IDs, const double* d, double* dt, const size_t N) const
+  {
+    if (!loadSphereBatch(p1, IDs, N))
+      return Dynamics::SphereSphereInRoot(p1, IDs, d, dt, N);
+
+    const double* r12[NDIM];
+    const double* v12[NDIM];
+    for (size_t n(0); n < NDIM; ++n)
+      {
+	r12[n] = &_batchR[n][0];
+	v12[n] = &_batchV[n][0];
+      }
+
+    //A branch free form of magnet::intersection::ray_sphere_bfc, the
+    //invalid roots are calculated but then discarded.
+    for (size_t i(0); i < N; ++i)
+      {
+	double TD(0), T2(0), D2(0);
+	for (size_t n(0); n < NDIM; ++n)
+	  {
+	    TD += r12[n][i] * v12[n][i];
+	    T2 += r12[n][i] * r12[n][i];
+	    D2 += v12[n][i] * v12[n][i];
+	  }
+
+	const double c = T2 - d[i] * d[i];
+	const double arg = TD * TD - D2 * c;
+	const double root = std::max(0.0, - c / (TD - std::sqrt(std::max(arg, 0.0))));
+	dt[i] = ((TD < 0) && (arg >= 0)) ? root : HUGE_VAL;
+      }
+  }
+
+  void
+  DynNewtonian::SphereSphereOutRoot(const Particle& p1, const size_t* IDs, const double* d, double* dt, const size_t N) const
+  {
+    if (!loadSphereBatch(p1, IDs, N))
+      return Dynamics::SphereSphereOutRoot(p1, IDs, d, dt, N);
+
+    const double* r12[NDIM];
+    const double* v12[NDIM];
+    for (size_t n(0); n < NDIM; ++n)
+      {
+	r12[n] = &_batchR[n][0];
+	v12[n] = &_batchV[n][0];
+      }
+
+    //A branch free form of magnet::intersection::ray_inv_sphere_bfc
+    for (size_t i(0); i < N; ++i)
+      {
+	double TD(0), T2(0), D2(0);
+	for (size_t n(0); n < NDIM; ++n)
+	  {
+	    TD += r12[n][i] * v12[n][i];
+	    T2 += r12[n][i] * r12[n][i];
+	    D2 += v12[n][i] * v12[n][i];
+	  }
+
+	const double c = d[i] * d[i] - T2;
+	const double arg = TD * TD + D2 * c;
+	const double q = TD + copysign(std::sqrt(std::max(arg, 0.0)), TD);
+	const double exitRoot = std::max(0.0, std::max(- q / D2, c / q));
+	const double closestRoot = std::max(0.0, - TD / D2);
+	dt[i] = (D2 == 0) ? HUGE_VAL : ((arg >= 0) ? exitRoot : closestRoot);
+      }
+  }
+
   ParticleEventData 
   DynNewtonian::randomGaussianEvent(Particle& part, const double& sqrtT, 
 				  const size_t dimensions) const
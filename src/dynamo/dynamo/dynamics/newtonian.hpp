@@ -38,6 +38,8 @@ namespace dynamo {
     virtual double SphereSphereInRoot(const IDRange& p1, const IDRange& p2, double d) const;
     virtual double SphereSphereOutRoot(const Particle& p1, const Particle& p2, double d) const;
     virtual double SphereSphereOutRoot(const IDRange& p1, const IDRange& p2, double d) const;  
+    virtual void SphereSphereInRoot(const Particle& p1, const size_t* IDs, const double* d, double* dt, const size_t N) const;
+    virtual void SphereSphereOutRoot(const Particle& p1, const size_t* IDs, const double* d, double* dt, const size_t N) const;
     virtual double sphereOverlap(const Particle& p1, const Particle& p2, const double& d) const;
     virtual double CubeCubeInRoot(const Particle& p1, const Particle& p2, double d) const;
     virtual bool cubeOverlap(const Particle& p1, const Particle& p2, const double d) const;
@@ -71,6 +73,22 @@ namespace dynamo {
   protected:
     virtual void outputXML(magnet::xml::XmlStream&) const;
 
+    /*! \brief Load the separation and relative velocity of a particle
+        and a list of partners into the batch arrays.
+
+	The partner data is streamed out of the \ref ParticleSoA, so
+	the partners do not need to be updated first.
+
+	\return false if the batch cannot be loaded (the \ref
+	ParticleSoA is not maintained or the boundary conditions are
+	not simple periodic/infinite) and the scalar fallback must be
+	used.
+     */
+    bool loadSphereBatch(const Particle& p1, const size_t* IDs, const size_t N) const;
+
+    mutable ParticleSoA::Array _batchR[NDIM];
+    mutable ParticleSoA::Array _batchV[NDIM];
+
     mutable long double lastAbsoluteClock;
     mutable unsigned int lastCollParticle1;
     mutable unsigned int lastCollParticle2;
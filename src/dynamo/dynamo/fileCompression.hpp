@@ -0,0 +1,60 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include <magnet/stream/bzip2.hpp>
+#include <magnet/thread/threadpool.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/bzip2.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <string>
+
+namespace dynamo {
+  //! \brief Test if a file name ends with the passed extension.
+  inline bool hasExtension(const std::string& fileName, const std::string& ext)
+  {
+    return (fileName.size() >= ext.size())
+      && !fileName.compare(fileName.size() - ext.size(), ext.size(), ext);
+  }
+
+  /*! \brief Add the compressor selected by the extension of the file
+      name to an output stream.
+
+    A ".bz2" file is compressed by the threads of the passed pool (if
+    any), as bzip2 is slow enough to dominate the time taken to write
+    a large configuration. A ".gz" file is compressed at the fastest
+    zlib setting, which trades file size for speed. Any other file is
+    left uncompressed.
+
+    \param threads The pool used to compress bzip2 files, this may be
+    NULL. The pool must not be in use by another thread.
+   */
+  inline void pushCompressor(boost::iostreams::filtering_ostream& os, 
+			     const std::string& fileName,
+			     magnet::thread::ThreadPool* threads = NULL)
+  {
+    namespace io = boost::iostreams;
+    if (hasExtension(fileName, ".bz2"))
+      {
+	if (threads && threads->getThreadCount())
+	  os.push(magnet::stream::ParallelBzip2Compressor(*threads));
+	else
+	  os.push(io::bzip2_compressor());
+      }
+    else if (hasExtension(fileName, ".gz"))
+      os.push(io::gzip_compressor(io::gzip_params(io::gzip::best_speed)));
+  }
+}
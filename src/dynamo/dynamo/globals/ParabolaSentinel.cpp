@@ -88,8 +88,7 @@ namespace dynamo {
   
     Sim->signalParticleUpdate(EDat);
 
-    BOOST_FOREACH(shared_ptr<OutputPlugin> & Ptr, Sim->outputPlugins)
-      Ptr->eventUpdate(iEvent, EDat);
+    Sim->eventUpdate(iEvent, EDat);
 
     Sim->ptrScheduler->fullUpdate(part);
   }
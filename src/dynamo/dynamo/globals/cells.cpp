@@ -36,12 +36,15 @@ namespace {
 }
 
 namespace dynamo {
+  const size_t GCells::noCell;
+
   GCells::GCells(dynamo::Simulation* nSim, const std::string& name, size_t overlink):
     GNeighbourList(nSim, "CellNeighbourList"),
     cellDimension(1,1,1),
     _oversizeCells(1.0),
     NCells(0),
-    overlink(overlink)
+    overlink(overlink),
+    partCellCount(0)
   {
     globName = name;
     dout << "Cells Loaded" << std::endl;
@@ -52,7 +55,8 @@ namespace dynamo {
     cellDimension(1,1,1),
     _oversizeCells(1.0),
     NCells(0),
-    overlink(1)
+    overlink(1),
+    partCellCount(0)
   {
     operator<<(XML);
 
@@ -136,9 +140,7 @@ namespace dynamo {
     //expect the particle to be up to date.
     Sim->dynamics->updateParticle(part);
 
-    boost::unordered_map<size_t, size_t>::iterator it = partCellData.find(part.getID());
-
-    const size_t oldCell(it->second);
+    const size_t oldCell(partCellData[part.getID()]);
 
     size_t endCell;
 
@@ -175,7 +177,7 @@ namespace dynamo {
       endCell = dendCell.getMortonNum();
     }
 
-    removeFromCellwIt(part.getID(), it);
+    removeFromCell(part.getID());
     addToCell(part.getID(), endCell);
 
     //Get rid of the virtual event we're running, an updated event is
@@ -261,11 +263,29 @@ namespace dynamo {
 
     reinitialise();
 
-    dout << "Neighbourlist contains " << partCellData.size() 
+    dout << "Neighbourlist contains " << partCellCount
 	 << " particle entries"
 	 << std::endl;
   }
 
+  void
+  GCells::reorderParticles(const std::vector<size_t>& order)
+  {
+    std::vector<size_t> newID(order.size());
+    for (size_t i(0); i < order.size(); ++i)
+      newID[order[i]] = i;
+
+    //The cells keep their contents, only the names of the particles change
+    BOOST_FOREACH(std::vector<size_t>& cell, list)
+      BOOST_FOREACH(size_t& ID, cell)
+	ID = newID[ID];
+
+    partCellData.resize(order.size(), noCell);
+    partCellSlot.resize(order.size(), 0);
+    reorderParticleData(partCellData, order);
+    reorderParticleData(partCellSlot, order);
+  }
+
   void
   GCells::reinitialise()
   {
@@ -313,6 +333,10 @@ namespace dynamo {
     cells.clear();
     list.clear();
     partCellData.clear();
+    partCellData.resize(Sim->N, noCell);
+    partCellSlot.clear();
+    partCellSlot.resize(Sim->N, 0);
+    partCellCount = 0;
     NCells = 1;
 
     for (size_t iDim = 0; iDim < NDIM; iDim++)
@@ -376,8 +400,7 @@ namespace dynamo {
 	addToCell(id);
 	if (verbose)
 	  {
-	    boost::unordered_map<size_t, size_t>::iterator it = partCellData.find(id);
-	    magnet::math::MortonNumber<3> currentCell(it->second);
+	    magnet::math::MortonNumber<3> currentCell(partCellData[id]);
 	    
 	    magnet::math::MortonNumber<3> estCell(getCellID(Sim->particles[ID].getPosition()));
 	  
@@ -394,7 +417,7 @@ namespace dynamo {
 		 << "," << currentCell[1].getRealValue()
 		 << "," << currentCell[2].getRealValue()
 		 << ">"
-		 << "\nParticle is at this distance " << Vector(p.getPosition() - calcPosition(it->second, p)).toString() << " from the cell origin"
+		 << "\nParticle is at this distance " << Vector(p.getPosition() - calcPosition(partCellData[id], p)).toString() << " from the cell origin"
 		 << "\nParticle position  " << p.getPosition().toString()	
 		 << "\nParticle wrapped distance  " << wrapped_pos.toString()	
 		 << "\nParticle relative position  " << origin_pos.toString()
@@ -406,7 +429,7 @@ namespace dynamo {
 	  }
       }
 
-    dout << "Cell loading " << float(partCellData.size()) / NCells 
+    dout << "Cell loading " << float(partCellCount) / NCells 
 	 << std::endl;
   }
 
@@ -487,6 +510,63 @@ namespace dynamo {
     return retval;
   }
   
+  void
+  GCells::visitParticleNeighbours(const magnet::math::MortonNumber<3>& particle_cell_coords,
+				  const nbHoodBlockFunc& func) const
+  {
+    magnet::math::MortonNumber<3> zero_coords;
+    for (size_t iDim(0); iDim < NDIM; ++iDim)
+      zero_coords[iDim] = (particle_cell_coords[iDim].getRealValue() + cellCount[iDim] - overlink)
+	% cellCount[iDim];
+
+    //Most cells hold only a few particles, so the IDs are gathered
+    //into a buffer on the stack and passed on in large blocks. This
+    //is measurably faster than calling back once per cell.
+    size_t block[256];
+    size_t count(0);
+
+    magnet::math::MortonNumber<3> coords(zero_coords);
+    for (size_t x(0); x < 2 * overlink + 1; ++x)
+      {
+	coords[0] = (zero_coords[0].getRealValue() + x) % cellCount[0];
+	for (size_t y(0); y < 2 * overlink + 1; ++y)
+	  {
+	    coords[1] = (zero_coords[1].getRealValue() + y) % cellCount[1];
+	    for (size_t z(0); z < 2 * overlink + 1; ++z)
+	      {
+		coords[2] = (zero_coords[2].getRealValue() + z) % cellCount[2];
+
+		BOOST_FOREACH(const size_t& id, list[coords.getMortonNum()])
+		  {
+		    block[count++] = id;
+		    if (count == 256)
+		      {
+			func(block, block + count);
+			count = 0;
+		      }
+		  }
+	      }
+	  }
+      }
+
+    if (count)
+      func(block, block + count);
+  }
+
+  void
+  GCells::visitParticleNeighbours(const Particle& part, const nbHoodBlockFunc& func) const
+  {
+    visitParticleNeighbours(magnet::math::MortonNumber<3>(partCellData[part.getID()]), func);
+  }
+
+  void
+  GCells::visitParticleLocals(const Particle& part, const nbHoodBlockFunc& func) const
+  {
+    const std::vector<size_t>& locals = cells[partCellData[part.getID()]];
+    if (!locals.empty())
+      func(&locals[0], &locals[0] + locals.size());
+  }
+
   IDRangeList
   GCells::getParticleNeighbours(const Particle& part) const
   {
@@ -19,7 +19,6 @@
 #include <dynamo/globals/neighbourList.hpp>
 #include <dynamo/particle.hpp>
 #include <magnet/math/morton_number.hpp>
-#include <boost/unordered_map.hpp>
 #include <vector>
 
 namespace dynamo {
@@ -46,6 +45,11 @@ namespace dynamo {
     efficient however, the vector is much more cache friendly and can
     boost performance by 50% in cases where the cell has multiple
     particles inside of it.
+
+    The cell of each particle, and its position (slot) in the cell's
+    vector, are stored in flat arrays indexed by the particle ID. A
+    particle is removed from a cell by swapping the last particle of
+    the cell into its slot, so a cell transition costs O(1).
    */
   class GCells: public GNeighbourList
   {
@@ -63,9 +67,14 @@ namespace dynamo {
 
     virtual void reinitialise();
 
+    virtual void reorderParticles(const std::vector<size_t>& order);
+
     virtual IDRangeList getParticleNeighbours(const Particle&) const;
     virtual IDRangeList getParticleNeighbours(const Vector&) const;
     virtual IDRangeList getParticleLocals(const Particle&) const;
+
+    virtual void visitParticleNeighbours(const Particle&, const nbHoodBlockFunc&) const;
+    virtual void visitParticleLocals(const Particle&, const nbHoodBlockFunc&) const;
     
     virtual void operator<<(const magnet::xml::Node&);
 
@@ -76,6 +85,7 @@ namespace dynamo {
 
   protected:
     IDRangeList getParticleNeighbours(const magnet::math::MortonNumber<3>&) const;
+    void visitParticleNeighbours(const magnet::math::MortonNumber<3>&, const nbHoodBlockFunc&) const;
 
     size_t cellCount[3];
     magnet::math::DilatedInteger<3> dilatedCellMax[3];
@@ -98,10 +108,18 @@ namespace dynamo {
 
     /*! \brief The cell for a given particle.
       
-      This container is an unordered map, so we only store the linked
-      list for the particles actually inserted into this neighborlist.
+      Particles which are not in this neighbour list are marked with
+      \ref noCell.
      */
-    mutable boost::unordered_map<size_t, size_t> partCellData;
+    mutable std::vector<size_t> partCellData;
+
+    //! \brief The position of each particle in its cell's vector in \ref list.
+    mutable std::vector<size_t> partCellSlot;
+
+    //! \brief The number of particles in the cells.
+    mutable size_t partCellCount;
+
+    static const size_t noCell = ~size_t(0);
 
     GCells(const GCells&);
 
@@ -124,38 +142,41 @@ namespace dynamo {
 
     inline void addToCell(size_t ID, size_t cellID) const
     {
+      //Particles may be added to the simulation after the cells are built
+      if (ID >= partCellData.size())
+	{
+	  partCellData.resize(ID + 1, noCell);
+	  partCellSlot.resize(ID + 1, 0);
+	}
+
+#ifdef DYNAMO_DEBUG
+      if (partCellData[ID] != noCell)
+	M_throw() << "Adding a particle (ID=" << ID << ") which is already in a cell";
+#endif
+
+      partCellSlot[ID] = list[cellID].size();
       list[cellID].push_back(ID);
       partCellData[ID] = cellID;
+      ++partCellCount;
     }
   
     inline void removeFromCell(size_t ID) const
-    { removeFromCellwIt(ID, partCellData.find(ID)); }
-
-    inline void removeFromCellwIt(size_t ID, boost::unordered_map<size_t, size_t>::iterator it) const
     {
 #ifdef DYNAMO_DEBUG
-    if (it == partCellData.end())
-      M_throw() << "Could not find the particle's cell data";
-#endif
-      const size_t cellID = it->second;
-      //Erase the cell data
-      partCellData.erase(it);
-
-      std::vector<std::vector<size_t> >::iterator listIt = list.begin() + cellID;
-#ifdef DYNAMO_DEBUG
-    if (listIt == list.end())
-      M_throw() << "Could not find the particle's cell data";
+      if ((ID >= partCellData.size()) || (partCellData[ID] == noCell))
+	M_throw() << "Removing a particle (ID=" << ID << ") which is not in a cell";
 #endif
 
-      std::vector<size_t>::iterator pit = std::find(listIt->begin(), listIt->end(), ID);      
+      std::vector<size_t>& cell = list[partCellData[ID]];
+      const size_t slot = partCellSlot[ID];
 
-#ifdef DYNAMO_DEBUG
-      if (pit == listIt->end())
-	M_throw() << "Removing a particle (ID=" << ID << ") which is not in a cell";
-#endif
+      //Move the last particle of the cell into the slot
+      cell[slot] = cell.back();
+      partCellSlot[cell[slot]] = slot;
+      cell.pop_back();
 
-      *pit = listIt->back();
-      listIt->pop_back();
+      partCellData[ID] = noCell;
+      --partCellCount;
     }
   };
 }
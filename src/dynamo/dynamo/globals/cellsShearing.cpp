@@ -300,6 +300,20 @@ namespace dynamo {
     return getParticleNeighbours(magnet::math::MortonNumber<3>(getCellID(vec)));
   }
 
+  void
+  GCellsShearing::visitParticleNeighbours(const Particle& part, const nbHoodBlockFunc& func) const
+  {
+    const magnet::math::MortonNumber<3> cellCoords(partCellData[part.getID()]);
+    GCells::visitParticleNeighbours(cellCoords, func);
+
+    if ((cellCoords[1] == 0) || (cellCoords[1] == dilatedCellMax[1]))
+      {
+	const std::vector<size_t> extra(getAdditionalLEParticleNeighbourhood(cellCoords));
+	if (!extra.empty())
+	  func(&extra[0], &extra[0] + extra.size());
+      }
+  }
+
   IDRangeList
   GCellsShearing::getParticleNeighbours(const magnet::math::MortonNumber<3>& cellCoords) const
   {
@@ -37,6 +37,7 @@ namespace dynamo {
 
     virtual IDRangeList getParticleNeighbours(const Particle&) const;
     virtual IDRangeList getParticleNeighbours(const Vector&) const;
+    virtual void visitParticleNeighbours(const Particle&, const nbHoodBlockFunc&) const;
 
   protected:
     IDRangeList getParticleNeighbours(const magnet::math::MortonNumber<3>&) const;
@@ -68,6 +68,12 @@ namespace dynamo {
      */
     virtual void initialise(size_t) = 0;
 
+    /*! \brief Called when the particle IDs are renumbered (see \ref
+        Simulation::reorderParticles). The new particle i was
+        previously the particle order[i].
+     */
+    virtual void reorderParticles(const std::vector<size_t>& order) {}
+
     /*! \brief Helper function for saving an XML representation of this
      * class.
      */
@@ -90,6 +96,10 @@ namespace dynamo {
      */
     const std::string& getName() const { return globName; }
 
+    /*! \brief Returns the range of particles this Global acts on.
+     */
+    const shared_ptr<IDRange>& getRange() const { return range; }
+
     /*! \brief Returns the unique ID number of this Global.
      */
     inline const size_t& getID() const { return ID; }
@@ -50,6 +50,13 @@ namespace dynamo {
      */
     typedef magnet::function::Delegate1
     <const size_t&, void> nbHoodFunc2;
+
+    /*! \brief The type of function that is called back with each
+      block of IDs, [begin, end), when walking the neighbourhood of a
+      particle (see \ref visitParticleNeighbours).
+     */
+    typedef magnet::function::Delegate2
+    <const size_t*, const size_t*, void> nbHoodBlockFunc;
   
     /*! \brief The type of function that can be registered for callbacks
      * when the neighbourlist is reinitialized.
@@ -97,6 +104,21 @@ namespace dynamo {
     virtual IDRangeList getParticleNeighbours(const Vector&) const = 0;
     virtual IDRangeList getParticleLocals(const Particle&) const = 0;
 
+    /*! \brief Pass the IDs of the neighbours of a particle to a
+      callback.
+
+      Unlike \ref getParticleNeighbours, no list of the IDs is
+      allocated. The IDs are passed in blocks held on the stack (or
+      directly out of the neighbour list), so the callback may be
+      called several times. Empty blocks are skipped.
+     */
+    virtual void visitParticleNeighbours(const Particle&, const nbHoodBlockFunc&) const = 0;
+
+    /*! \brief Pass the IDs of the \ref Local events of a particle to
+      a callback (see \ref visitParticleNeighbours).
+     */
+    virtual void visitParticleLocals(const Particle&, const nbHoodBlockFunc&) const = 0;
+
     template<class T> size_t
     ConnectSigCellChangeNotify
     (void (T::*func)(const Particle&, const size_t&)const , const T* tp) const 
@@ -19,34 +19,195 @@
 #include <dynamo/particle.hpp>
 #include <dynamo/schedulers/scheduler.hpp>
 #include <dynamo/simulation.hpp>
+#include <dynamo/dynamics/compression.hpp>
+#include <dynamo/BC/PBC.hpp>
+#include <magnet/thread/threadpool.hpp>
 #include <magnet/xmlwriter.hpp>
 #include <magnet/xmlreader.hpp>
 #include <boost/foreach.hpp>
+#include <typeinfo>
+#include <cmath>
 
 namespace dynamo {
-  void 
-  ISingleCapture::testAddToCaptureMap(const Particle& p1, const size_t& p2) const
+  struct ICapture::CaptureCells
   {
-    if (captureTest(p1, Sim->particles[p2]))
-      addToCaptureMap(p1, Sim->particles[p2]);
-  }   
+    //! The number of cells in each dimension.
+    size_t count[3];
+    //! The first particle in each cell (or Sim->N if empty).
+    std::vector<size_t> head;
+    //! The next particle in the same cell (or Sim->N for the last).
+    std::vector<size_t> next;
+  };
 
+  struct ICapture::CaptureTask
+  {
+    size_t start;
+    size_t end;
+    //! The captured pairs found by this task and their state.
+    std::vector<std::pair<cMapKey, int> > pairs;
+  };
 
   void 
   ICapture::initCaptureMap()
   {
-    //If not loaded or invalidated
-    if (noXmlLoad)
-      {      
-	clear();
+    if (Sim->N && ((Sim->N - 1) > cMapKey::maxID))
+      M_throw() << "Too many particles (N=" << Sim->N << ") for the capture map keys";
+
+    //If loaded and not invalidated
+    if (!noXmlLoad) return;
+
+    clear();
+
+    //The interaction distance grows with the particles in
+    //compressing systems
+    double cutoff = maxIntDist();
+    if (const DynCompression* dynamics = dynamic_cast<const DynCompression*>(Sim->dynamics.get()))
+      cutoff *= 1 + Sim->systemTime * dynamics->getGrowthRate();
+
+    //The cells must be at least the cutoff wide, and there must be
+    //at least three in each dimension so that the neighbouring cells
+    //are distinct. There is no point having many more cells than
+    //particles.
+    CaptureCells cells;
+    bool useCells = (NDIM == 3) && (typeid(*Sim->BCs) == typeid(BCPeriodic)) && (cutoff > 0);
+    const size_t maxCount = 3 + static_cast<size_t>(std::pow(double(Sim->N), 1.0 / 3.0));
+    for (size_t iDim(0); useCells && (iDim < NDIM); ++iDim)
+      {
+	cells.count[iDim] = std::min(maxCount, static_cast<size_t>(Sim->primaryCellSize[iDim] / cutoff));
+	useCells = cells.count[iDim] >= 3;
+      }
 
+    if (!useCells)
+      {
 	for (std::vector<Particle>::const_iterator iPtr1 = Sim->particles.begin();
 	     iPtr1 != Sim->particles.end(); iPtr1++)
 	  for (std::vector<Particle>::const_iterator iPtr2 = iPtr1+1;
 	       iPtr2 != Sim->particles.end(); iPtr2++)
 	    //Check this interaction is the correct interaction for the pair
 	    if (Sim->getInteraction(*iPtr1, *iPtr2).get() == static_cast<const Interaction*>(this))
-	      testAddToCaptureMap(*iPtr1, iPtr2->getID());
+	      {
+		const int state = captureState(*iPtr1, *iPtr2);
+		if (state) setCaptureState(iPtr1->getID(), iPtr2->getID(), state);
+	      }
+	return;
+      }
+
+    //Build the linked lists of the particles in each cell
+    const size_t nCells = cells.count[0] * cells.count[1] * cells.count[2];
+    cells.head.assign(nCells, Sim->N);
+    cells.next.resize(Sim->N);
+
+    //Insert in reverse so each cell lists its particles in ascending order
+    for (size_t ID(Sim->N); ID != 0; --ID)
+      {
+	Vector pos = Sim->particles[ID - 1].getPosition();
+	Sim->BCs->applyBC(pos);
+
+	size_t cellID = 0;
+	for (size_t iDim(NDIM); iDim != 0; --iDim)
+	  {
+	    const double width = Sim->primaryCellSize[iDim - 1] / cells.count[iDim - 1];
+	    long coord = std::floor((pos[iDim - 1] + 0.5 * Sim->primaryCellSize[iDim - 1]) / width);
+	    //Guard against rounding at the edges of the primary image
+	    coord = std::max(0l, std::min(coord, long(cells.count[iDim - 1]) - 1));
+	    cellID = cellID * cells.count[iDim - 1] + coord;
+	  }
+
+	cells.next[ID - 1] = cells.head[cellID];
+	cells.head[cellID] = ID - 1;
+      }
+
+    //Several tasks per thread to balance the load
+    const size_t nTasks = Sim->threads 
+      ? std::min(8 * std::max(Sim->threads->getThreadCount(), size_t(1)), nCells) : 1;
+    const size_t stride = (nCells + nTasks - 1) / nTasks;
+
+    std::vector<CaptureTask> taskData((nCells + stride - 1) / stride);
+    for (size_t task(0); task < taskData.size(); ++task)
+      {
+	taskData[task].start = task * stride;
+	taskData[task].end = std::min((task + 1) * stride, nCells);
+      }
+
+    if (Sim->threads)
+      {
+	std::vector<magnet::function::Task*> tasks;
+	BOOST_FOREACH(CaptureTask& task, taskData)
+	  tasks.push_back(magnet::function::Task::makeTask(&ICapture::captureCellRange, 
+							   static_cast<const ICapture*>(this),
+							   static_cast<const CaptureCells*>(&cells), &task));
+
+	Sim->threads->queueTasks(tasks);
+	Sim->threads->wait();
+      }
+    else
+      captureCellRange(&cells, &taskData[0]);
+
+    //Merge in task order so the result is independent of the thread count
+    typedef std::pair<cMapKey, int> locpair;
+    BOOST_FOREACH(const CaptureTask& task, taskData)
+      BOOST_FOREACH(const locpair& pair, task.pairs)
+      setCaptureState(pair.first.first(), pair.first.second(), pair.second);
+  }
+
+  size_t
+  ICapture::checkCaptureMap() const
+  {
+    size_t differences = 0;
+    size_t found = 0;
+    for (std::vector<Particle>::const_iterator iPtr1 = Sim->particles.begin();
+	 iPtr1 != Sim->particles.end(); iPtr1++)
+      for (std::vector<Particle>::const_iterator iPtr2 = iPtr1+1;
+	   iPtr2 != Sim->particles.end(); iPtr2++)
+	if (Sim->getInteraction(*iPtr1, *iPtr2).get() == static_cast<const Interaction*>(this))
+	  {
+	    const int stored = getCaptureState(iPtr1->getID(), iPtr2->getID());
+	    if (stored) ++found;
+	    if (stored != captureState(*iPtr1, *iPtr2)) ++differences;
+	  }
+
+    //Any remaining entries belong to pairs of other interactions
+    return differences + getTotalCaptureCount() - found;
+  }
+
+  void
+  ICapture::captureCellRange(const CaptureCells* cells, CaptureTask* task) const
+  {
+    const size_t* const count = cells->count;
+
+    for (size_t cellID(task->start); cellID < task->end; ++cellID)
+      {
+	const long coords[3] = {long(cellID % count[0]), 
+				long((cellID / count[0]) % count[1]),
+				long(cellID / (count[0] * count[1]))};
+
+	for (long x(coords[0] - 1); x <= coords[0] + 1; ++x)
+	  for (long y(coords[1] - 1); y <= coords[1] + 1; ++y)
+	    for (long z(coords[2] - 1); z <= coords[2] + 1; ++z)
+	      {
+		const size_t nbCell 
+		  = ((x + count[0]) % count[0])
+		  + count[0] * (((y + count[1]) % count[1])
+				+ count[1] * ((z + count[2]) % count[2]));
+
+		for (size_t p1(cells->head[cellID]); p1 != Sim->N; p1 = cells->next[p1])
+		  {
+		    const Particle& part1 = Sim->particles[p1];
+
+		    //Each pair is only tested from its lowest ID
+		    for (size_t p2(cells->head[nbCell]); p2 != Sim->N; p2 = cells->next[p2])
+		      if (p2 > p1)
+			{
+			  const Particle& part2 = Sim->particles[p2];
+			  //Check this interaction is the correct interaction for the pair
+			  if (Sim->getInteraction(part1, part2).get() != static_cast<const Interaction*>(this))
+			    continue;
+
+			  const int state = captureState(part1, part2);
+			  if (state) task->pairs.push_back(std::make_pair(cMapKey(p1, p2), state));
+			}
+		  }
+	      }
       }
   }
 
@@ -61,19 +222,33 @@ namespace dynamo {
 	for (magnet::xml::Node node = XML.getNode("CaptureMap").fastGetNode("Pair");
 	     node.valid(); ++node)
 	  captureMap.insert(cMapKey(node.getAttribute("ID1").as<size_t>(),
-				    node.getAttribute("ID2").as<size_t>()));
+				    node.getAttribute("ID2").as<size_t>()).key);
       }
   }
 
+  void
+  ISingleCapture::reorderParticles(const std::vector<size_t>& order)
+  {
+    std::vector<size_t> newID(order.size());
+    for (size_t i(0); i < order.size(); ++i)
+      newID[order[i]] = i;
+
+    magnet::containers::OpenHashSet newMap;
+    newMap.reserve(captureMap.size());
+    BOOST_FOREACH(const uint64_t& key, captureMap)
+      newMap.insert(cMapKey(newID[cMapKey(key).first()], newID[cMapKey(key).second()]).key);
+    captureMap.swap(newMap);
+  }
+
   void 
   ISingleCapture::outputCaptureMap(magnet::xml::XmlStream& XML) const 
   {
     XML << magnet::xml::tag("CaptureMap");
 
-    BOOST_FOREACH(const cMapKey& IDs, captureMap)
+    BOOST_FOREACH(const uint64_t& key, captureMap)
       XML << magnet::xml::tag("Pair")
-	  << magnet::xml::attr("ID1") << IDs.first
-	  << magnet::xml::attr("ID2") << IDs.second
+	  << magnet::xml::attr("ID1") << cMapKey(key).first()
+	  << magnet::xml::attr("ID2") << cMapKey(key).second()
 	  << magnet::xml::endtag("Pair");
   
     XML << magnet::xml::endtag("CaptureMap");
@@ -82,13 +257,6 @@ namespace dynamo {
   //////////////////////////////////////////////////////
   //////////////////////////////////////////////////////
 
-  void 
-  IMultiCapture::testAddToCaptureMap(const Particle& p1, const size_t& p2) const
-  {
-    int capval = captureTest(p1, Sim->particles[p2]);
-    if (capval) captureMap[cMapKey(p1.getID(), p2)] = capval; 
-  }
-
   void 
   IMultiCapture::loadCaptureMap(const magnet::xml::Node& XML)
   {
@@ -100,22 +268,38 @@ namespace dynamo {
 	for (magnet::xml::Node node = XML.getNode("CaptureMap").fastGetNode("Pair");
 	     node.valid(); ++node)
 	  captureMap[cMapKey(node.getAttribute("ID1").as<size_t>(),
-			     node.getAttribute("ID2").as<size_t>())]
+			     node.getAttribute("ID2").as<size_t>()).key]
 	    = node.getAttribute("val").as<size_t>();
       }
   }
 
+  void
+  IMultiCapture::reorderParticles(const std::vector<size_t>& order)
+  {
+    std::vector<size_t> newID(order.size());
+    for (size_t i(0); i < order.size(); ++i)
+      newID[order[i]] = i;
+
+    typedef std::pair<uint64_t, int> locpair;
+
+    captureMapType newMap;
+    newMap.reserve(captureMap.size());
+    BOOST_FOREACH(const locpair& IDs, captureMap)
+      newMap[cMapKey(newID[cMapKey(IDs.first).first()], newID[cMapKey(IDs.first).second()]).key] = IDs.second;
+    captureMap.swap(newMap);
+  }
+
   void 
   IMultiCapture::outputCaptureMap(magnet::xml::XmlStream& XML) const 
   {
     XML << magnet::xml::tag("CaptureMap");
 
-    typedef std::pair<const cMapKey, int> locpair;
+    typedef std::pair<uint64_t, int> locpair;
 
     BOOST_FOREACH(const locpair& IDs, captureMap)
       XML << magnet::xml::tag("Pair")
-	  << magnet::xml::attr("ID1") << IDs.first.first
-	  << magnet::xml::attr("ID2") << IDs.first.second
+	  << magnet::xml::attr("ID1") << cMapKey(IDs.first).first()
+	  << magnet::xml::attr("ID2") << cMapKey(IDs.first).second()
 	  << magnet::xml::attr("val") << IDs.second
 	  << magnet::xml::endtag("Pair");
   
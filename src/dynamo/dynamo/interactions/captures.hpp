@@ -20,8 +20,8 @@
 #include <dynamo/particle.hpp>
 #include <dynamo/interactions/interaction.hpp>
 #include <magnet/exception.hpp>
-#include <boost/tr1/unordered_set.hpp>
-#include <boost/tr1/unordered_map.hpp>
+#include <magnet/containers/open_hash.hpp>
+#include <stdint.h>
 #include <vector>
 
 namespace dynamo {
@@ -56,32 +56,79 @@ namespace dynamo {
     //! \brief Add a pair of particles to the capture map.
     virtual void addToCaptureMap(const Particle& p1, const Particle& p2) const = 0;
 
+    /*! \brief Rebuild the capture map from the current configuration
+        (unless one was loaded from the xml file).
+
+      Pairs can only be captured within the interaction distance. In
+      plain periodic systems the particles are sorted into a private
+      grid of cells at least this wide and only pairs in neighbouring
+      cells are tested, which makes the rebuild O(N). The cells are
+      split over the simulation's ThreadPool (if available), each task
+      collecting its captured pairs, which are then merged into the
+      map. Otherwise every pair of particles is tested.
+     */
     void initCaptureMap();
 
+    /*! \brief Count the pairs whose entry in the capture map differs
+        from their current state.
+
+      Every pair of particles is tested (not just those in
+      neighbouring cells), so this is an O(N^2) check of the capture
+      map (see Simulation::checkSystem). Entries for pairs which are
+      not handled by this Interaction are also counted.
+     */
+    size_t checkCaptureMap() const;
+
     virtual void clear() const = 0;
     
   protected:
     bool noXmlLoad;
 
-    virtual void testAddToCaptureMap(const Particle& p1, const size_t& p2) const = 0;
+    //! \brief The captured state of a pair (zero if not captured).
+    virtual int captureState(const Particle& p1, const Particle& p2) const = 0;
+
+    //! \brief Store a non-zero captured state of a pair in the capture map.
+    virtual void setCaptureState(const size_t& p1, const size_t& p2, const int state) const = 0;
+
+    //! \brief The state of a pair stored in the capture map (zero if not captured).
+    virtual int getCaptureState(const size_t& p1, const size_t& p2) const = 0;
+
+    struct CaptureCells;
+    struct CaptureTask;
+
+    //! \brief Test the pairs with a particle in the task's range of cells.
+    void captureCellRange(const CaptureCells* cells, CaptureTask* task) const;
 
     /*! \brief A key used to represent two particles.
      
-      This key sorts the particle ID's into ascending order. This way
-      the keys can be compared and symmetric keys will compare equal.
+      This key sorts the particle ID's into ascending order and packs
+      them into a single 64 bit integer (the lower ID in the high
+      bits), which is what the capture maps store. This way the keys
+      can be compared and symmetric keys will compare equal.
       \code assert(cMapKey(a,b) == cMapKey(b,a)); \endcode
      */
-    struct cMapKey: public std::pair<size_t,size_t>
+    struct cMapKey
     {
-      inline cMapKey() {}
+      inline explicit cMapKey(const uint64_t& k): key(k) {}
     
       inline cMapKey(const size_t& a, const size_t& b):
-	std::pair<size_t,size_t>(std::min(a, b), std::max(a, b))
+	key((uint64_t(std::min(a, b)) << 32) | uint64_t(std::max(a, b)))
       {
 #ifdef DYNAMO_DEBUG
 	if (a == b) M_throw() << "Particle ID's should not be equal!";
+	if (std::max(a, b) > maxID) M_throw() << "Particle ID's are too large for a cMapKey";
 #endif
       }
+
+      inline size_t first() const { return key >> 32; }
+      inline size_t second() const { return key & maxID; }
+
+      inline bool operator==(const cMapKey& o) const { return key == o.key; }
+
+      uint64_t key;
+
+      //! The largest particle ID which can be packed into a key.
+      static const uint64_t maxID = 0xFFFFFFFFul;
     };
   };
 
@@ -100,13 +147,15 @@ namespace dynamo {
     size_t getTotalCaptureCount() const { return captureMap.size(); }
   
     virtual bool isCaptured(const Particle& p1, const Particle& p2) const
-    { return captureMap.count(cMapKey(p1.getID(), p2.getID())); }
+    { return captureMap.count(cMapKey(p1.getID(), p2.getID()).key); }
 
     virtual void clear() const { captureMap.clear(); }
 
+    virtual void reorderParticles(const std::vector<size_t>& order);
+
   protected:
 
-    mutable std::tr1::unordered_set<cMapKey > captureMap;
+    mutable magnet::containers::OpenHashSet captureMap;
 
     /*! \brief Test if two particles should be "captured".
     
@@ -130,29 +179,36 @@ namespace dynamo {
      */
     void outputCaptureMap(magnet::xml::XmlStream&) const;
 
-    virtual void testAddToCaptureMap(const Particle& p1, const size_t& p2) const;
+    virtual int captureState(const Particle& p1, const Particle& p2) const
+    { return captureTest(p1, p2); }
+
+    virtual void setCaptureState(const size_t& p1, const size_t& p2, const int) const
+    { captureMap.insert(cMapKey(p1, p2).key); }
+
+    virtual int getCaptureState(const size_t& p1, const size_t& p2) const
+    { return captureMap.count(cMapKey(p1, p2).key); }
 
     //! \brief Add a pair of particles to the capture map
     void addToCaptureMap(const Particle& p1, const Particle& p2) const
     {
 #ifdef DYNAMO_DEBUG
-      if (captureMap.count(cMapKey(p1.getID(), p2.getID())))
+      if (captureMap.count(cMapKey(p1.getID(), p2.getID()).key))
 	M_throw() << "Insert found " << std::min(p1.getID(), p2.getID())
 		  << " and " << std::max(p1.getID(), p2.getID()) << " in the capture map";
 #endif
     
-      captureMap.insert(cMapKey(p1.getID(), p2.getID()));
+      captureMap.insert(cMapKey(p1.getID(), p2.getID()).key);
     }
   
     //! \brief Remove a pair of particles to the capture map.
     void removeFromCaptureMap(const Particle& p1, const Particle& p2) const
     {
 #ifdef DYNAMO_DEBUG
-      if (captureMap.find(cMapKey(p1.getID(), p2.getID())) == captureMap.end())
+      if (!captureMap.count(cMapKey(p1.getID(), p2.getID()).key))
 	M_throw() << "Deleting a particle while its already gone!";
 #endif
 
-      captureMap.erase(cMapKey(p1.getID(), p2.getID()));
+      captureMap.erase(cMapKey(p1.getID(), p2.getID()).key);
     } 
 
   };
@@ -168,13 +224,15 @@ namespace dynamo {
     size_t getTotalCaptureCount() const { return captureMap.size(); }
   
     virtual bool isCaptured(const Particle& p1, const Particle& p2) const
-    { return captureMap.count(cMapKey(p1.getID(), p2.getID())); }
+    { return captureMap.count(cMapKey(p1.getID(), p2.getID()).key); }
 
     virtual void clear() const { captureMap.clear(); }
 
+    virtual void reorderParticles(const std::vector<size_t>& order);
+
   protected:
   
-    typedef std::tr1::unordered_map<cMapKey, int, boost::hash<cMapKey> > captureMapType;
+    typedef magnet::containers::OpenHashMap<int> captureMapType;
     typedef captureMapType::iterator cmap_it;
     typedef captureMapType::const_iterator const_cmap_it;
 
@@ -187,30 +245,40 @@ namespace dynamo {
     void outputCaptureMap(magnet::xml::XmlStream&) const;
 
     inline cmap_it getCMap_it(const Particle& p1, const Particle& p2) const
-    { return captureMap.find(cMapKey(p1.getID(), p2.getID())); }
+    { return captureMap.find(cMapKey(p1.getID(), p2.getID()).key); }
 
     inline void addToCaptureMap(const Particle& p1, const Particle& p2) const
     {
 #ifdef DYNAMO_DEBUG
-      if (captureMap.find(cMapKey(p1.getID(), p2.getID())) != captureMap.end())
+      if (captureMap.count(cMapKey(p1.getID(), p2.getID()).key))
 	M_throw() << "Adding a particle while its already added!";
 #endif
     
-      captureMap[cMapKey(p1.getID(), p2.getID())] = 1;
+      captureMap[cMapKey(p1.getID(), p2.getID()).key] = 1;
     }
 
     //! \brief Add a pair of particles to the capture map
     void addToCaptureMap(const Particle& p1, const size_t& p2) const;
 
-    virtual void testAddToCaptureMap(const Particle& p1, const size_t& p2) const;
+    virtual int captureState(const Particle& p1, const Particle& p2) const
+    { return captureTest(p1, p2); }
+
+    virtual void setCaptureState(const size_t& p1, const size_t& p2, const int state) const
+    { captureMap[cMapKey(p1, p2).key] = state; }
+
+    virtual int getCaptureState(const size_t& p1, const size_t& p2) const
+    {
+      cmap_it it = captureMap.find(cMapKey(p1, p2).key);
+      return (it == captureMap.end()) ? 0 : it->second;
+    }
 
     inline void delFromCaptureMap(const Particle& p1, const Particle& p2) const
     {
 #ifdef DYNAMO_DEBUG
-      if (captureMap.find(cMapKey(p1.getID(), p2.getID())) == captureMap.end())
+      if (!captureMap.count(cMapKey(p1.getID(), p2.getID()).key))
 	M_throw() << "Deleting a particle while its already gone!";
 #endif 
-      captureMap.erase(cMapKey(p1.getID(), p2.getID()));
+      captureMap.erase(cMapKey(p1.getID(), p2.getID()).key);
     }
   };
 }
@@ -111,6 +111,31 @@ namespace dynamo {
     return IntEvent(p1,p2,HUGE_VAL, NONE, *this);  
   }
 
+  void
+  IHardSphere::getEvents(const Particle& p1, const size_t* IDs, 
+			 IntEvent* events, const size_t N) const
+  {
+    if (!N) return;
+
+    _batchD.resize(N);
+    _batchDt.resize(N);
+
+    const double d1(_diameter->getProperty(p1.getID()));
+    for (size_t i(0); i < N; ++i)
+      _batchD[i] = (d1 + _diameter->getProperty(IDs[i])) * 0.5;
+
+    Sim->dynamics->SphereSphereInRoot(p1, IDs, &_batchD[0], &_batchDt[0], N);
+
+    for (size_t i(0); i < N; ++i)
+      {
+	const Particle& p2(Sim->particles[IDs[i]]);
+	if (_batchDt[i] != HUGE_VAL)
+	  events[i] = IntEvent(p1, p2, _batchDt[i], CORE, *this);
+	else
+	  events[i] = IntEvent(p1, p2, HUGE_VAL, NONE, *this);
+      }
+  }
+
   void
   IHardSphere::runEvent(Particle& p1, Particle& p2, const IntEvent& iEvent) const
   {
@@ -131,8 +156,7 @@ namespace dynamo {
     //Now we're past the event, update the scheduler and plugins
     Sim->ptrScheduler->fullUpdate(p1, p2);
   
-    BOOST_FOREACH(shared_ptr<OutputPlugin> & Ptr, Sim->outputPlugins)
-      Ptr->eventUpdate(iEvent,EDat);
+    Sim->eventUpdate(iEvent,EDat);
   }
    
   void 
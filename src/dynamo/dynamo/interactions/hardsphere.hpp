@@ -20,6 +20,7 @@
 #include <dynamo/interactions/interaction.hpp>
 #include <dynamo/simulation.hpp>
 #include <dynamo/interactions/glyphrepresentation.hpp>
+#include <vector>
 
 namespace dynamo {
   class IHardSphere: public GlyphRepresentation, public Interaction
@@ -56,6 +57,8 @@ namespace dynamo {
     virtual void rescaleLengths(double) {}
 
     virtual IntEvent getEvent(const Particle&, const Particle&) const;
+
+    virtual void getEvents(const Particle&, const size_t*, IntEvent*, const size_t) const;
  
     virtual void runEvent(Particle&, Particle&, const IntEvent&) const;
    
@@ -66,5 +69,8 @@ namespace dynamo {
   protected:
     shared_ptr<Property> _diameter;
     shared_ptr<Property> _e;
+
+    mutable std::vector<double> _batchD;
+    mutable std::vector<double> _batchDt;
   };
 }
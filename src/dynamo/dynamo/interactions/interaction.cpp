@@ -20,6 +20,7 @@
 #include <dynamo/interactions/intEvent.hpp>
 #include <dynamo/species/species.hpp>
 #include <dynamo/simulation.hpp>
+#include <dynamo/dynamics/dynamics.hpp>
 #include <magnet/xmlreader.hpp>
 #include <cstring>
 
@@ -33,6 +34,18 @@ namespace dynamo {
   Interaction::operator<<(const magnet::xml::Node& XML)
   { range = shared_ptr<IDPairRange>(IDPairRange::getClass(XML.getNode("IDPairRange"), Sim)); }
 
+  void
+  Interaction::getEvents(const Particle& p1, const size_t* IDs, 
+			 IntEvent* events, const size_t N) const
+  {
+    for (size_t i(0); i < N; ++i)
+      {
+	Particle& p2(Sim->particles[IDs[i]]);
+	Sim->dynamics->updateParticle(p2);
+	events[i] = getEvent(p1, p2);
+      }
+  }
+
   bool 
   Interaction::isInteraction(const IntEvent &coll) const
   { 
@@ -69,6 +69,23 @@ namespace dynamo {
     virtual IntEvent getEvent(const Particle &, 
 			      const Particle &) const = 0;
 
+    /*! \brief Calculate the events between a particle and a list of
+        partner particles.
+
+	This is used by the Scheduler to test all the neighbours of a
+	particle in one call, allowing the Interaction to use the
+	batched primitives of the Dynamics. The default implementation
+	updates each partner and calls getEvent.
+
+	\param p1 The particle to test, this must be up to date.
+	\param IDs The IDs of the N partner particles, these need not be
+	up to date.
+	\param events The N events (output).
+	\param N The number of partner particles.
+     */
+    virtual void getEvents(const Particle& p1, const size_t* IDs, 
+			   IntEvent* events, const size_t N) const;
+
     /*! \brief Run the dynamics of an event which is occuring now.
      */
     virtual void runEvent(Particle&, Particle&, const IntEvent&) const = 0;
@@ -94,6 +111,12 @@ namespace dynamo {
      */
     virtual double getExcludedVolume(size_t) const = 0;
 
+    /*! \brief Called when the particle IDs are renumbered (see \ref
+        Simulation::reorderParticles). The new particle i was
+        previously the particle order[i].
+     */
+    virtual void reorderParticles(const std::vector<size_t>& order) {}
+
     /*! \brief Loads the parameters of the Interaction from an XML
         node in the configuration file.
      */
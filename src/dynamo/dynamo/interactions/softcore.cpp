@@ -155,8 +155,7 @@ namespace dynamo {
 	  Sim->signalParticleUpdate(retVal);
 	  Sim->ptrScheduler->fullUpdate(p1, p2);
 	
-	  BOOST_FOREACH(shared_ptr<OutputPlugin> & Ptr, Sim->outputPlugins)
-	    Ptr->eventUpdate(iEvent, retVal);
+	  Sim->eventUpdate(iEvent, retVal);
 
 
 	  break;
@@ -173,9 +172,7 @@ namespace dynamo {
 	  //Now we're past the event, update the scheduler and plugins
 	  Sim->ptrScheduler->fullUpdate(p1, p2);
 	
-	  BOOST_FOREACH(shared_ptr<OutputPlugin>& Ptr, 
-			Sim->outputPlugins)
-	    Ptr->eventUpdate(iEvent, retVal);
+	  Sim->eventUpdate(iEvent, retVal);
 
 	  break;
 	}
@@ -236,11 +233,13 @@ namespace dynamo {
   { 
     //Once the capture maps are loaded just iterate through that determining energies
     double Energy = 0.0;
-    typedef std::pair<size_t, size_t> locpair;
 
-    BOOST_FOREACH(const locpair& IDs, captureMap)
-      Energy += 0.5 * (_wellDepth->getProperty(IDs.first)
-		       +_wellDepth->getProperty(IDs.second));
+    BOOST_FOREACH(const uint64_t& key, captureMap)
+      {
+	const cMapKey IDs(key);
+	Energy += 0.5 * (_wellDepth->getProperty(IDs.first())
+			 +_wellDepth->getProperty(IDs.second()));
+      }
   
     return -Energy; 
   }
@@ -168,6 +168,73 @@ namespace dynamo {
     return retval;
   }
 
+  void
+  ISquareWell::getEvents(const Particle& p1, const size_t* IDs, 
+			 IntEvent* events, const size_t N) const
+  {
+    if (!N) return;
+
+    _batchD.resize(N);
+    _batchDt.resize(N);
+    _batchOutIDs.clear();
+    _batchOutIdx.clear();
+    _batchOutD.clear();
+
+    //Captured pairs test for the inner core, the others for the
+    //outer well. The captured pairs are also collected for the
+    //well-exit test.
+    const double d1(_diameter->getProperty(p1.getID()));
+    const double l1(_lambda->getProperty(p1.getID()));
+    for (size_t i(0); i < N; ++i)
+      {
+	const double d = (d1 + _diameter->getProperty(IDs[i])) * 0.5;
+	const double l = (l1 + _lambda->getProperty(IDs[i])) * 0.5;
+
+	if (isCaptured(p1, Sim->particles[IDs[i]]))
+	  {
+	    _batchD[i] = d;
+	    _batchOutIDs.push_back(IDs[i]);
+	    _batchOutIdx.push_back(i);
+	    _batchOutD.push_back(l * d);
+	  }
+	else
+	  _batchD[i] = l * d;
+      }
+
+    Sim->dynamics->SphereSphereInRoot(p1, IDs, &_batchD[0], &_batchDt[0], N);
+
+    for (size_t i(0); i < N; ++i)
+      {
+	const Particle& p2(Sim->particles[IDs[i]]);
+	if (_batchDt[i] != HUGE_VAL)
+	  events[i] = IntEvent(p1, p2, _batchDt[i], WELL_IN, *this);
+	else
+	  events[i] = IntEvent(p1, p2, HUGE_VAL, NONE, *this);
+      }
+
+    const size_t M(_batchOutIDs.size());
+    if (!M) return;
+
+    _batchOutDt.resize(M);
+    Sim->dynamics->SphereSphereOutRoot(p1, &_batchOutIDs[0], &_batchOutD[0], &_batchOutDt[0], M);
+
+    for (size_t j(0); j < M; ++j)
+      {
+	const size_t i(_batchOutIdx[j]);
+	const Particle& p2(Sim->particles[_batchOutIDs[j]]);
+
+	IntEvent retval(p1, p2, HUGE_VAL, NONE, *this);
+
+	if (_batchDt[i] != HUGE_VAL)
+	  retval = IntEvent(p1, p2, _batchDt[i], CORE, *this);
+
+	if (retval.getdt() > _batchOutDt[j])
+	  retval = IntEvent(p1, p2, _batchOutDt[j], WELL_OUT, *this);
+
+	events[i] = retval;
+      }
+  }
+
   void
   ISquareWell::runEvent(Particle& p1, Particle& p2, const IntEvent& iEvent) const
   {
@@ -195,8 +262,7 @@ namespace dynamo {
 	
 	  Sim->ptrScheduler->fullUpdate(p1, p2);
 	
-	  BOOST_FOREACH(shared_ptr<OutputPlugin> & Ptr, Sim->outputPlugins)
-	    Ptr->eventUpdate(iEvent, retVal);
+	  Sim->eventUpdate(iEvent, retVal);
 
 	  break;
 	}
@@ -210,8 +276,7 @@ namespace dynamo {
 	  Sim->ptrScheduler->fullUpdate(p1, p2);
 	  Sim->signalParticleUpdate(retVal);
 	
-	  BOOST_FOREACH(shared_ptr<OutputPlugin> & Ptr, Sim->outputPlugins)
-	    Ptr->eventUpdate(iEvent, retVal);
+	  Sim->eventUpdate(iEvent, retVal);
 
 
 	  break;
@@ -227,8 +292,7 @@ namespace dynamo {
 
 	  Sim->ptrScheduler->fullUpdate(p1, p2);
 	
-	  BOOST_FOREACH(shared_ptr<OutputPlugin> & Ptr, Sim->outputPlugins)
-	    Ptr->eventUpdate(iEvent, retVal);
+	  Sim->eventUpdate(iEvent, retVal);
 	  break;
 	}
       default:
@@ -306,11 +370,13 @@ namespace dynamo {
   { 
     //Once the capture maps are loaded just iterate through that determining energies
     double Energy = 0.0;
-    typedef std::pair<size_t, size_t> locpair;
 
-    BOOST_FOREACH(const locpair& IDs, captureMap)
-      Energy += 0.5 * (_wellDepth->getProperty(IDs.first)
-		       +_wellDepth->getProperty(IDs.second));
+    BOOST_FOREACH(const uint64_t& key, captureMap)
+      {
+	const cMapKey IDs(key);
+	Energy += 0.5 * (_wellDepth->getProperty(IDs.first())
+			 +_wellDepth->getProperty(IDs.second()));
+      }
   
     return -Energy; 
   }
@@ -20,6 +20,7 @@
 #include <dynamo/interactions/captures.hpp>
 #include <dynamo/interactions/glyphrepresentation.hpp>
 #include <dynamo/simulation.hpp>
+#include <vector>
 
 namespace dynamo {
   class ISquareWell: public ISingleCapture, public GlyphRepresentation
@@ -58,6 +59,8 @@ namespace dynamo {
     virtual void initialise(size_t);
 
     virtual IntEvent getEvent(const Particle&, const Particle&) const;
+
+    virtual void getEvents(const Particle&, const size_t*, IntEvent*, const size_t) const;
   
     virtual void runEvent(Particle&, Particle&, const IntEvent&) const;
   
@@ -77,5 +80,12 @@ namespace dynamo {
     shared_ptr<Property> _lambda;
     shared_ptr<Property> _wellDepth;
     shared_ptr<Property> _e;
+
+    mutable std::vector<double> _batchD;
+    mutable std::vector<double> _batchDt;
+    mutable std::vector<size_t> _batchOutIDs;
+    mutable std::vector<size_t> _batchOutIdx;
+    mutable std::vector<double> _batchOutD;
+    mutable std::vector<double> _batchOutDt;
   };
 }
@@ -125,7 +125,6 @@ namespace dynamo {
     IMultiCapture::initCaptureMap();
   
     dout << "Buckets in captureMap " << captureMap.bucket_count()
-	 << "\nMax bucket count " << captureMap.max_bucket_count()
 	 << "\nload Factor " << captureMap.load_factor()
 	 << "\nMax load Factor " << captureMap.max_load_factor() << std::endl;
   }
@@ -160,12 +159,12 @@ namespace dynamo {
     //Once the capture maps are loaded just iterate through that determining energies
     double Energy = 0.0;
 
-    typedef std::pair<const std::pair<size_t, size_t>, int> locpair;
+    typedef std::pair<uint64_t, int> locpair;
 
     BOOST_FOREACH(const locpair& IDs, captureMap)
       Energy += steps[IDs.second - 1].second 
-      * 0.5 * (_unitEnergy->getProperty(IDs.first.first)
-	       + _unitEnergy->getProperty(IDs.first.second));
+      * 0.5 * (_unitEnergy->getProperty(cMapKey(IDs.first).first())
+	       + _unitEnergy->getProperty(cMapKey(IDs.first).second()));
   
     return Energy; 
   }
@@ -268,8 +267,7 @@ namespace dynamo {
 
 	  Sim->ptrScheduler->fullUpdate(p1, p2);
 	
-	  BOOST_FOREACH(shared_ptr<OutputPlugin> & Ptr, Sim->outputPlugins)
-	    Ptr->eventUpdate(iEvent, retVal);
+	  Sim->eventUpdate(iEvent, retVal);
 	  break;
 	}
       case WELL_IN:
@@ -278,11 +276,7 @@ namespace dynamo {
 	
 	  if (capstat == captureMap.end())
 	    capstat = captureMap.insert
-	      (captureMapType::value_type
-	       ((p1.getID() < p2.getID())
-		? cMapKey(p1.getID(), p2.getID())
-		: cMapKey(p2.getID(), p1.getID()),
-		0)).first;
+	      (captureMapType::value_type(cMapKey(p1.getID(), p2.getID()).key, 0)).first;
 	
 	  double d = steps[capstat->second].first * _unitLength->getMaxValue();
 	  double d2 = d * d;
@@ -303,8 +297,7 @@ namespace dynamo {
 	
 	  Sim->ptrScheduler->fullUpdate(p1, p2);
 	
-	  BOOST_FOREACH(shared_ptr<OutputPlugin> & Ptr, Sim->outputPlugins)
-	    Ptr->eventUpdate(iEvent, retVal);
+	  Sim->eventUpdate(iEvent, retVal);
 	    
 	  break;
 	}
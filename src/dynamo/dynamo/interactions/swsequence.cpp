@@ -157,14 +157,16 @@ namespace dynamo {
   { 
     //Once the capture maps are loaded just iterate through that determining energies
     double Energy = 0.0;
-    typedef std::pair<size_t, size_t> locpair;
-
-    BOOST_FOREACH(const locpair& IDs, captureMap)
-      Energy += alphabet
-      [sequence[IDs.first % sequence.size()]]
-      [sequence[IDs.second % sequence.size()]] 
-      * 0.5 * (_unitEnergy->getProperty(IDs.first)
-	       +_unitEnergy->getProperty(IDs.second));
+
+    BOOST_FOREACH(const uint64_t& key, captureMap)
+      {
+	const cMapKey IDs(key);
+	Energy += alphabet
+	  [sequence[IDs.first() % sequence.size()]]
+	  [sequence[IDs.second() % sequence.size()]] 
+	  * 0.5 * (_unitEnergy->getProperty(IDs.first())
+		   +_unitEnergy->getProperty(IDs.second()));
+      }
   
     return -Energy; 
   }
@@ -289,8 +291,7 @@ namespace dynamo {
 	
 	  Sim->ptrScheduler->fullUpdate(p1, p2);
 	
-	  BOOST_FOREACH(shared_ptr<OutputPlugin> & Ptr, Sim->outputPlugins)
-	    Ptr->eventUpdate(iEvent, retVal);
+	  Sim->eventUpdate(iEvent, retVal);
 
 	  break;
 	}
@@ -310,8 +311,7 @@ namespace dynamo {
 
 	  Sim->ptrScheduler->fullUpdate(p1, p2);
 	
-	  BOOST_FOREACH(shared_ptr<OutputPlugin> & Ptr, Sim->outputPlugins)
-	    Ptr->eventUpdate(iEvent, retVal);
+	  Sim->eventUpdate(iEvent, retVal);
 
 	  break;
 	}
@@ -331,8 +331,7 @@ namespace dynamo {
 
 	  Sim->ptrScheduler->fullUpdate(p1, p2);
 	
-	  BOOST_FOREACH(shared_ptr<OutputPlugin> & Ptr, Sim->outputPlugins)
-	    Ptr->eventUpdate(iEvent, retVal);
+	  Sim->eventUpdate(iEvent, retVal);
 
 	  break;
 	}
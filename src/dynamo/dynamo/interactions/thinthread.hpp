@@ -34,6 +34,10 @@ namespace dynamo {
     virtual bool captureTest(const Particle&, const Particle&) const { return false; }
 
     virtual IntEvent getEvent(const Particle&, const Particle&) const;
+
+    //! The batched square well tests do not apply to the thread, so use the pairwise tests
+    virtual void getEvents(const Particle& p1, const size_t* IDs, IntEvent* events, const size_t N) const
+    { Interaction::getEvents(p1, IDs, events, N); }
   
     virtual void runEvent(Particle&, Particle&, const IntEvent&) const;
   
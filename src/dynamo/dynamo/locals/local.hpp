@@ -67,6 +67,8 @@ namespace dynamo {
 
     const std::string& getName() const { return localName; }
 
+    const shared_ptr<IDRange>& getRange() const { return range; }
+
     inline const size_t& getID() const { return ID; }
 
     virtual void checkOverlaps(const Particle&) const  {}
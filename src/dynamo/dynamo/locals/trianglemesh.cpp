@@ -17,48 +17,298 @@
 
 #include <dynamo/locals/trianglemesh.hpp>
 #include <dynamo/BC/BC.hpp>
+#include <dynamo/BC/None.hpp>
+#include <dynamo/BC/PBC.hpp>
 #include <dynamo/dynamics/dynamics.hpp>
 #include <dynamo/locals/localEvent.hpp>
 #include <dynamo/NparticleEventData.hpp>
 #include <dynamo/units/units.hpp>
 #include <dynamo/schedulers/scheduler.hpp>
 #include <dynamo/outputplugins/outputplugin.hpp>
-
+#include <boost/iterator/counting_iterator.hpp>
+#include <algorithm>
+#include <typeinfo>
+#include <cmath>
 
 namespace dynamo {
   LTriangleMesh::LTriangleMesh(const magnet::xml::Node& XML, dynamo::Simulation* tmp):
-    Local(tmp, "LocalWall")
+    Local(tmp, "LocalWall"),
+    _periodicGrid(false)
   { operator<<(XML); }
 
-  LocalEvent 
-  LTriangleMesh::getEvent(const Particle& part) const
+  void
+  LTriangleMesh::initialise(size_t nID)
   {
-#ifdef ISSS_DEBUG
-    if (!Sim->dynamics->isUpToDate(part))
-      M_throw() << "Particle is not up to date";
-#endif
+    Local::initialise(nID);
+    buildCellGrid();
+  }
+
+  void
+  LTriangleMesh::buildCellGrid()
+  {
+    _cells.clear();
+    
+    //Small meshes are quicker to test directly
+    if (_elements.size() < 32) return;
+
+    //The grid may only wrap around simple periodic boundary
+    //conditions, anything else (e.g., shearing or partially periodic
+    //boundaries) is handled by testing every triangle.
+    const BoundaryCondition& BC = *Sim->BCs;
+    if (typeid(BC) == typeid(BCPeriodic))
+      _periodicGrid = true;
+    else if (typeid(BC) == typeid(BCNone))
+      _periodicGrid = false;
+    else
+      return;
+
+    const double rmax = 0.5 * _diameter->getMaxValue();
+
+    //The bounding box of the mesh
+    Vector meshMin(_vertices[0]), meshMax(_vertices[0]);
+    BOOST_FOREACH(const Vector& vert, _vertices)
+      for (size_t iDim(0); iDim < NDIM; ++iDim)
+	{
+	  meshMin[iDim] = std::min(meshMin[iDim], vert[iDim]);
+	  meshMax[iDim] = std::max(meshMax[iDim], vert[iDim]);
+	}
+
+    //Without boundary conditions the grid covers the primary image
+    //and everywhere near the mesh. Particles outside of it are tested
+    //against every triangle.
+    Vector gridMin(-0.5 * Sim->primaryCellSize), gridMax(0.5 * Sim->primaryCellSize);
+    if (!_periodicGrid)
+      for (size_t iDim(0); iDim < NDIM; ++iDim)
+	{
+	  gridMin[iDim] = std::min(gridMin[iDim], meshMin[iDim] - rmax);
+	  gridMax[iDim] = std::max(gridMax[iDim], meshMax[iDim] + rmax);
+	}
+
+    const Vector gridSize = gridMax - gridMin;
 
-    size_t triangleid = 0; //The id of the triangle for which the event is for
-    double diam = 0.5 * _diameter->getProperty(part.getID());
+    //Aim for around one triangle per cell, but don't let the number
+    //of cells grow much larger than the number of triangles.
+    double width = std::max(std::pow(gridSize[0] * gridSize[1] * gridSize[2] 
+				     / _elements.size(), 1.0 / 3.0), rmax);
+    const size_t maxCells = 8 * _elements.size() + 1000;
+    for (;;)
+      {
+	size_t totalCells = 1;
+	for (size_t iDim(0); iDim < NDIM; ++iDim)
+	  {
+	    _cellCount[iDim] = std::max(size_t(1), size_t(_periodicGrid 
+							   ? std::floor(gridSize[iDim] / width)
+							   : std::ceil(gridSize[iDim] / width)));
+	    totalCells *= _cellCount[iDim];
+	  }
+
+	if (totalCells <= maxCells) break;
+	width *= 1.25;
+      }
 
-    std::pair<double, size_t> tmin(HUGE_VAL, 0); //Default to no collision
+    for (size_t iDim(0); iDim < NDIM; ++iDim)
+      {
+	//The 3x3x3 block of cells around a particle must fit within
+	//half of the primary image, else the minimum image convention
+	//would break the block crossing time.
+	if (_periodicGrid && (_cellCount[iDim] < 6))
+	  return;
+
+	_cellDimension[iDim] = _periodicGrid ? gridSize[iDim] / _cellCount[iDim] : width;
+      }
 
+    _gridOrigin = gridMin;
+    const size_t nCells = _cellCount[0] * _cellCount[1] * _cellCount[2];
+    std::vector<std::vector<size_t> > cells(nCells);
+
+    //Register each triangle in every cell which overlaps its bounding
+    //box, expanded by the largest particle radius.
     for (size_t id(0); id < _elements.size(); ++id)
       {
+	const Vector& A(_vertices[_elements[id].get<0>()]);
+	const Vector& B(_vertices[_elements[id].get<1>()]);
+	const Vector& C(_vertices[_elements[id].get<2>()]);
+
+	long low[3], high[3];
+	for (size_t iDim(0); iDim < NDIM; ++iDim)
+	  {
+	    const double min = std::min(A[iDim], std::min(B[iDim], C[iDim])) - rmax;
+	    const double max = std::max(A[iDim], std::max(B[iDim], C[iDim])) + rmax;
+	    low[iDim] = std::floor((min - _gridOrigin[iDim]) / _cellDimension[iDim]);
+	    high[iDim] = std::floor((max - _gridOrigin[iDim]) / _cellDimension[iDim]);
+
+	    if (_periodicGrid)
+	      {
+		if (high[iDim] - low[iDim] >= long(_cellCount[iDim]))
+		  { low[iDim] = 0; high[iDim] = _cellCount[iDim] - 1; }
+	      }
+	    else
+	      {
+		low[iDim] = std::max(low[iDim], 0l);
+		high[iDim] = std::min(high[iDim], long(_cellCount[iDim]) - 1);
+	      }
+	  }
+
+	for (long x(low[0]); x <= high[0]; ++x)
+	  for (long y(low[1]); y <= high[1]; ++y)
+	    for (long z(low[2]); z <= high[2]; ++z)
+	      {
+		long coords[3] = {x, y, z};
+		size_t cellID = 0;
+		for (size_t iDim(NDIM); iDim != 0; --iDim)
+		  {
+		    long c = coords[iDim - 1] % long(_cellCount[iDim - 1]);
+		    if (c < 0) c += _cellCount[iDim - 1];
+		    cellID = cellID * _cellCount[iDim - 1] + c;
+		  }
+		cells[cellID].push_back(id);
+	      }
+      }
+
+    //Each cell stores the triangles of the 3x3x3 block of cells
+    //around it, so a prediction walks a single sorted list
+    _cells.resize(nCells);
+    for (size_t cellID(0); cellID < nCells; ++cellID)
+      {
+	const long coords[3] = {long(cellID % _cellCount[0]), 
+				long((cellID / _cellCount[0]) % _cellCount[1]),
+				long(cellID / (_cellCount[0] * _cellCount[1]))};
+
+	std::vector<size_t>& block = _cells[cellID];
+	for (long x(coords[0] - 1); x <= coords[0] + 1; ++x)
+	  for (long y(coords[1] - 1); y <= coords[1] + 1; ++y)
+	    for (long z(coords[2] - 1); z <= coords[2] + 1; ++z)
+	      {
+		long nb[3] = {x, y, z};
+		size_t nbID = 0;
+		bool outside = false;
+		for (size_t iDim(NDIM); iDim != 0; --iDim)
+		  {
+		    long c = nb[iDim - 1];
+		    if (_periodicGrid)
+		      c = (c + _cellCount[iDim - 1]) % long(_cellCount[iDim - 1]);
+		    else if ((c < 0) || (c >= long(_cellCount[iDim - 1])))
+		      outside = true;
+		    nbID = nbID * _cellCount[iDim - 1] + c;
+		  }
+
+		if (!outside)
+		  block.insert(block.end(), cells[nbID].begin(), cells[nbID].end());
+	      }
+
+	std::sort(block.begin(), block.end());
+	block.erase(std::unique(block.begin(), block.end()), block.end());
+	//Trim the spare capacity
+	std::vector<size_t>(block).swap(block);
+      }
+
+    dout << "Triangle mesh \"" << localName << "\" split into " 
+	 << _cellCount[0] << "x" << _cellCount[1] << "x" << _cellCount[2]
+	 << " cells" << std::endl;
+  }
+
+  bool
+  LTriangleMesh::getCellCoords(const Particle& part, long coords[3]) const
+  {
+    Vector pos(part.getPosition());
+    if (_periodicGrid) Sim->BCs->applyBC(pos);
+
+    for (size_t iDim(0); iDim < NDIM; ++iDim)
+      {
+	coords[iDim] = std::floor((pos[iDim] - _gridOrigin[iDim]) / _cellDimension[iDim]);
+
+	if (_periodicGrid)
+	  {
+	    coords[iDim] %= long(_cellCount[iDim]);
+	    if (coords[iDim] < 0) coords[iDim] += _cellCount[iDim];
+	  }
+	else if ((coords[iDim] < 0) || (coords[iDim] >= long(_cellCount[iDim])))
+	  return false;
+      }
+
+    return true;
+  }
+
+  template<class Iterator>
+  void
+  LTriangleMesh::getTriangleEvent(const Particle& part, Iterator begin, Iterator end, TriangleEvent& tmin) const
+  {
+    const double diam = 0.5 * _diameter->getProperty(part.getID());
+
+    for (; begin != end; ++begin)
+      {
+	const size_t id = *begin;
 	std::pair<double, size_t> t = Sim->dynamics->getSphereTriangleEvent(part,
 				  _vertices[_elements[id].get<0>()],
 				  _vertices[_elements[id].get<1>()],
 				  _vertices[_elements[id].get<2>()],
 				  diam);
-	if (t < tmin) { tmin = t; triangleid = id; }
+	const TriangleEvent event(t.first, t.second, id);
+	if (event < tmin) tmin = event;
       }
+  }
 
-    return LocalEvent(part, tmin.first, WALL, *this, 8 * triangleid + tmin.second);
+  LocalEvent 
+  LTriangleMesh::getEvent(const Particle& part) const
+  {
+#ifdef ISSS_DEBUG
+    if (!Sim->dynamics->isUpToDate(part))
+      M_throw() << "Particle is not up to date";
+#endif
+
+    TriangleEvent tmin(HUGE_VAL, 0, 0); //Default to no collision
+
+    long coords[3];
+    if (_cells.empty() || !getCellCoords(part, coords))
+      {
+	getTriangleEvent(part, boost::counting_iterator<size_t>(0),
+			 boost::counting_iterator<size_t>(_elements.size()), tmin);
+	return LocalEvent(part, tmin.get<0>(), WALL, *this, 8 * tmin.get<2>() + tmin.get<1>());
+      }
+
+    Vector blockOrigin;
+    size_t cellID = 0;
+    for (size_t iDim(NDIM); iDim != 0; --iDim)
+      {
+	blockOrigin[iDim - 1] = _gridOrigin[iDim - 1] + (coords[iDim - 1] - 1) * _cellDimension[iDim - 1];
+	cellID = cellID * _cellCount[iDim - 1] + coords[iDim - 1];
+      }
+
+    getTriangleEvent(part, _cells[cellID].begin(), _cells[cellID].end(), tmin);
+
+    //Every triangle the particle can touch before it leaves the block
+    //has been tested.
+    const double blockdt = Sim->dynamics->getSquareCellCollision2(part, blockOrigin, 3 * _cellDimension)
+      - Sim->dynamics->getParticleDelay(part);
+
+    if ((tmin.get<0>() <= blockdt) || (blockdt == HUGE_VAL))
+      return LocalEvent(part, tmin.get<0>(), WALL, *this, 8 * tmin.get<2>() + tmin.get<1>());
+
+    return LocalEvent(part, blockdt, VIRTUAL, *this, 0);
   }
 
   void
   LTriangleMesh::runEvent(Particle& part, const LocalEvent& iEvent) const
   { 
+    if (iEvent.getType() == VIRTUAL)
+      {
+	//The particle has left the block of cells, the scheduler has
+	//already removed this event so just look further ahead. The
+	//next block is centred on the particle, so it must be up to
+	//date.
+	Sim->dynamics->updateParticle(part);
+
+	//The system has been streamed to this event, so the output
+	//plugins must still see it
+	NEventData EDat(ParticleEventData(part, *Sim->species[part], VIRTUAL));
+	Sim->signalParticleUpdate(EDat);
+	Sim->eventUpdate(iEvent, EDat);
+
+	Sim->ptrScheduler->pushEvent(part, getEvent(part));
+	Sim->ptrScheduler->sort(part);
+	return;
+      }
+
     ++Sim->eventCount;
   
     const size_t triangleID = iEvent.getExtraData() / Dynamics::T_COUNT;
@@ -145,8 +395,7 @@ namespace dynamo {
     //Now we're past the event update the scheduler and plugins
     Sim->ptrScheduler->fullUpdate(part);
   
-    BOOST_FOREACH(shared_ptr<OutputPlugin> & Ptr, Sim->outputPlugins)
-      Ptr->eventUpdate(iEvent, EDat);
+    Sim->eventUpdate(iEvent, EDat);
   }
 
   void 
@@ -20,6 +20,7 @@
 #include <dynamo/coilRenderObj.hpp>
 #include <dynamo/simulation.hpp>
 #include <boost/tuple/tuple.hpp>
+#include <boost/tuple/tuple_comparison.hpp>
 #include <vector>
 
 #ifdef DYNAMO_visualizer
@@ -27,6 +28,15 @@
 #endif
 
 namespace dynamo {
+  /*! \brief A Local wall made from a mesh of triangles.
+
+    Large meshes are split up by a uniform grid of cells (see \ref
+    buildCellGrid). Each event prediction only tests the triangles
+    which may be touched while the particle is within the 3x3x3 block
+    of cells around it. If none are hit before the particle leaves the
+    block, a VIRTUAL event is scheduled at the time it leaves, where
+    the prediction is repeated.
+   */
   class LTriangleMesh: public Local, public CoilRenderObj
   {
   public:
@@ -38,7 +48,8 @@ namespace dynamo {
       _e(Sim->_properties.getProperty
 	 (e, Property::Units::Dimensionless())),
       _diameter(Sim->_properties.getProperty
-		(d, Property::Units::Length()))
+		(d, Property::Units::Length())),
+      _periodicGrid(false)
     { localName = name; }
 
     virtual ~LTriangleMesh() {}
@@ -46,6 +57,8 @@ namespace dynamo {
     virtual LocalEvent getEvent(const Particle&) const;
 
     virtual void runEvent(Particle&, const LocalEvent&) const;
+
+    virtual void initialise(size_t);
   
     virtual void operator<<(const magnet::xml::Node&);
 
@@ -70,5 +83,44 @@ namespace dynamo {
 
     shared_ptr<Property> _e;
     shared_ptr<Property> _diameter;
+
+    /*! \brief Registers each triangle in the cells of a uniform grid
+        where a particle could touch it.
+
+      Each cell then lists the triangles of the 3x3x3 block of cells
+      around it, which are the triangles tested by \ref getEvent. The
+      grid is only built for large meshes in systems with no
+      boundary conditions or plain periodic boundary conditions,
+      otherwise every triangle is tested for every event.
+     */
+    void buildCellGrid();
+
+    //! The time, the part of the triangle (see Dynamics::TriangleContactType) and the triangle of an event.
+    typedef boost::tuples::tuple<double, size_t, size_t> TriangleEvent;
+
+    /*! \brief Test the passed triangles, keeping the earliest event
+        in tmin.
+
+      Simultaneous events are ordered by the triangle ID, so the
+      result does not depend on the order the triangles are tested
+      in.
+     */
+    template<class Iterator>
+    void getTriangleEvent(const Particle&, Iterator begin, Iterator end, TriangleEvent& tmin) const;
+
+    //! \brief Find the grid cell of a particle, returns false if it is outside the grid.
+    bool getCellCoords(const Particle&, long coords[3]) const;
+
+    /*! The triangles which may be touched by particles in the 3x3x3
+        block of grid cells around each cell (sorted by ID).
+     */
+    std::vector<std::vector<size_t> > _cells;
+    size_t _cellCount[3];
+    //! The lower corner of the grid.
+    Vector _gridOrigin;
+    //! The dimensions of a single grid cell.
+    Vector _cellDimension;
+    //! If the grid wraps around the periodic boundaries of the primary image.
+    bool _periodicGrid;
   };
 }
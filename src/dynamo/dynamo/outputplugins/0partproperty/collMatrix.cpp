@@ -24,11 +24,15 @@
 
 namespace dynamo {
   OPCollMatrix::OPCollMatrix(const dynamo::Simulation* tmp, const magnet::xml::Node&):
-    OutputPlugin(tmp,"CollisionMatrix"),
+    OPBatched(tmp,"CollisionMatrix"),
     totalCount(0)
   {
   }
 
+  void
+  OPCollMatrix::reorderParticles(const std::vector<size_t>& order)
+  { reorderParticleData(lastEvent, order); }
+
   void 
   OPCollMatrix::initialise()
   {
@@ -39,82 +43,31 @@ namespace dynamo {
   {}
 
   void 
-  OPCollMatrix::eventUpdate(const IntEvent& iEvent, const PairEventData&)
-  {
-    newEvent(iEvent.getParticle1ID(), iEvent.getType(), 
-	     getClassKey(iEvent));
-
-    newEvent(iEvent.getParticle2ID(), iEvent.getType(), 
-	     getClassKey(iEvent));
-  }
-
-
-  void 
-  OPCollMatrix::eventUpdate(const GlobalEvent& globEvent, const NEventData& SDat)
-  {
-    BOOST_FOREACH(const ParticleEventData& pData, SDat.L1partChanges)
-      newEvent(pData.getParticleID(), pData.getType(), 
-	       getClassKey(globEvent));  
-  
-    BOOST_FOREACH(const PairEventData& pData, SDat.L2partChanges)
-      {
-	newEvent(pData.particle1_.getParticleID(), 
-		 pData.getType(), getClassKey(globEvent));
-
-	newEvent(pData.particle2_.getParticleID(), 
-		 pData.getType(), getClassKey(globEvent));
-      }
-  }
-
-  void 
-  OPCollMatrix::eventUpdate(const LocalEvent& localEvent, const NEventData& SDat)
-  {
-    BOOST_FOREACH(const ParticleEventData& pData, SDat.L1partChanges)
-      newEvent(pData.getParticleID(), 
-	       pData.getType(), getClassKey(localEvent));  
-  
-    BOOST_FOREACH(const PairEventData& pData, SDat.L2partChanges)
-      {
-	newEvent(pData.particle1_.getParticleID(), 
-		 pData.getType(), getClassKey(localEvent));
-
-	newEvent(pData.particle2_.getParticleID(),
-		 pData.getType(), getClassKey(localEvent));
-      }
-  }
-
-  void 
-  OPCollMatrix::eventUpdate(const System& sysEvent, const NEventData& SDat, const double&)
+  OPCollMatrix::eventBatch(const EventRecord* begin, const EventRecord* end)
   {
-    BOOST_FOREACH(const ParticleEventData& pData, SDat.L1partChanges)
-      newEvent(pData.getParticleID(), pData.getType(), getClassKey(sysEvent));
-  
-    BOOST_FOREACH(const PairEventData& pData, SDat.L2partChanges)
-      {
-	newEvent(pData.particle1_.getParticleID(), 
-		 pData.getType(), getClassKey(sysEvent));
-
-	newEvent(pData.particle2_.getParticleID(), 
-		 pData.getType(), getClassKey(sysEvent));  
-      } 
+    for (const EventRecord* rec = begin; rec != end; ++rec)
+      //Interaction events are classified by the event type, the
+      //others by the type of the particle change
+      newEvent(rec->particleID, 
+	       (rec->source.second == INTERACTION) ? rec->eventType : rec->type, 
+	       rec->source, rec->systemTime);
   }
 
-
   void 
-  OPCollMatrix::newEvent(const size_t& part, const EEventType& etype, const classKey& ck)
+  OPCollMatrix::newEvent(const size_t& part, const EEventType& etype, const classKey& ck, const long double& time)
   {
     if (lastEvent[part].second.first.second != NONE)
       {
 	counterData& refCount = counters[counterKey(eventKey(ck,etype), lastEvent[part].second)];
       
-	refCount.totalTime += Sim->systemTime - lastEvent[part].first;
+	refCount.totalTime += time - lastEvent[part].first;
 	++(refCount.count);
 	++(totalCount);
       }
     else
       ++initialCounter[eventKey(ck,etype)];
 
-    lastEvent[part].first = Sim->systemTime;
+    lastEvent[part].first = time;
     lastEvent[part].second = eventKey(ck, etype);
   }
 
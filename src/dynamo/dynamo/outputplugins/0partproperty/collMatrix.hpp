@@ -16,7 +16,7 @@
 */
 
 #pragma once
-#include <dynamo/outputplugins/outputplugin.hpp>
+#include <dynamo/outputplugins/batched.hpp>
 #include <dynamo/eventtypes.hpp>
 #include <dynamo/outputplugins/eventtypetracking.hpp>
 #include <map>
@@ -27,7 +27,7 @@ namespace dynamo {
 
   using namespace EventTypeTracking;
 
-  class OPCollMatrix: public OutputPlugin
+  class OPCollMatrix: public OPBatched
   {
   private:
   
@@ -37,13 +37,9 @@ namespace dynamo {
 
     virtual void initialise();
 
-    virtual void eventUpdate(const IntEvent&, const PairEventData&);
+    virtual void reorderParticles(const std::vector<size_t>&);
 
-    virtual void eventUpdate(const GlobalEvent&, const NEventData&);
-
-    virtual void eventUpdate(const LocalEvent&, const NEventData&);
-
-    virtual void eventUpdate(const System&, const NEventData&, const double&);
+    virtual void eventBatch(const EventRecord*, const EventRecord*);
 
     void output(magnet::xml::XmlStream &);
 
@@ -51,7 +47,7 @@ namespace dynamo {
     virtual void changeSystem(OutputPlugin* plug) { std::swap(Sim, static_cast<OPCollMatrix*>(plug)->Sim); }
   
   protected:
-    void newEvent(const size_t&, const EEventType&, const classKey&);
+    void newEvent(const size_t&, const EEventType&, const classKey&, const long double&);
   
     struct counterData
     {
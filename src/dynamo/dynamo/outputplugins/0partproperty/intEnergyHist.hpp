@@ -30,6 +30,8 @@ namespace dynamo {
 
     virtual void initialise();
 
+    virtual void reorderParticles(const std::vector<size_t>&) {}
+
     virtual void eventUpdate(const IntEvent&, const PairEventData&);
 
     virtual void eventUpdate(const GlobalEvent&, const NEventData&);
@@ -21,6 +21,7 @@
 #include <magnet/memUsage.hpp>
 #include <magnet/xmlwriter.hpp>
 #include <dynamo/systems/tHalt.hpp>
+#include <dynamo/schedulers/scheduler.hpp>
 #include <boost/foreach.hpp>
 #include <sys/time.h>
 #include <ctime>
@@ -521,8 +522,11 @@ namespace dynamo {
 	<< magnet::xml::endtag("NegativeTimeEvents")
 	<< magnet::xml::tag("Memusage")
 	<< magnet::xml::attr("MaxKiloBytes") << magnet::process_mem_usage()
-	<< magnet::xml::endtag("Memusage")
-	<< magnet::xml::tag("ThermalConductivity")
+	<< magnet::xml::endtag("Memusage");
+
+    Sim->ptrScheduler->getSorter()->outputStatistics(XML);
+
+    XML << magnet::xml::tag("ThermalConductivity")
 	<< magnet::xml::tag("Correlator")
 	<< magnet::xml::chardata();
 
@@ -34,6 +34,8 @@ namespace dynamo {
     OPMisc(const dynamo::Simulation*, const magnet::xml::Node&);
   
     virtual void initialise();
+
+    virtual void reorderParticles(const std::vector<size_t>&) {}
   
     virtual void eventUpdate(const IntEvent&, const PairEventData&);
   
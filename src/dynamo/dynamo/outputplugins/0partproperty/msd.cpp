@@ -30,6 +30,10 @@ namespace dynamo {
   OPMSD::~OPMSD()
   {}
 
+  void
+  OPMSD::reorderParticles(const std::vector<size_t>& order)
+  { reorderParticleData(initPos, order); }
+
   void
   OPMSD::initialise()
   {
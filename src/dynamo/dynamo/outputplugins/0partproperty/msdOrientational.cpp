@@ -33,6 +33,10 @@ namespace dynamo {
   OPMSDOrientational::~OPMSDOrientational()
   {}
 
+  void
+  OPMSDOrientational::reorderParticles(const std::vector<size_t>& order)
+  { reorderParticleData(initialConfiguration, order); }
+
   void
   OPMSDOrientational::initialise()
   {
@@ -29,6 +29,8 @@ namespace dynamo {
 
     virtual void initialise();
 
+    virtual void reorderParticles(const std::vector<size_t>&);
+
     // All null events
     virtual void eventUpdate(const IntEvent&, const PairEventData&) {}
     virtual void eventUpdate(const GlobalEvent&, const NEventData&) {}
@@ -27,7 +27,7 @@
 
 namespace dynamo {
   OPMFT::OPMFT(const dynamo::Simulation* tmp, const magnet::xml::Node& XML):
-    OP1PP(tmp,"MeanFreeLength", 250),
+    OPBatched(tmp,"MeanFreeLength", 250),
     collisionHistoryLength(10),
     binwidth(0.01)
   {
@@ -51,6 +51,10 @@ namespace dynamo {
       }
   }
 
+  void
+  OPMFT::reorderParticles(const std::vector<size_t>& order)
+  { reorderParticleData(lastTime, order); }
+
   void
   OPMFT::initialise()
   {
@@ -66,19 +70,19 @@ namespace dynamo {
   }
 
   void 
-  OPMFT::A1ParticleChange(const ParticleEventData& PDat)
+  OPMFT::eventBatch(const EventRecord* begin, const EventRecord* end)
   {
-    //We ignore stuff that hasn't had an event yet
+    for (const EventRecord* rec = begin; rec != end; ++rec)
+      {
+	boost::circular_buffer<double>& times = lastTime[rec->particleID];
 
-    for (size_t collN = 0; collN < collisionHistoryLength; ++collN)
-      if (lastTime[PDat.getParticleID()][collN] != 0.0)
-	{
-	  data[PDat.getSpeciesID()][collN]
-	    .addVal(Sim->systemTime 
-		    - lastTime[PDat.getParticleID()][collN]);
-	}
-  
-    lastTime[PDat.getParticleID()].push_front(Sim->systemTime);
+	//We ignore stuff that hasn't had an event yet
+	for (size_t collN = 0; collN < collisionHistoryLength; ++collN)
+	  if (times[collN] != 0.0)
+	    data[rec->speciesID][collN].addVal(rec->systemTime - times[collN]);
+
+	times.push_front(rec->systemTime);
+      }
   }
 
   void
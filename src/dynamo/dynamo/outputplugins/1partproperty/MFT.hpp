@@ -16,20 +16,18 @@
 */
 
 #pragma once
-#include <dynamo/outputplugins/1partproperty/1partproperty.hpp>
+#include <dynamo/outputplugins/batched.hpp>
 #include <magnet/math/histogram.hpp>
 #include <boost/circular_buffer.hpp>
 #include <vector>
 
 namespace dynamo {
-  class OPMFT: public OP1PP
+  class OPMFT: public OPBatched
   {
   public:
     OPMFT(const dynamo::Simulation*, const magnet::xml::Node&);
 
-    void A1ParticleChange(const ParticleEventData&);
-
-    void stream(const double&) {}
+    virtual void eventBatch(const EventRecord*, const EventRecord*);
 
     void output(magnet::xml::XmlStream &); 
 
@@ -37,6 +35,8 @@ namespace dynamo {
 
     virtual void initialise();
 
+    virtual void reorderParticles(const std::vector<size_t>&);
+
     virtual void operator<<(const magnet::xml::Node&);
   
   protected:
@@ -42,6 +42,8 @@ namespace dynamo {
 
     virtual void initialise();
 
+    virtual void reorderParticles(const std::vector<size_t>&) {}
+
     void operator<<(const magnet::xml::Node&);
 
   protected:  
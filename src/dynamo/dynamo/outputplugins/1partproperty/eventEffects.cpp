@@ -25,7 +25,7 @@
 
 namespace dynamo {
   OPEventEffects::OPEventEffects(const dynamo::Simulation* tmp, const magnet::xml::Node&):
-    OutputPlugin(tmp,"EventEffects")
+    OPBatched(tmp,"EventEffects")
   {}
 
   void 
@@ -36,96 +36,12 @@ namespace dynamo {
   {}
 
   void 
-  OPEventEffects::eventUpdate(const IntEvent& iEvent, const PairEventData& Pdat)
+  OPEventEffects::eventBatch(const EventRecord* begin, const EventRecord* end)
   {
-    newEvent(iEvent.getType(),getClassKey(iEvent),
-	     Pdat.particle1_.getDeltaKE(),
-	     -Pdat.dP);
-
-    newEvent(iEvent.getType(),getClassKey(iEvent),
-	     Pdat.particle2_.getDeltaKE(),
-	     Pdat.dP);
-  }
-
-  void 
-  OPEventEffects::eventUpdate(const GlobalEvent& globEvent, const NEventData& SDat)
-  {
-    BOOST_FOREACH(const ParticleEventData& pData, SDat.L1partChanges)
-      {
-	const Particle& p1 = Sim->particles[pData.getParticleID()];
-	const Species& sp1 = *Sim->species[pData.getSpeciesID()];
-	
-	Vector dP = sp1.getMass(p1.getID()) * (p1.getVelocity() - pData.getOldVel());
-
-	newEvent(globEvent.getType(),getClassKey(globEvent),
-		 pData.getDeltaKE(), dP);
-      }
-  
-    BOOST_FOREACH(const PairEventData& pData, SDat.L2partChanges)
-      {
-	newEvent(globEvent.getType(),getClassKey(globEvent),
-		 pData.particle1_.getDeltaKE(),
-		 -pData.dP);
-      
-	newEvent(globEvent.getType(),getClassKey(globEvent),
-		 pData.particle2_.getDeltaKE(),
-		 pData.dP);
-      }
-  }
-
-  void 
-  OPEventEffects::eventUpdate(const LocalEvent& localEvent, const NEventData& SDat)
-  {
-    BOOST_FOREACH(const ParticleEventData& pData, SDat.L1partChanges)
-      {
-	const Particle& p1 = Sim->particles[pData.getParticleID()];
-	const Species& sp1 = *Sim->species[pData.getSpeciesID()];
-	
-	Vector dP = sp1.getMass(p1.getID()) * (p1.getVelocity() - pData.getOldVel());
-	
-	newEvent(localEvent.getType(),getClassKey(localEvent),
-		 pData.getDeltaKE(), dP);
-      }
-  
-    BOOST_FOREACH(const PairEventData& pData, SDat.L2partChanges)
-      {
-	newEvent(localEvent.getType(),getClassKey(localEvent),
-		 pData.particle1_.getDeltaKE(),
-		 -pData.dP);
-      
-	newEvent(localEvent.getType(),getClassKey(localEvent),
-		 pData.particle2_.getDeltaKE(),
-		 pData.dP);
-      }
+    for (const EventRecord* rec = begin; rec != end; ++rec)
+      newEvent(rec->eventType, rec->source, rec->deltaKE, rec->deltaP);
   }
 
-  void 
-  OPEventEffects::eventUpdate(const System& sysEvent, const NEventData& SDat, const double&)
-  {
-    BOOST_FOREACH(const ParticleEventData& pData, SDat.L1partChanges)
-      {
-	const Particle& p1 = Sim->particles[pData.getParticleID()];
-	const Species& sp1 = *Sim->species[pData.getSpeciesID()];
-	
-	Vector dP = sp1.getMass(p1.getID()) * (p1.getVelocity() - pData.getOldVel());
-	
-	newEvent(sysEvent.getType(),getClassKey(sysEvent),
-		 pData.getDeltaKE(), dP);
-      }
-  
-    BOOST_FOREACH(const PairEventData& pData, SDat.L2partChanges)
-      {
-	newEvent(sysEvent.getType(),getClassKey(sysEvent),
-		 pData.particle1_.getDeltaKE(),
-		 -pData.dP);
-      
-	newEvent(sysEvent.getType(),getClassKey(sysEvent),
-		 pData.particle2_.getDeltaKE(),
-		 pData.dP);
-      }
-  }
-
-
   void 
   OPEventEffects::newEvent(const EEventType& eType, const classKey& ck, 
 			   const double& deltaKE, const Vector & delP)
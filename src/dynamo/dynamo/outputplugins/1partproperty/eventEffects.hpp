@@ -16,7 +16,7 @@
 */
 
 #pragma once
-#include <dynamo/outputplugins/outputplugin.hpp>
+#include <dynamo/outputplugins/batched.hpp>
 #include <dynamo/eventtypes.hpp>
 #include <dynamo/outputplugins/eventtypetracking.hpp>
 #include <magnet/math/vector.hpp>
@@ -27,7 +27,7 @@ namespace dynamo {
 
   using namespace EventTypeTracking;
 
-  class OPEventEffects: public OutputPlugin
+  class OPEventEffects: public OPBatched
   {
   public:
     OPEventEffects(const dynamo::Simulation*, const magnet::xml::Node&);
@@ -35,13 +35,9 @@ namespace dynamo {
 
     virtual void initialise();
 
-    virtual void eventUpdate(const IntEvent&, const PairEventData&);
+    virtual void reorderParticles(const std::vector<size_t>&) {}
 
-    virtual void eventUpdate(const GlobalEvent&, const NEventData&);
-
-    virtual void eventUpdate(const LocalEvent&, const NEventData&);
-
-    virtual void eventUpdate(const System&, const NEventData&, const double&);
+    virtual void eventBatch(const EventRecord*, const EventRecord*);
 
     void output(magnet::xml::XmlStream &);
 
@@ -0,0 +1,145 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <dynamo/outputplugins/batched.hpp>
+#include <dynamo/include.hpp>
+#include <boost/foreach.hpp>
+
+namespace dynamo {
+  namespace {
+    void 
+    appendParticle(std::vector<EventRecord>& records, const Simulation& sim, 
+		   const EventTypeTracking::classKey& source, const EEventType eventType, double& dt,
+		   const ParticleEventData& pData, const EEventType type, const size_t partnerID, 
+		   const Vector& deltaP)
+    {
+      records.push_back(EventRecord());
+      EventRecord& rec = records.back();
+      rec.systemTime = sim.systemTime;
+      rec.dt = dt;
+      //Only the first record of an event carries the streaming time
+      dt = 0;
+      rec.source = source;
+      rec.eventType = eventType;
+      rec.type = type;
+      rec.particleID = pData.getParticleID();
+      rec.partnerID = partnerID;
+      rec.speciesID = pData.getSpeciesID();
+      rec.deltaKE = pData.getDeltaKE();
+      rec.deltaP = deltaP;
+      rec.oldVel = pData.getOldVel();
+      rec.newVel = sim.particles[rec.particleID].getVelocity();
+      rec.dynamic = sim.particles[rec.particleID].testState(Particle::DYNAMIC);
+    }
+
+    void 
+    appendPair(std::vector<EventRecord>& records, const Simulation& sim, 
+	       const EventTypeTracking::classKey& source, const EEventType eventType, double& dt,
+	       const PairEventData& pData)
+    {
+      appendParticle(records, sim, source, eventType, dt, pData.particle1_, pData.getType(), 
+		     pData.particle2_.getParticleID(), -pData.dP);
+      appendParticle(records, sim, source, eventType, dt, pData.particle2_, pData.getType(), 
+		     pData.particle1_.getParticleID(), pData.dP);
+    }
+
+    void 
+    appendN(std::vector<EventRecord>& records, const Simulation& sim, 
+	    const EventTypeTracking::classKey& source, const EEventType eventType, double dt,
+	    const NEventData& data)
+    {
+      BOOST_FOREACH(const ParticleEventData& pData, data.L1partChanges)
+	{
+	  const Particle& part = sim.particles[pData.getParticleID()];
+	  const Species& sp = *sim.species[pData.getSpeciesID()];
+	  appendParticle(records, sim, source, eventType, dt, pData, pData.getType(), sim.N,
+			 sp.getMass(part.getID()) * (part.getVelocity() - pData.getOldVel()));
+	}
+
+      BOOST_FOREACH(const PairEventData& pData, data.L2partChanges)
+	appendPair(records, sim, source, eventType, dt, pData);
+    }
+  }
+
+  void 
+  appendEventRecords(std::vector<EventRecord>& records, const Simulation& sim, 
+		     const IntEvent& event, const PairEventData& data)
+  {
+    double dt = event.getdt();
+    appendPair(records, sim, EventTypeTracking::getClassKey(event), event.getType(), dt, data);
+  }
+
+  void 
+  appendEventRecords(std::vector<EventRecord>& records, const Simulation& sim, 
+		     const GlobalEvent& event, const NEventData& data)
+  { appendN(records, sim, EventTypeTracking::getClassKey(event), event.getType(), event.getdt(), data); }
+
+  void 
+  appendEventRecords(std::vector<EventRecord>& records, const Simulation& sim, 
+		     const LocalEvent& event, const NEventData& data)
+  { appendN(records, sim, EventTypeTracking::getClassKey(event), event.getType(), event.getdt(), data); }
+
+  void 
+  appendEventRecords(std::vector<EventRecord>& records, const Simulation& sim, 
+		     const System& event, const NEventData& data, const double& dt)
+  { appendN(records, sim, EventTypeTracking::getClassKey(event), event.getType(), dt, data); }
+
+  OPBatched::OPBatched(const dynamo::Simulation* sim, const char* name, unsigned char order):
+    OutputPlugin(sim, name, order),
+    _pipelined(false)
+  {}
+
+  void 
+  OPBatched::eventUpdate(const IntEvent& event, const PairEventData& data)
+  {
+    if (_pipelined) return;
+    appendEventRecords(_records, *Sim, event, data);
+    processRecords();
+  }
+
+  void 
+  OPBatched::eventUpdate(const GlobalEvent& event, const NEventData& data)
+  {
+    if (_pipelined) return;
+    appendEventRecords(_records, *Sim, event, data);
+    processRecords();
+  }
+
+  void 
+  OPBatched::eventUpdate(const LocalEvent& event, const NEventData& data)
+  {
+    if (_pipelined) return;
+    appendEventRecords(_records, *Sim, event, data);
+    processRecords();
+  }
+
+  void 
+  OPBatched::eventUpdate(const System& event, const NEventData& data, const double& dt)
+  {
+    if (_pipelined) return;
+    appendEventRecords(_records, *Sim, event, data, dt);
+    processRecords();
+  }
+
+  void
+  OPBatched::processRecords()
+  {
+    if (!_records.empty())
+      eventBatch(&_records[0], &_records[0] + _records.size());
+    _records.clear();
+  }
+}
@@ -0,0 +1,114 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <dynamo/outputplugins/outputplugin.hpp>
+#include <dynamo/outputplugins/eventtypetracking.hpp>
+#include <dynamo/eventtypes.hpp>
+#include <magnet/math/vector.hpp>
+#include <vector>
+
+namespace dynamo {
+  /*! \brief A compact record of the change of a single particle in
+      an event.
+
+    Events which change several particles generate one record per
+    particle (in the order of their event data), and events which
+    change no particles generate no records. The records carry
+    everything the \ref OPBatched plugins need, so that they can be
+    processed after the Simulation has moved on (see \ref
+    OutputPipeline).
+   */
+  struct EventRecord
+  {
+    //! The system time of the event.
+    long double systemTime;
+    //! The time streamed before the event (only set in the event's first record).
+    double dt;
+    //! The source of the event (the Interaction, Global, Local or System and its ID).
+    EventTypeTracking::classKey source;
+    //! The type of the event.
+    EEventType eventType;
+    //! The type of the particle change (that of the pair for pair changes).
+    EEventType type;
+    size_t particleID;
+    //! The other particle of a pair change, or Sim->N.
+    size_t partnerID;
+    size_t speciesID;
+    double deltaKE;
+    //! The momentum change of the particle.
+    Vector deltaP;
+    Vector oldVel;
+    Vector newVel;
+    //! If the particle is \ref Particle::DYNAMIC after the change.
+    bool dynamic;
+  };
+
+  //! \brief Append the records of an Interaction event.
+  void appendEventRecords(std::vector<EventRecord>&, const Simulation&, const IntEvent&, const PairEventData&);
+
+  //! \brief Append the records of a Global event.
+  void appendEventRecords(std::vector<EventRecord>&, const Simulation&, const GlobalEvent&, const NEventData&);
+
+  //! \brief Append the records of a Local event.
+  void appendEventRecords(std::vector<EventRecord>&, const Simulation&, const LocalEvent&, const NEventData&);
+
+  //! \brief Append the records of a System event.
+  void appendEventRecords(std::vector<EventRecord>&, const Simulation&, const System&, const NEventData&, const double&);
+
+  /*! \brief A base class for OutputPlugin-s which only use the
+      particle changes of the events.
+
+    The events are converted into \ref EventRecord s and passed to
+    \ref eventBatch. Normally this happens immediately, one event at
+    a time. If the Simulation has an \ref OutputPipeline, the records
+    are instead batched and passed to \ref eventBatch from the
+    pipeline's thread, so the plugin must not read the state of the
+    Simulation while processing them (other than data which is fixed
+    during a run, such as the species). The pipeline is flushed before
+    any other member function of the plugin is called.
+   */
+  class OPBatched: public OutputPlugin
+  {
+  public:
+    OPBatched(const dynamo::Simulation*, const char*, unsigned char order = 100);
+
+    virtual void eventUpdate(const IntEvent&, const PairEventData&);
+
+    virtual void eventUpdate(const GlobalEvent&, const NEventData&);
+
+    virtual void eventUpdate(const LocalEvent&, const NEventData&);
+
+    virtual void eventUpdate(const System&, const NEventData&, const double&);
+
+    //! \brief Process a batch of records, in event order.
+    virtual void eventBatch(const EventRecord* begin, const EventRecord* end) = 0;
+
+    /*! \brief Set if the records are delivered by an \ref
+        OutputPipeline, in which case the eventUpdate functions
+        ignore the events.
+     */
+    void setPipelined(bool val) { _pipelined = val; }
+
+  private:
+    //! Process the records of a single event.
+    void processRecords();
+
+    std::vector<EventRecord> _records;
+    bool _pipelined;
+  };
+}
@@ -0,0 +1,349 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <dynamo/outputplugins/general/eventTrace.hpp>
+#include <dynamo/include.hpp>
+#include <dynamo/fileCompression.hpp>
+#include <magnet/stream/binary.hpp>
+#include <magnet/xmlwriter.hpp>
+#include <magnet/xmlreader.hpp>
+#include <boost/iostreams/device/file.hpp>
+#include <boost/filesystem.hpp>
+#include <cstring>
+
+namespace dynamo {
+  namespace {
+    //! The first bytes of an event trace file.
+    const char traceMagic[8] = {'D', 'y', 'n', 'a', 'm', 'O', 'E', 'T'};
+
+    //! The event trace file layout version.
+    const uint32_t traceVersion(1);
+
+    //! Written in the byte order of the machine, to detect traces
+    //! written on a machine of different endianness.
+    const uint32_t traceByteOrder(0x01020304);
+
+    //! The particle ID of a record which only advances the time.
+    const uint32_t noParticle(0xFFFFFFFF);
+
+    //! The particle state flag set in a record.
+    const uint8_t dynamicFlag(0x01);
+
+    /*! The bytes in a record: the time step, particle ID, partner
+        offset, source ID, the source class, event type, change type
+        and flags, the kinetic energy change and the velocity.
+     */
+    const size_t recordSize(8 + 4 + 4 + 4 + 4 + 8 + 8 * NDIM);
+
+    //! The number of records in a full block.
+    const size_t blockSize(4096);
+
+    template<class T>
+    inline void put(char*& ptr, const T& val)
+    {
+      std::memcpy(ptr, &val, sizeof(T));
+      ptr += sizeof(T);
+    }
+
+    template<class T>
+    inline void get(const char*& ptr, T& val)
+    {
+      std::memcpy(&val, ptr, sizeof(T));
+      ptr += sizeof(T);
+    }
+  }
+
+  OPEventTrace::OPEventTrace(const dynamo::Simulation* tmp, const magnet::xml::Node& XML):
+    OPBatched(tmp, "EventTrace"),
+    _fileName("eventtrace.gz"),
+    _blockRecords(0),
+    _recordCount(0),
+    _lastTime(0)
+  {
+    if (XML.hasAttribute("FileName"))
+      _fileName = XML.getAttribute("FileName").getValue();
+  }
+
+  void
+  OPEventTrace::initialise()
+  {
+    if (Sim->dynamics->hasOrientationData())
+      M_throw() << "The EventTrace plugin cannot trace the orientations of the particles";
+
+    //The partner IDs are stored as 32 bit offsets
+    if (Sim->N >= 0x7FFFFFFF)
+      M_throw() << "Too many particles to write an event trace";
+
+    namespace io = boost::iostreams;
+    _file.reset(new io::filtering_ostream);
+    //The records may be written from the pipeline thread, so the
+    //compression cannot use the thread pool of the Simulation
+    pushCompressor(*_file, _fileName);
+    _file->push(io::file_sink(_fileName, std::ios_base::out | std::ios_base::binary));
+
+    magnet::stream::writeBinary(*_file, traceMagic, 8);
+    magnet::stream::writeBinary(*_file, traceVersion);
+    magnet::stream::writeBinary(*_file, traceByteOrder);
+    magnet::stream::writeBinary(*_file, uint32_t(recordSize));
+    magnet::stream::writeBinary(*_file, uint64_t(Sim->N));
+
+    _block.resize(blockSize * recordSize);
+    _blockRecords = 0;
+    _recordCount = 0;
+    _lastTime = Sim->systemTime;
+  }
+
+  void
+  OPEventTrace::reorderParticles(const std::vector<size_t>&)
+  { M_throw() << "The particles cannot be renumbered while writing an event trace"; }
+
+  OPEventTrace::~OPEventTrace()
+  {
+    if (!_file) return;
+
+    //Terminate the trace, the destructor must not throw
+    try {
+      writeBlock();
+      magnet::stream::writeBinary(*_file, uint32_t(0));
+      _file->reset();
+    } catch (std::exception& e) {
+      derr << "Failed to complete the event trace " << _fileName << "\n" << e.what() << std::endl;
+    }
+  }
+
+  void
+  OPEventTrace::eventBatch(const EventRecord* begin, const EventRecord* end)
+  {
+    for (const EventRecord* rec = begin; rec != end; ++rec)
+      writeRecord(rec->systemTime, rec);
+  }
+
+  void
+  OPEventTrace::writeRecord(const long double time, const EventRecord* rec)
+  {
+    //The time step is taken from the time the reader will have
+    //reached, so the round-off does not accumulate
+    const double dt = time - _lastTime;
+    _lastTime += dt;
+
+    char* ptr = &_block[_blockRecords * recordSize];
+    put(ptr, dt);
+    if (rec)
+      {
+	put(ptr, uint32_t(rec->particleID));
+	put(ptr, int32_t((rec->partnerID == Sim->N) ? 0 
+			 : int64_t(rec->partnerID) - int64_t(rec->particleID)));
+	put(ptr, uint32_t(rec->source.first));
+	put(ptr, uint8_t(rec->source.second));
+	put(ptr, uint8_t(rec->eventType));
+	put(ptr, uint8_t(rec->type));
+	put(ptr, uint8_t(rec->dynamic ? dynamicFlag : 0));
+	put(ptr, rec->deltaKE);
+	for (size_t iDim(0); iDim < NDIM; ++iDim)
+	  put(ptr, rec->newVel[iDim]);
+      }
+    else
+      {
+	put(ptr, noParticle);
+	std::memset(ptr, 0, recordSize - 12);
+      }
+
+    ++_recordCount;
+    if (++_blockRecords == blockSize)
+      writeBlock();
+  }
+
+  void
+  OPEventTrace::writeBlock()
+  {
+    if (!_blockRecords) return;
+    magnet::stream::writeBinary(*_file, uint32_t(_blockRecords));
+    magnet::stream::writeBinary(*_file, &_block[0], _blockRecords * recordSize);
+    _blockRecords = 0;
+  }
+
+  void
+  OPEventTrace::output(magnet::xml::XmlStream& XML)
+  {
+    //The output is also written during the run (e.g., by snapshots),
+    //so the trace is only brought up to the current time and flushed
+    writeRecord(Sim->systemTime, NULL);
+    writeBlock();
+    _file->flush();
+
+    XML << magnet::xml::tag("EventTrace")
+	<< magnet::xml::attr("FileName") << _fileName
+	<< magnet::xml::attr("Records") << _recordCount
+	<< magnet::xml::endtag("EventTrace");
+  }
+
+  EventTraceReader::EventTraceReader(dynamo::Simulation* tmp, const std::string& fileName):
+    SimBase(tmp, "EventTraceReader"),
+    _blockRecords(0),
+    _nextRecord(0),
+    _finished(false),
+    _pairOpen(false),
+    _lastID(0),
+    _lastPartnerID(0),
+    _lastDeltaP(0, 0, 0)
+  {
+    namespace io = boost::iostreams;
+
+    if (!boost::filesystem::exists(fileName))
+      M_throw() << "Could not find the event trace named " << fileName;
+
+    if (hasExtension(fileName, ".bz2"))
+      _file.push(io::bzip2_decompressor());
+    else if (hasExtension(fileName, ".gz"))
+      _file.push(io::gzip_decompressor());
+    _file.push(io::file_source(fileName, std::ios_base::in | std::ios_base::binary));
+
+    char magic[8];
+    uint32_t version, byteOrder, size;
+    uint64_t N;
+    magnet::stream::readBinary(_file, magic, 8);
+    if (!std::equal(magic, magic + 8, traceMagic))
+      M_throw() << fileName << " is not an event trace file";
+
+    magnet::stream::readBinary(_file, version);
+    magnet::stream::readBinary(_file, byteOrder);
+    magnet::stream::readBinary(_file, size);
+    magnet::stream::readBinary(_file, N);
+
+    if (version != traceVersion)
+      M_throw() << "Unsupported event trace version " << version
+		<< ", the current version is " << traceVersion;
+
+    if (byteOrder != traceByteOrder)
+      M_throw() << "The event trace was written on a machine with a different byte order";
+
+    if (size != recordSize)
+      M_throw() << "The event trace records are " << size << " bytes, expected " << recordSize
+		<< "\nWas it written by a build with a different number of dimensions?";
+
+    if (N != Sim->N)
+      M_throw() << "The event trace is for " << N << " particles, but the configuration has " 
+		<< Sim->N;
+  }
+
+  bool
+  EventTraceReader::readBlock()
+  {
+    if (_finished) return false;
+
+    uint32_t count;
+    if (!_file.read(reinterpret_cast<char*>(&count), sizeof(count)))
+      M_throw() << "The event trace ends without being completed, did the run which wrote it finish?";
+
+    if (!count)
+      {
+	_finished = true;
+	return false;
+      }
+
+    _block.resize(size_t(count) * recordSize);
+    if (!_file.read(&_block[0], _block.size()))
+      M_throw() << "The event trace is truncated, did the run which wrote it finish?";
+    _blockRecords = count;
+    _nextRecord = 0;
+    return true;
+  }
+
+  bool
+  EventTraceReader::read(std::vector<EventRecord>& records, const size_t max)
+  {
+    records.clear();
+
+    while (records.size() < max)
+      {
+	if ((_nextRecord == _blockRecords) && !readBlock())
+	  break;
+
+	const char* ptr = &_block[_nextRecord * recordSize];
+	++_nextRecord;
+
+	double dt;
+	uint32_t ID, sourceID;
+	int32_t partnerOffset;
+	uint8_t sourceClass, eventType, type, flags;
+	get(ptr, dt);
+	get(ptr, ID);
+	get(ptr, partnerOffset);
+	get(ptr, sourceID);
+	get(ptr, sourceClass);
+	get(ptr, eventType);
+	get(ptr, type);
+	get(ptr, flags);
+
+	if (dt != 0)
+	  {
+	    Sim->stream(dt);
+	    Sim->systemTime += dt;
+	  }
+
+	if (ID == noParticle) continue;
+
+	if (ID >= Sim->N)
+	  M_throw() << "Corrupt event trace, particle ID " << ID << " is out of range";
+
+	Particle& part = Sim->particles[ID];
+	const Species& species = *Sim->species[part];
+	Sim->dynamics->updateParticle(part);
+
+	records.push_back(EventRecord());
+	EventRecord& rec = records.back();
+	rec.systemTime = Sim->systemTime;
+	rec.dt = dt;
+	rec.source = EventTypeTracking::classKey(sourceID, EEventType(sourceClass));
+	rec.eventType = EEventType(eventType);
+	rec.type = EEventType(type);
+	rec.particleID = ID;
+	rec.partnerID = partnerOffset ? size_t(int64_t(ID) + partnerOffset) : Sim->N;
+	rec.speciesID = species.getID();
+	get(ptr, rec.deltaKE);
+	for (size_t iDim(0); iDim < NDIM; ++iDim)
+	  get(ptr, rec.newVel[iDim]);
+	rec.dynamic = flags & dynamicFlag;
+
+	rec.oldVel = part.getVelocity();
+	part.getVelocity() = rec.newVel;
+
+	//The two records of a pair change are consecutive, and the
+	//momentum is exchanged exactly between them
+	if (_pairOpen && (dt == 0) && (rec.partnerID == _lastID) && (_lastPartnerID == ID))
+	  {
+	    rec.deltaP = -_lastDeltaP;
+	    _pairOpen = false;
+	  }
+	else
+	  {
+	    rec.deltaP = species.getMass(ID) * (rec.newVel - rec.oldVel);
+	    _pairOpen = (rec.partnerID != Sim->N);
+	    _lastID = ID;
+	    _lastPartnerID = rec.partnerID;
+	    _lastDeltaP = rec.deltaP;
+	  }
+
+	if (rec.dynamic)
+	  part.setState(Particle::DYNAMIC);
+	else
+	  part.clearState(Particle::DYNAMIC);
+      }
+
+    return !records.empty();
+  }
+}
@@ -0,0 +1,122 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <dynamo/outputplugins/batched.hpp>
+#include <dynamo/base.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <string>
+#include <vector>
+
+namespace dynamo {
+  /*! \brief Writes a compact binary trace of every particle change,
+      which can be replayed later by the dynatrace program.
+
+    Each \ref EventRecord is stored as a fixed-width record holding
+    the time since the previous record, the particle ID, the partner
+    ID (as an offset from the particle ID), the event source and
+    types, the kinetic energy change and the new velocity of the
+    particle. Everything else in the record (the old velocity, the
+    momentum change and the species) is recovered by replaying the
+    trace against the initial configuration, see \ref
+    EventTraceReader.
+
+    The records are written in blocks, and the file is compressed
+    according to its extension (see \ref pushCompressor), "FileName"
+    defaults to "eventtrace.gz". The trace is completed when the
+    plugin is destroyed, at the end of the run.
+
+    Only the particle changes are traced, so the plugin refuses to
+    run if the particles have orientations or are renumbered during
+    the run.
+   */
+  class OPEventTrace: public OPBatched
+  {
+  public:
+    OPEventTrace(const dynamo::Simulation*, const magnet::xml::Node&);
+
+    //! \brief Writes the end of the trace.
+    ~OPEventTrace();
+
+    virtual void initialise();
+
+    virtual void eventBatch(const EventRecord*, const EventRecord*);
+
+    virtual void output(magnet::xml::XmlStream&);
+
+    virtual void reorderParticles(const std::vector<size_t>&);
+
+  private:
+    //! Append a record to the block, writing the block if it is full.
+    void writeRecord(const long double time, const EventRecord*);
+
+    //! Write out the records of the current block.
+    void writeBlock();
+
+    std::string _fileName;
+    shared_ptr<boost::iostreams::filtering_ostream> _file;
+    std::vector<char> _block;
+    size_t _blockRecords;
+    size_t _recordCount;
+    //! The system time of the last record, as it will be replayed.
+    long double _lastTime;
+  };
+
+  /*! \brief Reads an event trace written by \ref OPEventTrace and
+      replays it on a Simulation.
+
+    The Simulation must be loaded from the configuration the traced
+    run started from and initialised. As the records are read, the
+    particles are streamed to the time of each record and given their
+    new velocities, so the Simulation is in the state of the traced
+    run at the last record read (the positions and times agree to
+    within the round-off error of streaming).
+
+    The records read are complete \ref EventRecord s, except that
+    their dt is the time since the previous record. The momentum
+    change of a particle is recovered from its change of velocity,
+    and the particles of a pair change are given equal and opposite
+    changes.
+   */
+  class EventTraceReader: public dynamo::SimBase
+  {
+  public:
+    EventTraceReader(dynamo::Simulation*, const std::string& fileName);
+
+    /*! \brief Read and replay up to max records.
+
+      \return False if the end of the trace was reached before any
+      record was read.
+     */
+    bool read(std::vector<EventRecord>& records, const size_t max);
+
+  private:
+    //! Read the next block of records from the file.
+    bool readBlock();
+
+    boost::iostreams::filtering_istream _file;
+    std::vector<char> _block;
+    size_t _blockRecords;
+    size_t _nextRecord;
+    bool _finished;
+    //! Set when the last record read was the first of a pair change.
+    bool _pairOpen;
+    //! The last record read (valid if _pairOpen is set).
+    size_t _lastID, _lastPartnerID;
+    Vector _lastDeltaP;
+  };
+}
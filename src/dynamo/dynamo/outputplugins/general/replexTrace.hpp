@@ -37,6 +37,8 @@ namespace dynamo {
 
     virtual void initialise() { addPoint(); }
 
+    virtual void reorderParticles(const std::vector<size_t>&) {}
+
     virtual void output(magnet::xml::XmlStream&);
 
     virtual void changeSystem(OutputPlugin*); 
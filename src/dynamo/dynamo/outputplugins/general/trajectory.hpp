@@ -41,6 +41,8 @@ namespace dynamo {
 
     virtual void initialise();
 
+    virtual void reorderParticles(const std::vector<size_t>&) {}
+
     virtual void output(magnet::xml::XmlStream&);
 
   private:
@@ -141,6 +141,8 @@ namespace dynamo {
       return testGeneratePlugin<OPChainBondAngles>(Sim, XML);
     else if (!Name.compare("Trajectory"))
       return testGeneratePlugin<OPTrajectory>(Sim, XML);
+    else if (!Name.compare("EventTrace"))
+      return testGeneratePlugin<OPEventTrace>(Sim, XML);
     else if (!Name.compare("ChainBondLength"))
       return testGeneratePlugin<OPChainBondLength>(Sim, XML);
     else if (!Name.compare("MFT"))
@@ -65,6 +65,13 @@ namespace dynamo {
     { M_throw() << "This plugin hasn't been prepared for changes of system\n Plugin " <<  name; }
   
     virtual void temperatureRescale(const double&) {}
+
+    /*! \brief Called when the particle IDs are renumbered (see \ref
+        Simulation::reorderParticles). The new particle i was
+        previously the particle order[i].
+     */
+    virtual void reorderParticles(const std::vector<size_t>& order)
+    { M_throw() << "This plugin hasn't been prepared for the renumbering of particles\n Plugin " << name; }
   
   protected:
     std::ostream& I_Pcout() const;
@@ -0,0 +1,94 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <dynamo/outputplugins/pipeline.hpp>
+#include <dynamo/simulation.hpp>
+#include <boost/foreach.hpp>
+#include <iostream>
+
+namespace dynamo {
+  OutputPipeline::OutputPipeline(const dynamo::Simulation* sim, size_t batchSize, size_t maxQueued):
+    SimBase_const(sim, "OutputPipeline"),
+    magnet::thread::WorkerQueue<std::vector<EventRecord> >(maxQueued, "An output plugin failed on the analysis thread"),
+    _batchSize(std::max(batchSize, size_t(1)))
+  { start(); }
+
+  OutputPipeline::~OutputPipeline()
+  {
+    std::string error;
+    try {
+      if (!_staging.empty())
+	push(_staging);
+    } catch (std::exception& e) {
+      error = e.what();
+    }
+
+    error += stop();
+    if (!error.empty())
+      std::cerr << "OutputPipeline: Some events were not processed\n" << error << std::endl;
+  }
+
+  void
+  OutputPipeline::initialise()
+  {
+    flush();
+
+    BOOST_FOREACH(OPBatched* plugin, _plugins)
+      plugin->setPipelined(false);
+    _plugins.clear();
+
+    BOOST_FOREACH(const shared_ptr<OutputPlugin>& ptr, Sim->outputPlugins)
+      if (OPBatched* plugin = dynamic_cast<OPBatched*>(ptr.get()))
+	{
+	  plugin->setPipelined(true);
+	  _plugins.push_back(plugin);
+	}
+
+    _staging.reserve(_batchSize);
+
+    dout << "Processing " << _plugins.size() << " output plugins on the analysis thread, "
+	 << _batchSize << " records at a time" << std::endl;
+  }
+
+  void 
+  OutputPipeline::submit()
+  {
+    push(_staging);
+
+    //Continue staging into a recycled buffer
+    _staging.clear();
+    _staging.reserve(_batchSize);
+  }
+
+  void 
+  OutputPipeline::flush()
+  {
+    if (!_staging.empty())
+      submit();
+
+    wait();
+  }
+
+  void 
+  OutputPipeline::process(std::vector<EventRecord>& batch)
+  {
+    if (batch.empty()) return;
+
+    BOOST_FOREACH(OPBatched* plugin, _plugins)
+      plugin->eventBatch(&batch[0], &batch[0] + batch.size());
+  }
+}
@@ -0,0 +1,109 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <dynamo/outputplugins/batched.hpp>
+#include <dynamo/base.hpp>
+#include <magnet/thread/workerQueue.hpp>
+#include <vector>
+
+namespace dynamo {
+  /*! \brief Runs the \ref OPBatched plugins of a Simulation on a
+      separate analysis thread.
+
+    The event loop appends the \ref EventRecord s of each event to a
+    staging buffer, which is queued for the analysis thread once it
+    holds a batch of records. The buffers circulate between the two
+    threads (a ring of buffers), so no memory is allocated once the
+    pipeline is running. The number of queued buffers is bounded, so
+    if the plugins cannot keep up the event loop blocks until a
+    buffer is free.
+
+    The plugins only see the records, so adding them does not slow
+    the event loop beyond the cost of writing the records. Before the
+    plugins are used in any other way (their output, or when the
+    particles are renumbered), the pipeline must be flushed.
+   */
+  class OutputPipeline: public dynamo::SimBase_const, 
+			private magnet::thread::WorkerQueue<std::vector<EventRecord> >
+  {
+  public:
+    /*! \brief Constructor, this starts the analysis thread.
+
+      \param batchSize The number of records passed to the plugins
+      at once.
+      \param maxQueued The largest number of batches held by the
+      pipeline (including the one being processed).
+     */
+    OutputPipeline(const dynamo::Simulation*, size_t batchSize = 4096, size_t maxQueued = 4);
+
+    //! \brief Processes any queued records before stopping the thread.
+    ~OutputPipeline();
+
+    /*! \brief Take over the event processing of the \ref OPBatched
+        plugins of the Simulation.
+     */
+    void initialise();
+
+    void eventUpdate(const IntEvent& event, const PairEventData& data)
+    { 
+      if (_plugins.empty()) return;
+      appendEventRecords(_staging, *Sim, event, data); 
+      if (_staging.size() >= _batchSize) submit();
+    }
+
+    void eventUpdate(const GlobalEvent& event, const NEventData& data)
+    { 
+      if (_plugins.empty()) return;
+      appendEventRecords(_staging, *Sim, event, data); 
+      if (_staging.size() >= _batchSize) submit();
+    }
+
+    void eventUpdate(const LocalEvent& event, const NEventData& data)
+    { 
+      if (_plugins.empty()) return;
+      appendEventRecords(_staging, *Sim, event, data); 
+      if (_staging.size() >= _batchSize) submit();
+    }
+
+    void eventUpdate(const System& event, const NEventData& data, const double& dt)
+    { 
+      if (_plugins.empty()) return;
+      appendEventRecords(_staging, *Sim, event, data, dt); 
+      if (_staging.size() >= _batchSize) submit();
+    }
+
+    /*! \brief Block until the plugins have processed every record.
+
+      If a plugin threw an exception while processing a batch, it is
+      rethrown from here (or from the next submitted batch).
+     */
+    void flush();
+
+  private:
+    //! Queue the staging buffer for the analysis thread.
+    void submit();
+
+    virtual void process(std::vector<EventRecord>& batch);
+
+    std::vector<OPBatched*> _plugins;
+    size_t _batchSize;
+
+    //! The buffer being filled by the event loop.
+    std::vector<EventRecord> _staging;
+  };
+}
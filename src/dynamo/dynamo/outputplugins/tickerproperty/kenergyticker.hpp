@@ -33,6 +33,8 @@ namespace dynamo {
 
     virtual void initialise();
 
+    virtual void reorderParticles(const std::vector<size_t>&) {}
+
     virtual void stream(double) {}
 
     virtual void ticker();
@@ -30,9 +30,7 @@ namespace dynamo {
 							     const magnet::xml::Node& XML):
     OPTicker(tmp,"MSDOrientationalCorrelator"),
     length(50),
-    currCorrLength(0),
-    ticksTaken(0),
-    notReady(true)
+    scaling(2)
   {
     operator<<(XML);
   }
@@ -43,6 +41,9 @@ namespace dynamo {
     try {
       if (XML.hasAttribute("Length"))
 	length = XML.getAttribute("Length").as<size_t>();
+
+      if (XML.hasAttribute("Scaling"))
+	scaling = XML.getAttribute("Scaling").as<size_t>();
     }
     catch (boost::bad_lexical_cast &)
       {
@@ -50,77 +51,113 @@ namespace dynamo {
       }
   }
 
+  void
+  OPMSDOrientationalCorrelator::reorderParticles(const std::vector<size_t>& order)
+  {
+    for (size_t level(0); level < historicalData.levels(); ++level)
+      for (size_t step(0); step < historicalData.size(level); ++step)
+	reorderParticleData(historicalData.get(level, step), order);
+  }
+
   void
   OPMSDOrientationalCorrelator::initialise()
   {
-    dout << "The length of the MSD orientational correlator is " << length << std::endl;
+    dout << "The length of the MSD orientational correlator is " << length 
+	 << ", with a scaling of " << scaling << std::endl;
 
-    historicalData.resize(Sim->N, boost::circular_buffer<RUpair>(length));
+    try {
+      historicalData.resize(length, scaling);
+    }
+    catch (std::exception& excep)
+      {
+	M_throw() << "Bad Length or Scaling for the MSDOrientationalCorrelator\n" << excep.what();
+      }
 
-    stepped_data_parallel.resize(length, double(0.0));
-    stepped_data_perpendicular.resize(length, double(0.0));
-    stepped_data_rotational_legendre1.resize(length, double(0.0));
-    stepped_data_rotational_legendre2.resize(length, double(0.0));
+    stepped_data_parallel.clear();
+    stepped_data_perpendicular.clear();
+    stepped_data_rotational_legendre1.clear();
+    stepped_data_rotational_legendre2.clear();
+    sampleCount.clear();
 
-    // The Legendre polynomials are equal to 1 at t = 0
-    stepped_data_rotational_legendre1[0] = 1.0;
-    stepped_data_rotational_legendre2[0] = 1.0;
+    takeSample();
+  }
 
-    currCorrLength = 1.0;
+  void
+  OPMSDOrientationalCorrelator::ticker()
+  {
+    takeSample();
+    accPass();
+  }
 
-    const std::vector<Dynamics::rotData>& initial_rdat(Sim->dynamics->getCompleteRotData());
+  void
+  OPMSDOrientationalCorrelator::takeSample()
+  {
+    const std::vector<Dynamics::rotData>& current_rdat(Sim->dynamics->getCompleteRotData());
 
+    _sample.resize(Sim->N);
     BOOST_FOREACH(const Particle& part, Sim->particles)
-      {
-	historicalData[part.getID()].push_front(RUpair(part.getPosition(), initial_rdat[part.getID()].orientation));
-      }
+      _sample[part.getID()] = RUpair(part.getPosition(), current_rdat[part.getID()].orientation);
+
+    historicalData.push(_sample);
   }
 
   void
-  OPMSDOrientationalCorrelator::ticker()
+  OPMSDOrientationalCorrelator::accPass()
   {
-    const std::vector<Dynamics::rotData>& current_rdat(Sim->dynamics->getCompleteRotData());
-    BOOST_FOREACH(const Particle& part, Sim->particles)
+    const size_t dataSize = historicalData.levels() * length;
+    stepped_data_parallel.resize(dataSize, 0.0);
+    stepped_data_perpendicular.resize(dataSize, 0.0);
+    stepped_data_rotational_legendre1.resize(dataSize, 0.0);
+    stepped_data_rotational_legendre2.resize(dataSize, 0.0);
+    sampleCount.resize(dataSize, 0);
+
+    //Only the levels which have just been sampled have new time
+    //origins
+    for (size_t level(0); level < historicalData.updatedLevels(); ++level)
       {
-	historicalData[part.getID()].push_front(RUpair(part.getPosition(), current_rdat[part.getID()].orientation));
-      }
+	const std::vector<RUpair>& current = historicalData.get(level, 0);
 
-    if (notReady)
-      {
-	if (++currCorrLength != length)
+	for (size_t step(historicalData.firstStep(level)); step < historicalData.size(level); ++step)
 	  {
-	    return;
-	  }
+	    const std::vector<RUpair>& old = historicalData.get(level, step);
+	    const size_t index = level * length + step;
 
-	notReady = false;
-      }
+	    ++sampleCount[index];
 
-    accPass();
+	    for (size_t ID(0); ID < Sim->N; ++ID)
+	      {
+		const Vector displacement_term = old[ID].first - current[ID].first;
+		const double longitudinal_projection = (displacement_term | current[ID].second);
+		const double cos_theta = (old[ID].second | current[ID].second);
+
+		stepped_data_parallel[index] += std::pow(longitudinal_projection, 2);
+		stepped_data_perpendicular[index] += (displacement_term - (longitudinal_projection * current[ID].second)).nrm2();
+
+		stepped_data_rotational_legendre1[index] += boost::math::legendre_p(1, cos_theta);
+		stepped_data_rotational_legendre2[index] += boost::math::legendre_p(2, cos_theta);
+	      }
+	  }
+      }
   }
 
   void
-  OPMSDOrientationalCorrelator::accPass()
+  OPMSDOrientationalCorrelator::outputData(magnet::xml::XmlStream& XML, const std::vector<double>& data,
+					   double initialValue, double unit) const
   {
-    ++ticksTaken;
-
-    double longitudinal_projection(0.0), cos_theta(0.0);
-    Vector displacement_term(0,0,0);
+    double dt = dynamic_cast<const SysTicker&>(*Sim->systems["SystemTicker"]).getPeriod() / Sim->units.unitTime();
 
-    BOOST_FOREACH(const Particle& part, Sim->particles)
-      {
-	for (size_t step(1); step < length; ++step)
-	  {
-	    displacement_term = historicalData[part.getID()][step].first - historicalData[part.getID()][0].first;
-	    longitudinal_projection = (displacement_term | historicalData[part.getID()][0].second);
-	    cos_theta = (historicalData[part.getID()][step].second | historicalData[part.getID()][0].second);
+    XML << 0 << "\t" << initialValue << "\n";
 
-	    stepped_data_parallel[step] += std::pow(longitudinal_projection, 2);
-	    stepped_data_perpendicular[step] += (displacement_term - (longitudinal_projection * historicalData[part.getID()][0].second)).nrm2();
+    for (size_t level(0); level < historicalData.levels(); ++level)
+      for (size_t step(historicalData.firstStep(level)); step < length; ++step)
+	{
+	  const size_t index = level * length + step;
+	  if ((index >= sampleCount.size()) || !sampleCount[index]) continue;
 
-	    stepped_data_rotational_legendre1[step] += boost::math::legendre_p(1, cos_theta);
-	    stepped_data_rotational_legendre2[step] += boost::math::legendre_p(2, cos_theta);
-	  }
-      }
+	  XML << dt * step * historicalData.period(level) << "\t"
+	      << data[index] / (static_cast<double>(sampleCount[index]) * static_cast<double>(Sim->N) * unit)
+	      << "\n";
+	}
   }
 
   void
@@ -129,18 +166,11 @@ namespace dynamo {
     // Begin XML output
     XML << magnet::xml::tag("MSDOrientationalCorrelator");
 
-    double dt = dynamic_cast<const SysTicker&>(*Sim->systems["SystemTicker"]).getPeriod() / Sim->units.unitTime();
-
     XML << magnet::xml::tag("Component")
 	<< magnet::xml::attr("Type") << "Parallel"
 	<< magnet::xml::chardata();
 
-    for (size_t step(0); step < length; ++step)
-      {
-	XML << dt * step << "\t"
-	    << stepped_data_parallel[step] / (static_cast<double>(ticksTaken) * static_cast<double>(Sim->N) * Sim->units.unitArea())
-	    << "\n";
-      }
+    outputData(XML, stepped_data_parallel, 0, Sim->units.unitArea());
 
     XML << magnet::xml::endtag("Component");
 
@@ -148,12 +178,7 @@ namespace dynamo {
 	<< magnet::xml::attr("Type") << "Perpendicular"
 	<< magnet::xml::chardata();
 
-    for (size_t step(0); step < length; ++step)
-      {
-	XML << dt * step << "\t"
-	    << stepped_data_perpendicular[step] / (static_cast<double>(ticksTaken) * static_cast<double>(Sim->N) * Sim->units.unitArea())
-	    << "\n";
-      }
+    outputData(XML, stepped_data_perpendicular, 0, Sim->units.unitArea());
 
     XML << magnet::xml::endtag("Component");
 
@@ -164,12 +189,7 @@ namespace dynamo {
 	<< magnet::xml::attr("Name") << "LegendrePolynomial1"
 	<< magnet::xml::chardata();
 
-    for (size_t step(0); step < length; ++step)
-      {
-	XML << dt * step << "\t"
-	    << stepped_data_rotational_legendre1[step] / (static_cast<double>(ticksTaken) * static_cast<double>(Sim->N))
-	    << "\n";
-      }
+    outputData(XML, stepped_data_rotational_legendre1, 1, 1);
 
     XML << magnet::xml::endtag("Method");
 
@@ -177,12 +197,7 @@ namespace dynamo {
 	<< magnet::xml::attr("Name") << "LegendrePolynomial2"
 	<< magnet::xml::chardata();
 
-    for (size_t step(0); step < length; ++step)
-      {
-	XML << dt * step << "\t"
-	    << stepped_data_rotational_legendre2[step] / (static_cast<double>(ticksTaken) * static_cast<double>(Sim->N))
-	    << "\n";
-      }
+    outputData(XML, stepped_data_rotational_legendre2, 1, 1);
 
     XML << magnet::xml::endtag("Method");
 
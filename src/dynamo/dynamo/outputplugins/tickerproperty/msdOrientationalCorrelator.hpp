@@ -17,11 +17,16 @@
 
 #pragma once
 #include <dynamo/outputplugins/tickerproperty/ticker.hpp>
-#include <boost/circular_buffer.hpp>
+#include <magnet/math/correlators.hpp>
 #include <magnet/math/vector.hpp>
 #include <vector>
 
 namespace dynamo {
+  /*! \brief Calculates the parallel and perpendicular mean square
+      displacements and the rotational correlation of oriented
+      particles, using a multiple-tau correlator (see \ref
+      OPMSDCorrelator).
+   */
   class OPMSDOrientationalCorrelator: public OPTicker
   {
   public:
@@ -30,6 +35,8 @@ namespace dynamo {
 
     virtual void initialise();
 
+    virtual void reorderParticles(const std::vector<size_t>&);
+
     void output(magnet::xml::XmlStream &);
 
     virtual void operator<<(const magnet::xml::Node&);
@@ -42,14 +49,21 @@ namespace dynamo {
 
     void accPass();
 
-    std::vector<boost::circular_buffer<RUpair> > historicalData;
+    void takeSample();
+
+    void outputData(magnet::xml::XmlStream&, const std::vector<double>&, double, double) const;
+
+    magnet::math::MultiTauHistory<RUpair> historicalData;
+    //! Reused storage for the current sample
+    std::vector<RUpair> _sample;
+    //! The summed data, indexed by [level * length + step]
     std::vector<double> stepped_data_parallel, stepped_data_perpendicular,
 			   stepped_data_rotational_legendre1,
 			   stepped_data_rotational_legendre2;
+    //! The number of time origins summed, indexed by [level * length + step]
+    std::vector<size_t> sampleCount;
 
     size_t length;
-    size_t currCorrLength;
-    size_t ticksTaken;
-    bool notReady;
+    size_t scaling;
   };
 }
@@ -30,9 +30,7 @@ namespace dynamo {
 				   const magnet::xml::Node& XML):
     OPTicker(tmp,"MSDCorrelator"),
     length(20),
-    currCorrLength(0),
-    ticksTaken(0),
-    notReady(true)
+    scaling(2)
   {
     operator<<(XML);
   }
@@ -44,6 +42,9 @@ namespace dynamo {
       {
 	if (XML.hasAttribute("Length"))
 	  length = XML.getAttribute("Length").as<size_t>();
+
+	if (XML.hasAttribute("Scaling"))
+	  scaling = XML.getAttribute("Scaling").as<size_t>();
       }
     catch (boost::bad_lexical_cast &)
       {
@@ -52,79 +53,97 @@ namespace dynamo {
 
   }
 
+  void
+  OPMSDCorrelator::reorderParticles(const std::vector<size_t>& order)
+  {
+    for (size_t level(0); level < posHistory.levels(); ++level)
+      for (size_t step(0); step < posHistory.size(level); ++step)
+	reorderParticleData(posHistory.get(level, step), order);
+  }
+
   void 
   OPMSDCorrelator::initialise()
   {
-    dout << "The length of the MSD correlator is " << length << std::endl;
-
-    posHistory.resize(Sim->N, boost::circular_buffer<Vector>(length));
+    dout << "The length of the MSD correlator is " << length 
+	 << ", with a scaling of " << scaling << std::endl;
 
-    currCorrLength=1;
-
-    BOOST_FOREACH(const Particle& part, Sim->particles)
-      posHistory[part.getID()].push_front(part.getPosition());
+    try {
+      posHistory.resize(length, scaling);
+    }
+    catch (std::exception& excep)
+      {
+	M_throw() << "Bad Length or Scaling for the MSDCorrelator\n" << excep.what();
+      }
 
-    speciesData.resize(Sim->species.size(), 
-		       std::vector<double>(length, 0.0));
+    speciesData.clear();
+    speciesData.resize(Sim->species.size());
+    structData.clear();
+    structData.resize(Sim->topology.size());
+    sampleCount.clear();
 
-    structData.resize(Sim->topology.size(), 
-		      std::vector<double>(length, 0.0));
+    takeSample();
   }
 
   void 
   OPMSDCorrelator::ticker()
   {
-    BOOST_FOREACH(const Particle& part, Sim->particles)
-      posHistory[part.getID()].push_front(part.getPosition());
-  
-    if (notReady)
-      {
-	if (++currCorrLength != length)
-	  return;
-      
-	notReady = false;
-      }
-  
+    takeSample();
     accPass();
   }
 
   void
-  OPMSDCorrelator::accPass()
+  OPMSDCorrelator::takeSample()
   {
-    ++ticksTaken;
-  
-    BOOST_FOREACH(const shared_ptr<Species>& sp, Sim->species)
-      BOOST_FOREACH(const size_t& ID, *sp->getRange())
-      for (size_t step(1); step < length; ++step)
-	speciesData[sp->getID()][step]
-	  += (posHistory[ID][step] - posHistory[ID][0]).nrm2();
-  
-    BOOST_FOREACH(const shared_ptr<Topology>& topo, Sim->topology)
-      BOOST_FOREACH(const shared_ptr<IDRange>& range, topo->getMolecules())
-      {
-	Vector  molCOM(0,0,0);
-	double molMass(0);
+    _sample.resize(Sim->N);
+    BOOST_FOREACH(const Particle& part, Sim->particles)
+      _sample[part.getID()] = part.getPosition();
 
-	BOOST_FOREACH(const size_t& ID, *range)
-	  {
-	    double mass = Sim->species[Sim->particles[ID]]->getMass(ID);
-	    molCOM += posHistory[ID][0] * mass;
-	    molMass += mass;
-	  }
+    posHistory.push(_sample);
+  }
 
-	molCOM /= molMass;
+  void
+  OPMSDCorrelator::accPass()
+  {
+    const size_t dataSize = posHistory.levels() * length;
+    sampleCount.resize(dataSize, 0);
+    BOOST_FOREACH(std::vector<double>& data, speciesData)
+      data.resize(dataSize, 0.0);
+    BOOST_FOREACH(std::vector<double>& data, structData)
+      data.resize(dataSize, 0.0);
+
+    //Only the levels which have just been sampled have new time
+    //origins
+    for (size_t level(0); level < posHistory.updatedLevels(); ++level)
+      {
+	const std::vector<Vector>& current = posHistory.get(level, 0);
 
-	for (size_t step(1); step < length; ++step)
+	for (size_t step(posHistory.firstStep(level)); step < posHistory.size(level); ++step)
 	  {
-	    Vector  molCOM2(0,0,0);
-	  
-	    BOOST_FOREACH(const size_t& ID, *range)
-	      molCOM2 += posHistory[ID][step] 
-	      * Sim->species[Sim->particles[ID]]->getMass(ID);
-	  
-	    molCOM2 /= molMass;
-	  
-	    structData[topo->getID()][step] += (molCOM2 - molCOM).nrm2();
+	    const std::vector<Vector>& old = posHistory.get(level, step);
+	    const size_t index = level * length + step;
+
+	    ++sampleCount[index];
+
+	    BOOST_FOREACH(const shared_ptr<Species>& sp, Sim->species)
+	      BOOST_FOREACH(const size_t& ID, *sp->getRange())
+	      speciesData[sp->getID()][index] += (old[ID] - current[ID]).nrm2();
+	    
+	    BOOST_FOREACH(const shared_ptr<Topology>& topo, Sim->topology)
+	      BOOST_FOREACH(const shared_ptr<IDRange>& range, topo->getMolecules())
+	      {
+		Vector  molCOM(0,0,0), molCOM2(0,0,0);
+		double molMass(0);
+
+		BOOST_FOREACH(const size_t& ID, *range)
+		  {
+		    double mass = Sim->species[Sim->particles[ID]]->getMass(ID);
+		    molCOM += current[ID] * mass;
+		    molCOM2 += old[ID] * mass;
+		    molMass += mass;
+		  }
+
+		structData[topo->getID()][index] += ((molCOM2 - molCOM) / molMass).nrm2();
+	      }
 	  }
       }
   }
@@ -146,13 +165,21 @@ namespace dynamo {
 	    << sp->getName()
 	    << magnet::xml::chardata();
       
-	for (size_t step(0); step < length; ++step)
-	  XML << dt * step << " "
-	      << speciesData[sp->getID()][step] 
-	    / (static_cast<double>(ticksTaken) 
-	       * static_cast<double>(sp->getCount())
-	       * Sim->units.unitArea())
-	      << "\n";
+	XML << 0 << " " << 0 << "\n";
+
+	for (size_t level(0); level < posHistory.levels(); ++level)
+	  for (size_t step(posHistory.firstStep(level)); step < length; ++step)
+	    {
+	      const size_t index = level * length + step;
+	      if ((index >= sampleCount.size()) || !sampleCount[index]) continue;
+
+	      XML << dt * step * posHistory.period(level) << " "
+		  << speciesData[sp->getID()][index] 
+		/ (static_cast<double>(sampleCount[index]) 
+		   * static_cast<double>(sp->getCount())
+		   * Sim->units.unitArea())
+		  << "\n";
+	    }
       
 	XML << magnet::xml::endtag("Species");
       }
@@ -168,13 +195,21 @@ namespace dynamo {
 	    << topo->getName()
 	    << magnet::xml::chardata();
       
-	for (size_t step(0); step < length; ++step)
-	  XML << dt * step << " "
-	      << structData[topo->getID()][step]
-	    / (static_cast<double>(ticksTaken) 
-	       * static_cast<double>(topo->getMolecules().size())
-	       * Sim->units.unitArea())
-	      << "\n";
+	XML << 0 << " " << 0 << "\n";
+
+	for (size_t level(0); level < posHistory.levels(); ++level)
+	  for (size_t step(posHistory.firstStep(level)); step < length; ++step)
+	    {
+	      const size_t index = level * length + step;
+	      if ((index >= sampleCount.size()) || !sampleCount[index]) continue;
+
+	      XML << dt * step * posHistory.period(level) << " "
+		  << structData[topo->getID()][index]
+		/ (static_cast<double>(sampleCount[index]) 
+		   * static_cast<double>(topo->getMolecules().size())
+		   * Sim->units.unitArea())
+		  << "\n";
+	    }
 	
 	XML << magnet::xml::endtag("Structure");
       }
@@ -17,13 +17,21 @@
 
 #pragma once
 #include <dynamo/outputplugins/tickerproperty/ticker.hpp>
-#include <boost/circular_buffer.hpp>
+#include <magnet/math/correlators.hpp>
 #include <magnet/math/vector.hpp>
 #include <vector>
 
 namespace dynamo {
   class OPMSD;
 
+  /*! \brief Calculates the mean square displacement of the species
+      and molecules using a multiple-tau correlator.
+
+    The positions are stored in a \ref magnet::math::MultiTauHistory,
+    so the lag times grow logarithmically (by the Scaling factor every
+    Length samples) while the memory per particle only grows with the
+    logarithm of the simulation length.
+   */
   class OPMSDCorrelator: public OPTicker
   {
   public:
@@ -31,6 +39,8 @@ namespace dynamo {
 
     virtual void initialise();
 
+    virtual void reorderParticles(const std::vector<size_t>&);
+
     void output(magnet::xml::XmlStream &); 
 
     virtual void operator<<(const magnet::xml::Node&);
@@ -41,12 +51,17 @@ namespace dynamo {
 
     void accPass();
 
-    std::vector<boost::circular_buffer<Vector> > posHistory;
+    void takeSample();
+
+    magnet::math::MultiTauHistory<Vector> posHistory;
+    //! Reused storage for the current sample
+    std::vector<Vector> _sample;
+    //! The summed square displacements, indexed by [species/topology ID][level * length + step]
     std::vector<std::vector<double> > speciesData;
     std::vector<std::vector<double> > structData;
+    //! The number of time origins summed, indexed by [level * length + step]
+    std::vector<size_t> sampleCount;
     size_t length;
-    size_t currCorrLength;
-    size_t ticksTaken;
-    bool notReady;
+    size_t scaling;
   };
 }
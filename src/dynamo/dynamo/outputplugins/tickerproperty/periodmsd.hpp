@@ -31,6 +31,8 @@ namespace dynamo {
 
     virtual void initialise();
 
+    virtual void reorderParticles(const std::vector<size_t>&) {}
+
     void output(magnet::xml::XmlStream &); 
 
   protected:
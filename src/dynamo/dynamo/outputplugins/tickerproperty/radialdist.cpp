@@ -19,9 +19,13 @@
 #include <dynamo/outputplugins/0partproperty/misc.hpp>
 #include <dynamo/include.hpp>
 #include <dynamo/dynamics/dynamics.hpp>
+#include <dynamo/BC/PBC.hpp>
+#include <magnet/thread/threadpool.hpp>
 #include <magnet/xmlwriter.hpp>
 #include <magnet/xmlreader.hpp>
 #include <boost/foreach.hpp>
+#include <typeinfo>
+#include <cmath>
 
 namespace dynamo {
   OPRadialDistribution::OPRadialDistribution(const dynamo::Simulation* tmp, 
@@ -99,6 +103,33 @@ namespace dynamo {
     if (!(Sim->getOutputPlugin<OPMisc>()))
       M_throw() << "Radial Distribution requires the Misc output plugin";
 
+    //Pairs are binned if their separation is less than the cutoff
+    //(bins are centered on multiples of the binWidth). The cells must
+    //be at least the cutoff wide, and there must be at least three in
+    //each dimension so that the neighbouring cells are distinct.
+    const double cutoff = (length - 0.5) * binWidth;
+    _cellCount.clear();
+    if (typeid(*Sim->BCs) == typeid(BCPeriodic))
+      {
+	_cellCount.resize(NDIM);
+	for (size_t iDim(0); iDim < NDIM; ++iDim)
+	  {
+	    _cellCount[iDim] = static_cast<size_t>(Sim->primaryCellSize[iDim] / cutoff);
+	    if (_cellCount[iDim] < 3)
+	      {
+		_cellCount.clear();
+		break;
+	      }
+	    _cellDimension[iDim] = Sim->primaryCellSize[iDim] / _cellCount[iDim];
+	  }
+      }
+
+    if (_cellCount.empty())
+      dout << "Binning all pairs of particles" << std::endl;
+    else
+      dout << "Binning pairs using " << _cellCount[0] << "x" << _cellCount[1] 
+	   << "x" << _cellCount[2] << " cells" << std::endl;
+
     ticker();
   }
 
@@ -124,7 +155,16 @@ namespace dynamo {
       }
     
     ++sampleCount;
-  
+
+    if (_cellCount.empty())
+      binAllPairs();
+    else
+      binCellPairs();
+  }
+
+  void
+  OPRadialDistribution::binAllPairs()
+  {
     BOOST_FOREACH(const shared_ptr<Species>& sp1, Sim->species)
       BOOST_FOREACH(const shared_ptr<Species>& sp2, Sim->species)
       BOOST_FOREACH(const size_t& p1, *sp1->getRange())
@@ -142,9 +182,134 @@ namespace dynamo {
       }
   }
 
+  void
+  OPRadialDistribution::binCellPairs()
+  {
+    const size_t nCells = _cellCount[0] * _cellCount[1] * _cellCount[2];
+
+    //Build the linked lists of the particles in each cell
+    _cellHead.assign(nCells, Sim->N);
+    _cellNext.resize(Sim->N);
+    _speciesID.resize(Sim->N);
+
+    BOOST_FOREACH(const shared_ptr<Species>& sp, Sim->species)
+      BOOST_FOREACH(const size_t& ID, *sp->getRange())
+      _speciesID[ID] = sp->getID();
+
+    for (size_t ID(0); ID < Sim->N; ++ID)
+      {
+	Vector pos = Sim->particles[ID].getPosition();
+	Sim->BCs->applyBC(pos);
+
+	size_t cellID = 0;
+	for (size_t iDim(NDIM); iDim != 0; --iDim)
+	  {
+	    long coord = std::floor((pos[iDim - 1] + 0.5 * Sim->primaryCellSize[iDim - 1])
+				    / _cellDimension[iDim - 1]);
+	    //Guard against rounding at the edges of the primary image
+	    coord = std::max(0l, std::min(coord, long(_cellCount[iDim - 1]) - 1));
+	    cellID = cellID * _cellCount[iDim - 1] + coord;
+	  }
+
+	_cellNext[ID] = _cellHead[cellID];
+	_cellHead[cellID] = ID;
+      }
+
+    const size_t histSize = Sim->species.size() * Sim->species.size() * length;
+
+    if (!Sim->threads)
+      {
+	_taskData.resize(1);
+	_taskData[0].resize(histSize, 0);
+	binCellRange(0, nCells, &_taskData[0]);
+	return;
+      }
+
+    //Several tasks per thread to balance the load
+    const size_t nTasks = std::min(8 * std::max(Sim->threads->getThreadCount(), size_t(1)), nCells);
+    const size_t stride = (nCells + nTasks - 1) / nTasks;
+
+    if (_taskData.size() < nTasks)
+      _taskData.resize(nTasks);
+
+    std::vector<magnet::function::Task*> tasks;
+    for (size_t start(0), task(0); start < nCells; start += stride, ++task)
+      {
+	_taskData[task].resize(histSize, 0);
+	tasks.push_back(magnet::function::Task::makeTask(&OPRadialDistribution::binCellRange, 
+							 static_cast<const OPRadialDistribution*>(this),
+							 start, std::min(start + stride, nCells),
+							 &_taskData[task]));
+      }
+
+    Sim->threads->queueTasks(tasks);
+    Sim->threads->wait();
+  }
+
+  void
+  OPRadialDistribution::binCellRange(size_t start, size_t end, std::vector<unsigned long>* hist) const
+  {
+    const size_t nSpecies = Sim->species.size();
+
+    for (size_t cellID(start); cellID < end; ++cellID)
+      {
+	const long coords[3] = {long(cellID % _cellCount[0]), 
+				long((cellID / _cellCount[0]) % _cellCount[1]),
+				long(cellID / (_cellCount[0] * _cellCount[1]))};
+	
+	for (long x(coords[0] - 1); x <= coords[0] + 1; ++x)
+	  for (long y(coords[1] - 1); y <= coords[1] + 1; ++y)
+	    for (long z(coords[2] - 1); z <= coords[2] + 1; ++z)
+	      {
+		const size_t nbCell 
+		  = ((x + _cellCount[0]) % _cellCount[0])
+		  + _cellCount[0] * (((y + _cellCount[1]) % _cellCount[1])
+				     + _cellCount[1] * ((z + _cellCount[2]) % _cellCount[2]));
+
+		for (size_t p1(_cellHead[cellID]); p1 != Sim->N; p1 = _cellNext[p1])
+		  {
+		    const Vector& pos1 = Sim->particles[p1].getPosition();
+		    unsigned long* const row 
+		      = &(*hist)[(_speciesID[p1] * nSpecies) * length];
+
+		    for (size_t p2(_cellHead[nbCell]); p2 != Sim->N; p2 = _cellNext[p2])
+		      {
+			Vector rij = pos1 - Sim->particles[p2].getPosition();
+			Sim->BCs->applyBC(rij);
+
+			size_t i = (long) (((rij.nrm())/binWidth) + 0.5);
+
+			if (i < length)
+			  ++row[_speciesID[p2] * length + i];
+		      }
+		  }
+	      }
+      }
+  }
+
+  void
+  OPRadialDistribution::mergeTaskData()
+  {
+    const size_t nSpecies = Sim->species.size();
+
+    BOOST_FOREACH(std::vector<unsigned long>& hist, _taskData)
+      {
+	if (hist.empty()) continue;
+
+	for (size_t sp1(0); sp1 < nSpecies; ++sp1)
+	  for (size_t sp2(0); sp2 < nSpecies; ++sp2)
+	    for (size_t i(0); i < length; ++i)
+	      data[sp1][sp2][i] += hist[(sp1 * nSpecies + sp2) * length + i];
+
+	hist.assign(hist.size(), 0);
+      }
+  }
+
   void
   OPRadialDistribution::output(magnet::xml::XmlStream& XML)
   {
+    mergeTaskData();
+
     XML << magnet::xml::tag("RadialDistribution")
 	<< magnet::xml::attr("SampleCount")
 	<< sampleCount;
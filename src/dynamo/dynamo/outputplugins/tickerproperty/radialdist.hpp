@@ -19,9 +19,21 @@
 
 #include <dynamo/outputplugins/tickerproperty/ticker.hpp>
 #include <magnet/math/histogram.hpp>
+#include <magnet/math/vector.hpp>
 #include <vector>
 
 namespace dynamo {
+  /*! \brief Samples the radial distribution function of each pair of
+      species.
+
+    In plain periodic systems where the histogram is shorter than a
+    third of the primary image, the particles are sorted into a
+    private grid of cells at least as wide as the histogram. Only
+    pairs in neighbouring cells are then binned, which makes each
+    sample O(N). The cells are split over the simulation's ThreadPool
+    (if available), each task binning into its own histogram.
+    Otherwise every pair of particles is binned.
+   */
   class OPRadialDistribution: public OPTicker
   {
   public:
@@ -30,6 +42,8 @@ namespace dynamo {
 
     virtual void initialise();
 
+    virtual void reorderParticles(const std::vector<size_t>&) {}
+
     virtual void stream(double) {}
 
     virtual void ticker();
@@ -45,5 +59,31 @@ namespace dynamo {
     double sample_energy; 
     double sample_energy_bin_width;
     std::vector<std::vector<std::vector<unsigned long> > > data;
+
+    //! \brief Bin every pair of particles.
+    void binAllPairs();
+
+    //! \brief Sort the particles into the cells and bin the nearby pairs.
+    void binCellPairs();
+
+    /*! \brief Bin the pairs with a particle in the passed range of
+        cells into a flat [species1][species2][bin] histogram.
+     */
+    void binCellRange(size_t start, size_t end, std::vector<unsigned long>* hist) const;
+
+    //! \brief Add the task histograms to the data.
+    void mergeTaskData();
+
+    //! The number of cells in each dimension, empty if cells are not used.
+    std::vector<size_t> _cellCount;
+    Vector _cellDimension;
+    //! The first particle in each cell (or Sim->N if empty).
+    std::vector<size_t> _cellHead;
+    //! The next particle in the same cell (or Sim->N for the last).
+    std::vector<size_t> _cellNext;
+    //! The species ID of each particle.
+    std::vector<size_t> _speciesID;
+    //! The histograms of each binning task, merged on output.
+    std::vector<std::vector<unsigned long> > _taskData;
   };
 }
@@ -28,6 +28,12 @@ namespace dynamo {
   //! particle, such as its position, velocity, ID, and state
   //! flags. Other data is "attached" to this particle using
   //! Property classes stored in the PropertyStore.
+  //!
+  //! The data members are ordered so that the "hot" kinematic data
+  //! used by the event predictors (position, velocity and peculiar
+  //! time) is contiguous and leads the class, ahead of the "cold"
+  //! identification data. A structure-of-arrays copy of the hot data
+  //! can also be maintained by the Dynamics (see \ref ParticleSoA).
   class Particle
   {
   public:
@@ -55,14 +61,14 @@ namespace dynamo {
 		     const Vector  &velocity,
 		     const unsigned long& nID):
       _pos(position), _vel(velocity), 
-      _ID(nID), _peculiarTime(0.0),
+      _peculiarTime(0.0), _ID(nID),
       _state(DEFAULT)
     {}
   
     //! \brief Constructor to build a particle from an XML node.
     Particle(const magnet::xml::Node& XML, unsigned long nID):
-      _ID(nID),
       _peculiarTime(0.0),
+      _ID(nID),
       _state(DEFAULT)
     {
       if (XML.hasAttribute("Static")) clearState(DYNAMIC);
@@ -122,10 +128,15 @@ namespace dynamo {
     inline void clearState(State nState) { _state &= (~nState); }  
 
   private:
+    //Hot data, accessed during event prediction
     Vector _pos;
     Vector _vel;
-    unsigned long _ID;
     double _peculiarTime;
+    //Cold data
+    unsigned long _ID;
     int _state;
+
+    //! The Simulation may renumber the particles (see Simulation::reorderParticles)
+    friend class Simulation;
   };
 }
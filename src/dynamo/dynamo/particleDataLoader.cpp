@@ -0,0 +1,302 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <dynamo/particleDataLoader.hpp>
+#include <dynamo/simulation.hpp>
+#include <dynamo/units/units.hpp>
+#include <magnet/exception.hpp>
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+  inline bool isSpace(const int c)
+  { return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r'); }
+}
+
+namespace dynamo {
+  ParticleDataLoader::ParticleDataLoader(const Simulation* sim):
+    Sim(sim),
+    _is(NULL),
+    _buffer(1 << 20),
+    _pos(0),
+    _end(0),
+    _outOfSequence(false)
+  {}
+
+  bool
+  ParticleDataLoader::fill()
+  {
+    _is->read(&_buffer[0], _buffer.size());
+    _pos = 0;
+    _end = _is->gcount();
+    return _end;
+  }
+
+  void 
+  ParticleDataLoader::load(std::istream& is, std::string& header)
+  {
+    _is = &is;
+    _pos = _end = 0;
+
+    //Copy the file up to the start of the ParticleData tag
+    const std::string startTag("<ParticleData");
+    bool found = false;
+    for (int c = get(); c != EOF; c = get())
+      {
+	header.push_back(c);
+	if ((c == 'a') && (header.size() >= startTag.size())
+	    && !header.compare(header.size() - startTag.size(), startTag.size(), startTag))
+	  {
+	    found = true;
+	    break;
+	  }
+      }
+
+    if (found)
+      {
+	//Copy the attributes of the ParticleData tag
+	char quote = 0;
+	int last = 0;
+	for (int c = get(); ; last = c, c = get())
+	  {
+	    if (c == EOF)
+	      M_throw() << "Unexpected end of file in the ParticleData tag";
+
+	    if (quote)
+	      { if (c == quote) quote = 0; }
+	    else if ((c == '"') || (c == '\''))
+	      quote = c;
+	    else if (c == '>')
+	      break;
+
+	    header.push_back(c);
+	  }
+
+	//A self-closing tag has already copied its '/'
+	if (last == '/')
+	  header.erase(header.size() - 1);
+	header.append("/>");
+
+	if (last != '/')
+	  for (;;)
+	    {
+	      readTag(_tag);
+
+	      if (_tag.closing && (_tag.name == "ParticleData"))
+		break;
+	      
+	      if (_tag.closing || (_tag.name != "Pt"))
+		M_throw() << "Unexpected tag <" << (_tag.closing ? "/" : "") << _tag.name 
+			  << "> in the ParticleData section";
+
+	      readPt(_tag);
+	    }
+      }
+
+    //Copy the rest of the file
+    do
+      header.append(_buffer.begin() + _pos, _buffer.begin() + _end);
+    while (fill());
+  }
+
+  void 
+  ParticleDataLoader::readTag(Tag& tag)
+  {
+    int c;
+    //Skip any character data and comments
+    for (;;)
+      {
+	while (((c = get()) != EOF) && (c != '<')) {}
+	
+	if (c == EOF)
+	  M_throw() << "Unexpected end of file in the ParticleData section";
+	
+	c = get();
+	if (c != '!') break;
+
+	//A comment, skip to the "-->"
+	int last1 = 0, last2 = 0;
+	while (((c = get()) != EOF) && !((c == '>') && (last1 == '-') && (last2 == '-')))
+	  { last2 = last1; last1 = c; }
+      }
+
+    tag.closing = (c == '/');
+    if (tag.closing) c = get();
+
+    tag.name.clear();
+    for (; (c != EOF) && !isSpace(c) && (c != '>') && (c != '/'); c = get())
+      tag.name.push_back(c);
+
+    tag.selfClosing = false;
+    tag.attributeCount = 0;
+    for (;;)
+      {
+	while (isSpace(c)) c = get();
+	
+	if (c == '>') return;
+
+	if (c == '/')
+	  {
+	    tag.selfClosing = true;
+	    if (get() != '>')
+	      M_throw() << "Malformed <" << tag.name << "> tag in the ParticleData section";
+	    return;
+	  }
+	
+	if ((c == EOF) || tag.closing)
+	  M_throw() << "Malformed <" << tag.name << "> tag in the ParticleData section";
+
+	if (tag.attributeCount == tag.attributes.size())
+	  tag.attributes.resize(tag.attributeCount + 1);
+
+	std::pair<std::string, std::string>& attr = tag.attributes[tag.attributeCount++];
+	attr.first.clear();
+	attr.second.clear();
+
+	for (; (c != EOF) && !isSpace(c) && (c != '='); c = get())
+	  attr.first.push_back(c);
+	
+	while (isSpace(c)) c = get();
+
+	if (c != '=')
+	  M_throw() << "Malformed attribute " << attr.first << " in the <" 
+		    << tag.name << "> tag in the ParticleData section";
+	
+	do c = get(); while (isSpace(c));
+
+	if ((c != '"') && (c != '\''))
+	  M_throw() << "Malformed attribute " << attr.first << " in the <" 
+		    << tag.name << "> tag in the ParticleData section";
+
+	const int quote = c;
+	for (c = get(); (c != EOF) && (c != quote); c = get())
+	  attr.second.push_back(c);
+
+	c = get();
+      }
+  }
+
+  void 
+  ParticleDataLoader::readPt(const Tag& pt)
+  {
+    const size_t ID = _particles.size();
+    bool hasID = false;
+    bool isStatic = false;
+
+    for (size_t i(0); i < pt.attributeCount; ++i)
+      {
+	const std::pair<std::string, std::string>& attr = pt.attributes[i];
+	if (attr.first == "ID")
+	  {
+	    hasID = true;
+	    if (std::strtoul(attr.second.c_str(), NULL, 10) != ID)
+	      _outOfSequence = true;
+	  }
+	else if (attr.first == "Static")
+	  isStatic = true;
+	else
+	  getColumn(i, attr.first).push_back(parseDouble(attr.second));
+      }
+
+    if (!hasID) 
+      _outOfSequence = true;
+
+    Vector pos(0,0,0), vel(0,0,0);
+    bool hasPos = false, hasVel = false;
+
+    if (!pt.selfClosing)
+      for (;;)
+	{
+	  readTag(_tag);
+
+	  if (_tag.closing)
+	    {
+	      if (_tag.name == "Pt") break;
+	      continue;
+	    }
+
+	  if (_tag.name == "P")
+	    { readVector(_tag, pos); hasPos = true; }
+	  else if (_tag.name == "V")
+	    { readVector(_tag, vel); hasVel = true; }
+	  else if (_tag.name == "U")
+	    {
+	      _orientations.resize(ID + 1, Vector(0,0,0));
+	      readVector(_tag, _orientations.back());
+	    }
+	  else if (_tag.name == "O")
+	    {
+	      _angularVelocities.resize(ID + 1, Vector(0,0,0));
+	      readVector(_tag, _angularVelocities.back());
+	    }
+	}
+
+    if (!hasPos || !hasVel)
+      M_throw() << "Particle " << ID << " is missing its position or velocity";
+
+    Particle part(pos, vel, ID);
+    if (isStatic) part.clearState(Particle::DYNAMIC);
+    part.getVelocity() *= Sim->units.unitVelocity();
+    part.getPosition() *= Sim->units.unitLength();
+    _particles.push_back(part);
+  }
+
+  void
+  ParticleDataLoader::readVector(const Tag& tag, Vector& vec) const
+  {
+    for (size_t iDim(0); iDim < NDIM; ++iDim)
+      {
+	bool found = false;
+	for (size_t i(0); i < tag.attributeCount; ++i)
+	  {
+	    const std::string& name = tag.attributes[i].first;
+	    if ((name.size() == 1) 
+		&& ((name[0] == char('x' + iDim)) || (name[0] == char('0' + iDim))))
+	      {
+		vec[iDim] = parseDouble(tag.attributes[i].second);
+		found = true;
+		break;
+	      }
+	  }
+	
+	if (!found)
+	  M_throw() << "Missing component " << iDim << " of a <" << tag.name << "> tag";
+      }
+  }
+
+  double
+  ParticleDataLoader::parseDouble(const std::string& str) const
+  {
+    char* end;
+    const double val = std::strtod(str.c_str(), &end);
+    if (str.empty() || (*end != '\0'))
+      M_throw() << "Failed to convert \"" << str << "\" to a number in the ParticleData section";
+    return val;
+  }
+
+  std::vector<double>& 
+  ParticleDataLoader::getColumn(const size_t i, const std::string& name)
+  {
+    if (i >= _columnCache.size())
+      _columnCache.resize(i + 1, std::pair<std::string, std::vector<double>*>("", NULL));
+
+    if (!_columnCache[i].second || (_columnCache[i].first != name))
+      _columnCache[i] = std::make_pair(name, &_attributes[name]);
+
+    return *_columnCache[i].second;
+  }
+}
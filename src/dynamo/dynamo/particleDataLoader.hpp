@@ -0,0 +1,118 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include <dynamo/particle.hpp>
+#include <iosfwd>
+#include <vector>
+#include <string>
+#include <map>
+
+namespace dynamo {
+  class Simulation;
+
+  /*! \brief A streaming reader for the particle data of XML
+      configuration files.
+
+    Nearly all of a large configuration file is the ParticleData
+    section. Reading it with the DOM parser requires the whole
+    decompressed file and a DOM node for every tag to be held in
+    memory at once. This class reads the file from a stream in
+    fixed sized chunks, so the decompression is incremental. The
+    rest of the file is passed on to the DOM parser, but the Pt tags
+    are parsed as they arrive and their data is stored in the final
+    particle arrays.
+
+    Only the tag syntax written by \ref Simulation::writeXMLfile is
+    understood in the ParticleData section (no entities or CDATA).
+   */
+  class ParticleDataLoader
+  {
+  public:
+    ParticleDataLoader(const Simulation* sim);
+
+    /*! \brief Read an XML configuration file from a stream.
+
+      \param is The stream of the file (already decompressed).
+      \param header Everything except the children of the
+      ParticleData tag is appended to this string, ready for the DOM
+      parser.
+     */
+    void load(std::istream& is, std::string& header);
+
+    //! \brief The particles read (in simulation units).
+    std::vector<Particle>& getParticles() { return _particles; }
+
+    /*! \brief The values of any other numeric attributes of the Pt
+        tags, by name (e.g., the per-particle Property values).
+     */
+    std::map<std::string, std::vector<double> >& getAttributeData() 
+    { return _attributes; }
+
+    //! \brief The orientation (U tags) of the particles, if present.
+    const std::vector<Vector>& getOrientations() const { return _orientations; }
+
+    //! \brief The angular velocities (O tags) of the particles, if present.
+    const std::vector<Vector>& getAngularVelocities() const { return _angularVelocities; }
+
+    //! \brief If the ID attributes were missing or did not match the file order.
+    bool outOfSequence() const { return _outOfSequence; }
+
+  private:
+    struct Tag
+    {
+      std::string name;
+      bool closing;
+      bool selfClosing;
+      //! Only the first attributeCount entries are valid, the rest
+      //! are kept to reuse their storage.
+      std::vector<std::pair<std::string, std::string> > attributes;
+      size_t attributeCount;
+    };
+
+    //! \brief Fetch the next character of the stream, or EOF.
+    inline int get()
+    {
+      if ((_pos == _end) && !fill()) return EOF;
+      return static_cast<unsigned char>(_buffer[_pos++]);
+    }
+
+    bool fill();
+
+    void readTag(Tag&);
+    void readPt(const Tag&);
+    void readVector(const Tag&, Vector&) const;
+    double parseDouble(const std::string&) const;
+    std::vector<double>& getColumn(const size_t, const std::string&);
+
+    const Simulation* Sim;
+    std::istream* _is;
+    std::vector<char> _buffer;
+    size_t _pos;
+    size_t _end;
+
+    std::vector<Particle> _particles;
+    std::map<std::string, std::vector<double> > _attributes;
+    std::vector<Vector> _orientations;
+    std::vector<Vector> _angularVelocities;
+    bool _outOfSequence;
+
+    Tag _tag;
+    //! The attribute columns, cached by the attribute position in
+    //! the Pt tag.
+    std::vector<std::pair<std::string, std::vector<double>*> > _columnCache;
+  };
+}
@@ -0,0 +1,124 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <dynamo/particle.hpp>
+#include <magnet/memory/aligned_allocator.hpp>
+#include <boost/foreach.hpp>
+#include <vector>
+
+namespace dynamo {
+  /*! \brief A structure-of-arrays copy of the "hot" kinematic data
+      of the \ref Particle s.
+
+      The \ref Particle class is an array-of-structs, which is
+      convenient for the event classes but means that a sweep over a
+      neighbourhood of particles strides over the cold data (ID, state
+      flags) of each particle. This class holds the position, velocity
+      and peculiar time of every particle in separate, cache-line
+      aligned arrays so that neighbour sweeps (see \ref
+      Dynamics::SphereSphereInRoot) can stream contiguous memory and be
+      vectorised by the compiler.
+
+      The \ref Particle s remain the authoritative copy of the data. The
+      arrays are kept in step by the \ref Dynamics class, which owns
+      the delayed states algorithm and is therefore the only place
+      where the peculiar time of a particle is altered. Any code which
+      changes a particles velocity must signal this through \ref
+      Simulation::signalParticleUpdate, as every event already does.
+   */
+  class ParticleSoA
+  {
+  public:
+    typedef std::vector<double, magnet::memory::AlignedAllocator<double> > Array;
+
+    inline size_t size() const { return _pecTime.size(); }
+    inline bool empty() const { return _pecTime.empty(); }
+
+    inline void clear()
+    {
+      for (size_t i(0); i < NDIM; ++i)
+	{
+	  _pos[i].clear();
+	  _vel[i].clear();
+	}
+      _pecTime.clear();
+    }
+
+    inline void resize(const size_t N)
+    {
+      for (size_t i(0); i < NDIM; ++i)
+	{
+	  _pos[i].resize(N, 0);
+	  _vel[i].resize(N, 0);
+	}
+      _pecTime.resize(N, 0);
+    }
+
+    //! \brief Copy the kinematic data of a single Particle into the arrays.
+    inline void store(const Particle& part)
+    {
+      const size_t ID(part.getID());
+      for (size_t i(0); i < NDIM; ++i)
+	{
+	  _pos[i][ID] = part.getPosition()[i];
+	  _vel[i][ID] = part.getVelocity()[i];
+	}
+      _pecTime[ID] = part.getPecTime();
+    }
+
+    //! \brief Rebuild the arrays from the passed particles.
+    inline void gather(const std::vector<Particle>& particles)
+    {
+      resize(particles.size());
+      BOOST_FOREACH(const Particle& part, particles)
+	store(part);
+    }
+
+    //! \brief Add a time to every peculiar time (see \ref Dynamics::stream).
+    inline void shiftPecTimes(const double dt)
+    {
+      const size_t N(_pecTime.size());
+      double* const pt(&_pecTime[0]);
+      for (size_t i(0); i < N; ++i)
+	pt[i] += dt;
+    }
+
+    /*! \brief Test if the stored data for a Particle matches the
+        Particle itself (used to validate the synchronisation in
+        debug builds).
+     */
+    inline bool matches(const Particle& part) const
+    {
+      const size_t ID(part.getID());
+      for (size_t i(0); i < NDIM; ++i)
+	if ((_pos[i][ID] != part.getPosition()[i])
+	    || (_vel[i][ID] != part.getVelocity()[i]))
+	  return false;
+      return _pecTime[ID] == part.getPecTime();
+    }
+
+    inline const double* pos(const size_t dim) const { return &_pos[dim][0]; }
+    inline const double* vel(const size_t dim) const { return &_vel[dim][0]; }
+    inline const double* pecTime() const { return &_pecTime[0]; }
+
+  private:
+    Array _pos[NDIM];
+    Array _vel[NDIM];
+    Array _pecTime;
+  };
+}
@@ -19,8 +19,10 @@
 #include <magnet/xmlwriter.hpp>
 #include <magnet/xmlreader.hpp>
 #include <magnet/units.hpp>
+#include <magnet/stream/binary.hpp>
 #include <vector>
 #include <string>
+#include <map>
 #include <algorithm>
 #include <cmath>
 
@@ -63,6 +65,11 @@ namespace dynamo {
     inline virtual std::string getName() const 
     { M_throw() << "Unimplemented"; }
 
+    //! This is called when the particles are renumbered (see
+    //! Simulation::reorderParticles).
+    //! \param order The old ID of each particle, indexed by its new ID.
+    inline virtual void reorderParticles(const std::vector<size_t>& order) {}
+
     //! Fetch the units of this property
     inline const Units& getUnits() const { return _units; }
 
@@ -77,6 +84,19 @@ namespace dynamo {
     inline virtual void outputParticleXMLData(magnet::xml::XmlStream& XML, 
 					      const size_t pID) const {}
 
+    //! Take the per-particle values of this Property, read from the
+    //! Pt tags of an XML file (see ParticleDataLoader). The values
+    //! are swapped out of the passed container.
+    inline virtual void loadParticleData(std::vector<double>& values) {}
+
+    //! Write this Property's data on all particles as raw binary (see
+    //! Simulation::writeXMLfile).
+    inline virtual void outputParticleBinaryData(std::ostream& os) const {}
+
+    //! Load the per-particle data written by outputParticleBinaryData.
+    //! \param N The number of particles.
+    inline virtual void loadParticleBinaryData(std::istream& is, const size_t N) {}
+
   protected:
     virtual void outputXML(magnet::xml::XmlStream& XML) const 
     { M_throw() << "Unimplemented"; }
@@ -136,16 +156,13 @@ namespace dynamo {
       Property(units), _name(name),
       _values(N, initalval) {}
   
+    //! The values are loaded later, either from the Pt tags (see
+    //! loadParticleData) or from a binary file (see
+    //! loadParticleBinaryData).
     inline ParticleProperty(const magnet::xml::Node& node):
       Property(Property::Units(node.getAttribute("Units").getValue())),
       _name(node.getAttribute("Name").getValue())
-    {
-      //Move up to the particles nodes, and start loading the property values
-      for (magnet::xml::Node pNode = node.getParent().getParent()
-	     .getNode("ParticleData").fastGetNode("Pt");
-	   pNode.valid(); ++pNode)
-	_values.push_back(pNode.getAttribute(_name).as<double>());
-    }
+    {}
   
     inline virtual const double& getProperty(size_t ID) const 
     { 
@@ -184,6 +201,31 @@ namespace dynamo {
 
     inline void outputParticleXMLData(magnet::xml::XmlStream& XML, const size_t pID) const
     { XML << magnet::xml::attr(_name) << getProperty(pID); }
+
+    inline virtual void loadParticleData(std::vector<double>& values)
+    { _values.swap(values); }
+
+    inline virtual void outputParticleBinaryData(std::ostream& os) const
+    { 
+      if (!_values.empty())
+	magnet::stream::writeBinary(os, &_values[0], _values.size()); 
+    }
+
+    inline virtual void loadParticleBinaryData(std::istream& is, const size_t N)
+    {
+      _values.resize(N);
+      if (N)
+	magnet::stream::readBinary(is, &_values[0], N);
+    }
+
+    inline virtual void reorderParticles(const std::vector<size_t>& order)
+    {
+      Container newValues;
+      newValues.reserve(order.size());
+      for (std::vector<size_t>::const_iterator it = order.begin(); it != order.end(); ++it)
+	newValues.push_back(_values.at(*it));
+      _values.swap(newValues);
+    }
   
   
   protected:
@@ -319,6 +361,16 @@ namespace dynamo {
 	(*iPtr)->rescaleUnit(dim, rescale);
     }
 
+    //! \brief Renumber the per-particle data of all Property-s.
+    //!
+    //! \param order The old ID of each particle, indexed by its new ID.
+    inline void reorderParticles(const std::vector<size_t>& order)
+    {
+      for (iterator iPtr = _namedProperties.begin(); 
+	   iPtr != _namedProperties.end(); ++iPtr)
+	(*iPtr)->reorderParticles(order);
+    }
+
     //! \brief Write any XML attributes relevent to Property-s for a single
     //! particle.
     //!
@@ -331,6 +383,46 @@ namespace dynamo {
 	(*iPtr)->outputParticleXMLData(XML, pID);
     }
 
+    //! \brief Load the per-particle data of all Property-s from the
+    //! values read from the Pt tags of an XML file.
+    //!
+    //! \param data The values of each Pt tag attribute, by name (see
+    //! ParticleDataLoader::getAttributeData).
+    //! \param N The number of particles.
+    inline void loadParticleData(std::map<std::string, std::vector<double> >& data, 
+				 const size_t N)
+    {
+      for (iterator iPtr = _namedProperties.begin(); 
+	   iPtr != _namedProperties.end(); ++iPtr)
+	{
+	  std::vector<double>& values = data[(*iPtr)->getName()];
+	  if (values.size() != N)
+	    M_throw() << "The property \"" << (*iPtr)->getName() 
+		      << "\" is missing from " << N - values.size() << " particles";
+	  (*iPtr)->loadParticleData(values);
+	}
+    }
+
+    //! \brief Write the per-particle data of all Property-s as raw
+    //! binary.
+    inline void outputParticleBinaryData(std::ostream& os) const 
+    {
+      for (const_iterator iPtr = _namedProperties.begin(); 
+	   iPtr != _namedProperties.end(); ++iPtr)
+	(*iPtr)->outputParticleBinaryData(os);
+    }
+
+    //! \brief Load the per-particle data written by
+    //! outputParticleBinaryData.
+    //!
+    //! \param N The number of particles.
+    inline void loadParticleBinaryData(std::istream& is, const size_t N)
+    {
+      for (iterator iPtr = _namedProperties.begin(); 
+	   iPtr != _namedProperties.end(); ++iPtr)
+	(*iPtr)->loadParticleBinaryData(is, N);
+    }
+
     /*! \brief Method for pushing constructed properties into the
      * PropertyStore.
      *
@@ -17,12 +17,14 @@
 
 #pragma once
 #include <tr1/memory>
+#include <vector>
 
 namespace magnet { namespace xml { class Node; class XmlStream; } }
 namespace dynamo { 
   using std::tr1::shared_ptr;
   class Simulation;
   class Particle;
+  class IDRange;
 
   class IDPairRange
   {
@@ -31,6 +33,20 @@ namespace dynamo {
  
     virtual bool isInRange(const Particle&, const Particle&) const = 0;
 
+    /*! \brief Collects the IDRange-s which decide if a pair is in
+        this range.
+
+      If membership of a pair only depends on which of the returned
+      IDRange-s each of the two particles is in, this returns
+      true. This allows the Simulation to precompute the Interaction
+      of whole classes of particles (see
+      Simulation::rebuildInteractionTable).
+
+      Ranges which depend on the IDs of the pair itself (e.g., chains
+      or lists of pairs) return false and must be tested pair by pair.
+     */
+    virtual bool getIDRanges(std::vector<shared_ptr<IDRange> >&) const { return false; }
+
     static IDPairRange* getClass(const magnet::xml::Node&, const dynamo::Simulation*);
     
     friend magnet::xml::XmlStream& operator<<(magnet::xml::XmlStream& XML,
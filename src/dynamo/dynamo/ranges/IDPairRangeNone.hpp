@@ -29,6 +29,8 @@ namespace dynamo {
     
     virtual bool isInRange(const Particle&, const Particle&) const
     { return false; }
+
+    virtual bool getIDRanges(std::vector<shared_ptr<IDRange> >&) const { return true; }
   
   protected:
     virtual void outputXML(magnet::xml::XmlStream& XML) const
@@ -53,6 +53,14 @@ namespace dynamo {
       return false;
     }
 
+    virtual bool getIDRanges(std::vector<shared_ptr<IDRange> >& idranges) const
+    {
+      BOOST_FOREACH(const shared_ptr<IDPairRange>& rPtr, ranges)
+	if (!rPtr->getIDRanges(idranges))
+	  return false;
+      return true;
+    }
+
     void addRange(IDPairRange* nRange)
     { ranges.push_back(shared_ptr<IDPairRange>(nRange)); }
   
@@ -41,6 +41,13 @@ namespace dynamo {
       return false;
     }
 
+    virtual bool getIDRanges(std::vector<shared_ptr<IDRange> >& ranges) const
+    { 
+      ranges.push_back(range1);
+      ranges.push_back(range2);
+      return true;
+    }
+
   protected:
 
     virtual void outputXML(magnet::xml::XmlStream& XML) const
@@ -134,4 +134,28 @@ namespace dynamo {
 
     return std::auto_ptr<IDRange>(new IDRangeList(nblist.getParticleLocals(part)));
   }
+
+  void
+  SNeighbourList::visitParticleNeighbours(const Particle& part, const nbHoodBlockFunc& func) const
+  {
+#ifdef DYNAMO_DEBUG
+    if (!std::tr1::dynamic_pointer_cast<GNeighbourList>(Sim->globals[NBListID]))
+      M_throw() << "Not a GNeighbourList!";
+#endif
+
+    static_cast<const GNeighbourList*>(Sim->globals[NBListID].get())
+      ->visitParticleNeighbours(part, func);
+  }
+
+  void
+  SNeighbourList::visitParticleLocals(const Particle& part, const nbHoodBlockFunc& func) const
+  {
+#ifdef DYNAMO_DEBUG
+    if (!std::tr1::dynamic_pointer_cast<GNeighbourList>(Sim->globals[NBListID]))
+      M_throw() << "Not a GNeighbourList!";
+#endif
+
+    static_cast<const GNeighbourList*>(Sim->globals[NBListID].get())
+      ->visitParticleLocals(part, func);
+  }
 }
@@ -32,6 +32,9 @@ namespace dynamo {
     virtual std::auto_ptr<IDRange> getParticleNeighbours(const Vector&) const;
     virtual std::auto_ptr<IDRange> getParticleLocals(const Particle&) const;
 
+    virtual void visitParticleNeighbours(const Particle&, const nbHoodBlockFunc&) const;
+    virtual void visitParticleLocals(const Particle&, const nbHoodBlockFunc&) const;
+
   protected:
     virtual void outputXML(magnet::xml::XmlStream&) const;
   
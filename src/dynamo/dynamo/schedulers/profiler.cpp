@@ -0,0 +1,154 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <dynamo/schedulers/profiler.hpp>
+#include <dynamo/simulation.hpp>
+#include <magnet/xmlwriter.hpp>
+#include <boost/foreach.hpp>
+
+namespace dynamo {
+  const char* 
+  EventProfiler::getPhaseName(EPhase phase)
+  {
+    switch (phase)
+      {
+      case EXECUTE: return "Execute";
+      case CELL:    return "Cell";
+      case PREDICT: return "Predict";
+      case SORT:    return "Sort";
+      case CLEANUP: return "Cleanup";
+      case OUTPUT:  return "Output";
+      default:
+	M_throw() << "Unknown profiler phase";
+      }
+  }
+
+  EventProfiler::EventProfiler(const dynamo::Simulation* tmp, const std::string csvFile):
+    SimBase_const(tmp, "EventProfiler"),
+    _sourceSet(false),
+    _lastTime(0),
+    _csvFile(csvFile)
+  {
+    for (size_t i(0); i < NPHASES; ++i)
+      _eventTimes[i] = 0;
+
+    if (!_csvFile.empty())
+      {
+	_csv.open(_csvFile.c_str());
+	if (!_csv.is_open())
+	  M_throw() << "Could not open the profiler CSV file " << _csvFile;
+
+	_csv << "Events,SystemTime,Wall";
+	for (size_t i(0); i < NPHASES; ++i)
+	  _csv << "," << getPhaseName(EPhase(i));
+	_csv << "\n";
+      }
+
+    dout << "Profiling the event loop" 
+	 << (_csvFile.empty() ? "" : ", writing the periodic profile to ")
+	 << _csvFile << std::endl;
+  }
+
+  void
+  EventProfiler::endEvent()
+  {
+    lap();
+
+    Record& record = _sourceSet ? _records[_source] : _totals;
+    if (_sourceSet)
+      {
+	++record.count;
+	++_totals.count;
+      }
+
+    for (size_t i(0); i < NPHASES; ++i)
+      {
+	if (_sourceSet) 
+	  record.times[i] += _eventTimes[i];
+	_totals.times[i] += _eventTimes[i];
+      }
+  }
+
+  std::string
+  EventProfiler::getSourceName(const Key& key) const
+  {
+    if (key.first.second == RECALCULATE)
+      return "Recalculate";
+
+    return EventTypeTracking::getName(key.first, Sim);
+  }
+
+  void
+  EventProfiler::periodicOutput()
+  {
+    if (!_csv.is_open()) return;
+
+    double wall(0);
+    for (size_t i(0); i < NPHASES; ++i)
+      wall += _totals.times[i];
+
+    _csv << Sim->eventCount << "," << Sim->systemTime / Sim->units.unitTime()
+	 << "," << wall;
+    for (size_t i(0); i < NPHASES; ++i)
+      _csv << "," << _totals.times[i];
+    _csv << std::endl;
+  }
+
+  void 
+  EventProfiler::output(magnet::xml::XmlStream& XML) const
+  {
+    double wall(0);
+    for (size_t i(0); i < NPHASES; ++i)
+      wall += _totals.times[i];
+
+    XML << magnet::xml::tag("Profile")
+	<< magnet::xml::attr("Events") << _totals.count
+	<< magnet::xml::attr("WallTime") << wall;
+    
+    for (size_t i(0); i < NPHASES; ++i)
+      XML << magnet::xml::tag("Phase")
+	  << magnet::xml::attr("Name") << getPhaseName(EPhase(i))
+	  << magnet::xml::attr("WallTime") << _totals.times[i]
+	  << magnet::xml::attr("Fraction") << (wall > 0 ? _totals.times[i] / wall : 0)
+	  << magnet::xml::endtag("Phase");
+
+    typedef std::pair<const Key, Record> locpair;
+    BOOST_FOREACH(const locpair& entry, _records)
+      {
+	double total(0);
+	for (size_t i(0); i < NPHASES; ++i)
+	  total += entry.second.times[i];
+
+	XML << magnet::xml::tag("Source")
+	    << magnet::xml::attr("Name") << getSourceName(entry.first)
+	    << magnet::xml::attr("Class") 
+	    << ((entry.first.first.second == RECALCULATE) ? std::string("Scheduler")
+		: EventTypeTracking::getClass(entry.first.first))
+	    << magnet::xml::attr("Event") << entry.first.second
+	    << magnet::xml::attr("Count") << entry.second.count
+	    << magnet::xml::attr("WallTime") << total
+	    << magnet::xml::attr("TimePerEvent") << total / entry.second.count;
+
+	for (size_t i(0); i < NPHASES; ++i)
+	  if (entry.second.times[i] > 0)
+	    XML << magnet::xml::attr(getPhaseName(EPhase(i))) << entry.second.times[i];
+
+	XML << magnet::xml::endtag("Source");
+      }
+
+    XML << magnet::xml::endtag("Profile");
+  }
+}
@@ -0,0 +1,181 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include <dynamo/base.hpp>
+#include <dynamo/outputplugins/eventtypetracking.hpp>
+#include <map>
+#include <vector>
+#include <fstream>
+#include <string>
+#include <time.h>
+
+namespace magnet { namespace xml { class XmlStream; } }
+
+namespace dynamo {
+  /*! \brief An opt-in profiler of the wall time spent in each phase
+      of the event loop (see Scheduler::runNextEvent).
+
+      The time of each executed event is split into the phases listed
+      in \ref EPhase and accumulated against the source of the event
+      (the Interaction, Local, Global or System which generated it)
+      and the type of the event (e.g., CORE or WELL_IN).
+
+      Phases may nest (e.g., the Interaction::runEvent of an event
+      calls Scheduler::fullUpdate), the time of a phase only counts
+      the time not spent in any nested phase. The instrumented code
+      holds a pointer to the profiler which is NULL when profiling is
+      disabled, so the overhead is then a single test per phase.
+   */
+  class EventProfiler: public dynamo::SimBase_const
+  {
+  public:
+    typedef enum
+      {
+	EXECUTE = 0, /*!< Executing the event, including re-predicting
+			it before it runs.*/
+	CELL,        /*!< Executing a neighbour list (cell crossing)
+		       event.*/
+	PREDICT,     /*!< Predicting new events (Scheduler::fullUpdate).*/
+	SORT,        /*!< Updating the sorter of the future event list.*/
+	CLEANUP,     /*!< Lazy deletion of invalid events.*/
+	OUTPUT,      /*!< The OutputPlugin callbacks.*/
+	NPHASES
+      } EPhase;
+
+    static const char* getPhaseName(EPhase);
+
+    /*! \brief Constructor.
+      
+      \param csvFile If not empty, a line of the cumulative phase
+      times is written to this file at each periodic output (see \ref
+      periodicOutput).
+     */
+    EventProfiler(const dynamo::Simulation*, const std::string csvFile = "");
+
+    //! \brief Mark the start of the processing of the next event.
+    inline void beginEvent()
+    {
+      _sourceSet = false;
+      _stack.clear();
+      _stack.push_back(EXECUTE);
+      for (size_t i(0); i < NPHASES; ++i)
+	_eventTimes[i] = 0;
+      _lastTime = now();
+    }
+
+    //! \brief Set the source and type of the event being processed.
+    inline void setSource(const EventTypeTracking::classKey& source, const EEventType type)
+    {
+      _source = Key(source, type);
+      _sourceSet = true;
+    }
+
+    //! \brief Mark the end of the processing of the event.
+    void endEvent();
+
+    //! \brief Start timing a (possibly nested) phase.
+    inline void enter(const EPhase phase)
+    {
+      lap();
+      _stack.push_back(phase);
+    }
+
+    //! \brief Stop timing the current phase.
+    inline void leave()
+    {
+      lap();
+      _stack.pop_back();
+    }
+
+    //! \brief Writes the accumulated profile to the output XML file.
+    void output(magnet::xml::XmlStream&) const;
+
+    //! \brief Writes a line of the cumulative phase times to the CSV file.
+    void periodicOutput();
+
+    /*! \brief A helper which times a phase for the duration of a
+        scope, and does nothing if the profiler is NULL.
+     */
+    class Scope
+    {
+    public:
+      inline Scope(EventProfiler* profiler, const EPhase phase):
+	_profiler(profiler)
+      { if (_profiler) _profiler->enter(phase); }
+
+      inline ~Scope() { if (_profiler) _profiler->leave(); }
+      
+    private:
+      EventProfiler* const _profiler;
+    };
+
+    /*! \brief A helper which marks the processing of an event for the
+        duration of a scope, and does nothing if the profiler is NULL.
+     */
+    class EventScope
+    {
+    public:
+      inline EventScope(EventProfiler* profiler):
+	_profiler(profiler)
+      { if (_profiler) _profiler->beginEvent(); }
+
+      inline ~EventScope() { if (_profiler) _profiler->endEvent(); }
+      
+    private:
+      EventProfiler* const _profiler;
+    };
+
+  protected:
+    typedef std::pair<EventTypeTracking::classKey, EEventType> Key;
+
+    struct Record
+    {
+      Record(): count(0) { for (size_t i(0); i < NPHASES; ++i) times[i] = 0; }
+      size_t count;
+      double times[NPHASES];
+    };
+
+    inline static double now()
+    {
+      timespec t;
+      clock_gettime(CLOCK_MONOTONIC, &t);
+      return double(t.tv_sec) + 1e-9 * double(t.tv_nsec);
+    }
+
+    //! \brief Add the time since the last lap to the current phase.
+    inline void lap()
+    {
+      const double t = now();
+      _eventTimes[_stack.back()] += t - _lastTime;
+      _lastTime = t;
+    }
+
+    std::string getSourceName(const Key&) const;
+
+    std::map<Key, Record> _records;
+    Record _totals;
+
+    Key _source;
+    bool _sourceSet;
+    std::vector<EPhase> _stack;
+    double _eventTimes[NPHASES];
+    double _lastTime;
+
+    std::string _csvFile;
+    std::ofstream _csv;
+  };
+}
@@ -25,16 +25,38 @@
 #include <dynamo/dynamics/dynamics.hpp>
 #include <dynamo/simulation.hpp>
 #include <dynamo/units/units.hpp>
+#include <dynamo/globals/neighbourList.hpp>
 
 #ifdef DYNAMO_DEBUG
-#include <dynamo/globals/neighbourList.hpp>
 #include <dynamo/NparticleEventData.hpp>
 #endif
 
+#include <magnet/thread/threadpool.hpp>
 #include <magnet/xmlwriter.hpp>
 #include <magnet/xmlreader.hpp>
 #include <boost/math/special_functions/fpclassify.hpp>
 
+namespace {
+  //! Pass the IDs of a range to a callback, in blocks held on the stack.
+  void visitRange(const dynamo::IDRange& ids, const dynamo::Scheduler::nbHoodBlockFunc& func)
+  {
+    size_t block[64];
+    size_t count(0);
+    BOOST_FOREACH(const size_t id, ids)
+      {
+	block[count++] = id;
+	if (count == 64)
+	  {
+	    func(block, block + count);
+	    count = 0;
+	  }
+      }
+
+    if (count)
+      func(block, block + count);
+  }
+}
+
 namespace dynamo {
   Scheduler::Scheduler(dynamo::Simulation* const tmp, const char * aName,
 			 FEL* nS):
@@ -57,15 +79,23 @@ namespace dynamo {
   {
     //Now, the scheduler is used to test the state of the system.
     dout << "Checking the simulation configuration for any errors" << std::endl;
+
+    //The pairs are first counted silently (in parallel), then the
+    //particles with invalid pairs are revisited in order to print
+    //the warnings, so the output does not depend on the threads.
+    Sim->dynamics->updateAllParticles();
+    std::vector<size_t> invalidPairs(Sim->N, 0);
+    runParallel(&Scheduler::countInvalidPairs, &invalidPairs);
+
     size_t warnings(0);
     for (size_t id1(0); id1 < Sim->particles.size(); ++id1)
       {
-	std::auto_ptr<IDRange> ids(getParticleNeighbours(Sim->particles[id1]));
-	BOOST_FOREACH(const size_t id2, *ids)
-	  if (id2 > id1)
-	    if (Sim->getInteraction(Sim->particles[id1], Sim->particles[id2])
-		->validateState(Sim->particles[id1], Sim->particles[id2], (warnings < 101)))
-	      ++warnings;
+	if (!invalidPairs[id1]) continue;
+
+	if (warnings < 101)
+	  validateParticle(id1, true);
+
+	warnings += invalidPairs[id1];
       }
     
     if (warnings > 100)
@@ -78,14 +108,21 @@ namespace dynamo {
   void
   Scheduler::rebuildList()
   {
+    if (Sim->N >= std::numeric_limits<uint32_t>::max())
+      M_throw() << "Too many particles for the 32 bit IDs of the Event class";
+
     sorter->clear();
     //The plus one is because system events are stored in the last heap;
     sorter->resize(Sim->N+1);
     eventCount.clear();
     eventCount.resize(Sim->N+1, 0);
 
-    BOOST_FOREACH(Particle& part, Sim->particles)
-      addEvents(part);
+    //Once every particle is up to date, predicting the events of a
+    //particle only writes to its own PEL. The particles can then be
+    //split over the threads, and as each PEL is filled in the same
+    //order the queue is identical for any number of threads.
+    Sim->dynamics->updateAllParticles();
+    runParallel(&Scheduler::addEventsRange, NULL);
   
     sorter->init();
 
@@ -97,22 +134,128 @@ namespace dynamo {
   Scheduler::addEvents(Particle& part)
   {  
     Sim->dynamics->updateParticle(part);
+    predictEvents(part, Sim->dynamics->particleSoAEnabled());
+  }
 
+  void 
+  Scheduler::predictEvents(const Particle& part, const bool batched) const
+  {  
     //Add the global events
     BOOST_FOREACH(const shared_ptr<Global>& glob, Sim->globals)
       if (glob->isInteraction(part))
 	sorter->push(glob->getEvent(part), part.getID());
   
+    const NeighbourVisitor visitor(*this, part);
+
     //Add the local cell events
+    visitParticleLocals(part, nbHoodBlockFunc(&visitor, &NeighbourVisitor::addLocalEvents));
+
+    //Now add the interaction events. The batched predictors stream
+    //the neighbours out of the structure-of-arrays copy of the
+    //particle data
+    if (batched)
+      {
+	_batchIDs.resize(Sim->interactions.size());
+	BOOST_FOREACH(std::vector<size_t>& list, _batchIDs)
+	  list.clear();
+
+	visitParticleNeighbours(part, nbHoodBlockFunc(&visitor, &NeighbourVisitor::binNeighbours));
+	addBatchedInteractionEvents(part);
+      }
+    else
+      visitParticleNeighbours(part, nbHoodBlockFunc(&visitor, &NeighbourVisitor::addInteractionEvents));
+  }
+
+  void
+  Scheduler::visitParticleNeighbours(const Particle& part, const nbHoodBlockFunc& func) const
+  {
+    std::auto_ptr<IDRange> ids(getParticleNeighbours(part));
+    visitRange(*ids, func);
+  }
+
+  void
+  Scheduler::visitParticleLocals(const Particle& part, const nbHoodBlockFunc& func) const
+  {
     std::auto_ptr<IDRange> ids(getParticleLocals(part));
-    
-    BOOST_FOREACH(const size_t id2, *ids)
-      addLocalEvent(part, id2);
+    visitRange(*ids, func);
+  }
+
+  void
+  Scheduler::NeighbourVisitor::addLocalEvents(const size_t* begin, const size_t* end) const
+  {
+    for (; begin != end; ++begin)
+      _sched.addLocalEvent(_part, *begin);
+  }
 
-    //Now add the interaction events
-    ids = getParticleNeighbours(part);
+  void
+  Scheduler::NeighbourVisitor::addInteractionEvents(const size_t* begin, const size_t* end) const
+  {
+    for (; begin != end; ++begin)
+      _sched.addInteractionEvent(_part, *begin);
+  }
+
+  void
+  Scheduler::NeighbourVisitor::binNeighbours(const size_t* begin, const size_t* end) const
+  {
+    const Simulation& sim(*_sched.Sim);
+    for (; begin != end; ++begin)
+      if (*begin != _part.getID())
+	_sched._batchIDs[sim.getInteraction(_part, sim.particles[*begin])->getID()]
+	  .push_back(*begin);
+  }
+
+  void
+  Scheduler::runParallel(void (Scheduler::*func)(size_t, size_t, std::vector<size_t>*),
+			 std::vector<size_t>* data)
+  {
+    if (!Sim->threads)
+      {
+	(this->*func)(0, Sim->N, data);
+	return;
+      }
+
+    //Several tasks per thread to balance the load
+    const size_t nTasks = 8 * std::max(Sim->threads->getThreadCount(), size_t(1));
+    const size_t stride = (Sim->N + nTasks - 1) / nTasks;
+
+    std::vector<magnet::function::Task*> tasks;
+    for (size_t start(0); start < Sim->N; start += stride)
+      tasks.push_back(magnet::function::Task::makeTask(func, this, start, 
+						       std::min(start + stride, Sim->N),
+						       data));
+
+    Sim->threads->queueTasks(tasks);
+    Sim->threads->wait();
+  }
+
+  void
+  Scheduler::addEventsRange(size_t start, size_t end, std::vector<size_t>*)
+  {
+    //The batched predictors use shared work space, so the scalar
+    //predictors are used here
+    for (size_t id(start); id < end; ++id)
+      predictEvents(Sim->particles[id], false);
+  }
+
+  void
+  Scheduler::countInvalidPairs(size_t start, size_t end, std::vector<size_t>* counts)
+  {
+    for (size_t id(start); id < end; ++id)
+      (*counts)[id] = validateParticle(id, false);
+  }
+
+  size_t
+  Scheduler::validateParticle(const size_t id1, const bool textoutput) const
+  {
+    size_t invalid(0);
+    std::auto_ptr<IDRange> ids(getParticleNeighbours(Sim->particles[id1]));
     BOOST_FOREACH(const size_t id2, *ids)
-      addInteractionEvent(part, id2);
+      if (id2 > id1)
+	if (Sim->getInteraction(Sim->particles[id1], Sim->particles[id2])
+	    ->validateState(Sim->particles[id1], Sim->particles[id2], textoutput))
+	  ++invalid;
+
+    return invalid;
   }
 
   shared_ptr<Scheduler>
@@ -180,7 +323,13 @@ namespace dynamo {
   void
   Scheduler::runNextEvent()
   {
-    sorter->sort();
+    EventProfiler* const profiler = Sim->profiler.get();
+    EventProfiler::EventScope eventScope(profiler);
+
+    {
+      EventProfiler::Scope scope(profiler, EventProfiler::SORT);
+      sorter->sort();
+    }
 
 #ifdef DYNAMO_DEBUG
     if (sorter->nextPELEmpty())
@@ -258,14 +407,21 @@ namespace dynamo {
 	  Particle& p2(Sim->particles[sorter->next_p2()]);
 
 	  //Ready the next event in the FEL
-	  sorter->popNextEvent();
-	  sorter->update(sorter->next_ID());
-	  sorter->sort();	
+	  {
+	    EventProfiler::Scope scope(profiler, EventProfiler::SORT);
+	    sorter->popNextEvent();
+	    sorter->update(sorter->next_ID());
+	    sorter->sort();	
+	  }
 	  lazyDeletionCleanup();
 
 	  //Now recalculate the FEL event
 	  Sim->dynamics->updateParticlePair(p1, p2);       
 	  IntEvent Event(Sim->getEvent(p1, p2));
+
+	  if (profiler)
+	    profiler->setSource(EventTypeTracking::classKey(Sim->getInteraction(p1, p2)->getID(), INTERACTION),
+				Event.getType());
 	
 #ifdef DYNAMO_DEBUG
 	  if (sorter->nextPELEmpty())
@@ -276,6 +432,9 @@ namespace dynamo {
 	      || ((Event.getdt() > sorter->next_dt()) 
 		  && (++_interactionRejectionCounter < rejectionLimit)))
 	    {
+	      if (profiler)
+		profiler->setSource(EventTypeTracking::classKey(Sim->getInteraction(p1, p2)->getID(), INTERACTION),
+				    RECALCULATE);
 	      this->fullUpdate(p1, p2);
 	      return;
 	    }
@@ -324,8 +483,16 @@ namespace dynamo {
 	  //optimise this (they dont need it).
 
 	  //We also don't recheck Global events! (Check, some events might rely on this behavior)
-	  Sim->globals[sorter->next_p2()]
-	    ->runEvent(Sim->particles[sorter->next_ID()], sorter->next_dt());       	
+	  const shared_ptr<Global>& glob = Sim->globals[sorter->next_p2()];
+
+	  if (profiler)
+	    profiler->setSource(EventTypeTracking::classKey(glob->getID(), GLOBAL), GLOBAL);
+
+	  //The neighbour list events are the cell crossings
+	  EventProfiler::Scope scope(profiler && std::tr1::dynamic_pointer_cast<GNeighbourList>(glob) 
+				     ? profiler : NULL, EventProfiler::CELL);
+
+	  glob->runEvent(Sim->particles[sorter->next_ID()], sorter->next_dt());
 	  break;	           
 	}
       case LOCAL:
@@ -336,14 +503,20 @@ namespace dynamo {
 	  size_t localID = sorter->next_p2();
 
 	  //Ready the next event in the FEL
-	  sorter->popNextEvent();
-	  sorter->update(sorter->next_ID());
-	  sorter->sort();
+	  {
+	    EventProfiler::Scope scope(profiler, EventProfiler::SORT);
+	    sorter->popNextEvent();
+	    sorter->update(sorter->next_ID());
+	    sorter->sort();
+	  }
 	  lazyDeletionCleanup();
 
 	  Sim->dynamics->updateParticle(part);
 	  LocalEvent iEvent(Sim->locals[localID]->getEvent(part));
 
+	  if (profiler)
+	    profiler->setSource(EventTypeTracking::classKey(localID, LOCAL), iEvent.getType());
+
 	  double next_dt = sorter->next_dt();
 
 	  //Check the recalculated event is valid and not later than
@@ -351,6 +524,8 @@ namespace dynamo {
 	  if ((iEvent.getType() == NONE)
 	      || ((iEvent.getdt() > next_dt) && (++_localRejectionCounter < rejectionLimit)))
 	    {
+	      if (profiler)
+		profiler->setSource(EventTypeTracking::classKey(localID, LOCAL), RECALCULATE);
 	      this->fullUpdate(part);
 	      return;
 	    }
@@ -379,6 +554,10 @@ namespace dynamo {
 	}
       case SYSTEM:
 	{
+	  if (profiler)
+	    profiler->setSource(EventTypeTracking::classKey(sorter->next_p2(), SYSTEM), 
+				Sim->systems[sorter->next_p2()]->getType());
+
 	  Sim->systems[sorter->next_p2()]
 	    ->runEvent();
 	  //This saves the system events rebuilding themselves
@@ -390,6 +569,10 @@ namespace dynamo {
 	  //This is a special event type which requires that the
 	  // events for this particle recalculated.
 	  size_t ID = sorter->next_ID();
+
+	  if (profiler)
+	    profiler->setSource(EventTypeTracking::classKey(0, RECALCULATE), RECALCULATE);
+
 	  this->fullUpdate(Sim->particles[ID]);
 	  break;
 	}
@@ -420,6 +603,25 @@ namespace dynamo {
       sorter->push(Event(eevent, eventCount[id]), part1.getID());
   }
 
+  void
+  Scheduler::addBatchedInteractionEvents(const Particle& part) const
+  {
+    for (size_t i(0); i < _batchIDs.size(); ++i)
+      {
+	const std::vector<size_t>& list(_batchIDs[i]);
+	if (list.empty()) continue;
+
+	_batchEvents.resize(list.size());
+	Sim->interactions[i]->getEvents(part, &list[0], &_batchEvents[0], 
+					list.size());
+
+	for (size_t j(0); j < list.size(); ++j)
+	  if (_batchEvents[j].getType() != NONE)
+	    sorter->push(Event(_batchEvents[j], eventCount[list[j]]), 
+			 part.getID());
+      }
+  }
+
   void 
   Scheduler::addLocalEvent(const Particle& part, 
 			   const size_t& id) const
@@ -431,9 +633,12 @@ namespace dynamo {
   void 
   Scheduler::lazyDeletionCleanup()
   {
+    EventProfiler::Scope scope(Sim->profiler.get(), EventProfiler::CLEANUP);
+
+    //The events only store the lower 32 bits of the event counter
     while ((sorter->next_type() == INTERACTION)
 	   && (sorter->next_collCounter2()
-	       != eventCount[sorter->next_p2()]))
+	       != static_cast<uint32_t>(eventCount[sorter->next_p2()])))
       {
 	//Not valid, update the list
 	sorter->popNextEvent();
@@ -18,6 +18,8 @@
 #pragma once
 #include <dynamo/base.hpp>
 #include <dynamo/schedulers/sorters/sorter.hpp>
+#include <dynamo/schedulers/profiler.hpp>
+#include <dynamo/simulation.hpp>
 #include <dynamo/interactions/intEvent.hpp>
 #include <dynamo/globals/globEvent.hpp>
 #include <magnet/function/delegate.hpp>
@@ -46,6 +48,7 @@ namespace dynamo {
      */
     inline void fullUpdate(Particle& part)
     {
+      EventProfiler::Scope scope(Sim->profiler.get(), EventProfiler::PREDICT);
       invalidateEvents(part);
       addEvents(part);
       sort(part);
@@ -99,16 +102,61 @@ namespace dynamo {
     void rebuildSystemEvents() const;
 
     void addInteractionEvent(const Particle&, const size_t&) const;
-    
+
     void addLocalEvent(const Particle&, const size_t&) const;
 
     virtual std::auto_ptr<IDRange> getParticleNeighbours(const Particle&) const = 0;
     virtual std::auto_ptr<IDRange> getParticleNeighbours(const Vector&) const = 0;
     virtual std::auto_ptr<IDRange> getParticleLocals(const Particle&) const = 0;
+
+    /*! \brief The type of function that is called back with each
+      block of IDs, [begin, end), by \ref visitParticleNeighbours.
+     */
+    typedef magnet::function::Delegate2
+    <const size_t*, const size_t*, void> nbHoodBlockFunc;
+
+    /*! \brief Pass the IDs of the neighbours of a particle to a
+        callback, in blocks.
+
+      This is used in place of \ref getParticleNeighbours on every
+      event, as it need not allocate memory. The default
+      implementation walks the range returned by \ref
+      getParticleNeighbours in fixed size blocks.
+     */
+    virtual void visitParticleNeighbours(const Particle&, const nbHoodBlockFunc&) const;
+
+    //! \brief As \ref visitParticleNeighbours, but for the Local event IDs.
+    virtual void visitParticleLocals(const Particle&, const nbHoodBlockFunc&) const;
     
     const std::vector<size_t>& getEventCounts() const { return eventCount; }
 
   protected:
+    /*! \brief The callbacks used to walk the neighbourhood of a
+        particle (see \ref visitParticleNeighbours).
+     */
+    struct NeighbourVisitor
+    {
+      NeighbourVisitor(const Scheduler& sched, const Particle& part):
+	_sched(sched), _part(part) {}
+
+      void addLocalEvents(const size_t* begin, const size_t* end) const;
+      void addInteractionEvents(const size_t* begin, const size_t* end) const;
+      //! Sort the neighbours into Scheduler::_batchIDs by their Interaction.
+      void binNeighbours(const size_t* begin, const size_t* end) const;
+
+      const Scheduler& _sched;
+      const Particle& _part;
+    };
+
+    /*! \brief Add the interaction events between a particle and the
+        neighbours sorted into \ref _batchIDs.
+
+	Each group of neighbours is tested with a single call to
+	Interaction::getEvents so that the batched (vectorised) event
+	predictors can be used.
+    */
+    void addBatchedInteractionEvents(const Particle&) const;
+
     /*! \brief Performs the lazy deletion algorithm to find the next
      * valid event in the queue.
      *
@@ -118,9 +166,39 @@ namespace dynamo {
      */
     void lazyDeletionCleanup();
 
+    /*! \brief Add the events of a particle to its PEL.
+
+      The particle must be up to date.
+      \param batched If true, the batched interaction event
+      predictors are used (see \ref addBatchedInteractionEvents). These
+      are not thread safe.
+     */
+    void predictEvents(const Particle&, const bool batched) const;
+
+    /*! \brief Split the particles into ranges and pass each range
+        to the member function, running them in the Simulation's
+        ThreadPool if it has one.
+     */
+    void runParallel(void (Scheduler::*)(size_t, size_t, std::vector<size_t>*),
+		     std::vector<size_t>*);
+
+    //! Add the events of the particles in the ID range [start, end).
+    void addEventsRange(size_t start, size_t end, std::vector<size_t>*);
+
+    //! Count the invalid pair states of the particles in the ID range [start, end).
+    void countInvalidPairs(size_t start, size_t end, std::vector<size_t>* counts);
+
+    //! Test the state of a particle with its (higher ID) neighbours.
+    size_t validateParticle(const size_t id, const bool textoutput) const;
+
     mutable shared_ptr<FEL> sorter;
     mutable std::vector<size_t> eventCount;
   
+    //! Work space for addBatchedInteractionEvents, holding the neighbour IDs for each Interaction.
+    mutable std::vector<std::vector<size_t> > _batchIDs;
+    //! Work space for addBatchedInteractionEvents.
+    mutable std::vector<IntEvent> _batchEvents;
+
     size_t _interactionRejectionCounter;
     size_t _localRejectionCounter;
 
@@ -23,6 +23,7 @@
 #include <dynamo/simulation.hpp>
 #include <boost/static_assert.hpp>
 #include <magnet/exception.hpp>
+#include <magnet/xmlwriter.hpp>
 #include <string>
 #include <vector>
 #include <cmath>
@@ -90,15 +91,26 @@ namespace dynamo {
     size_t NP, N;
     size_t exceptionCount;
 
+    //Statistics used to retune the queue online
+    size_t _windowLength;
+    size_t _windowSorts;
+    size_t _windowTreeSize;
+    size_t _windowSkipped;
+    size_t _windowExceptions;
+    size_t _retuneCount;
+
   public:  
     FELBoundedPQ(const dynamo::Simulation* const& SD):
       FEL(SD, "BoundedPQ"),
-      exceptionCount(0) 
-    {}
+      N(0),
+      exceptionCount(0),
+      _retuneCount(0)
+    { resetStatistics(); }
 
     ~FELBoundedPQ() 
     { 
-      dout << "Exception Events = " << exceptionCount << std::endl;
+      dout << "Exception Events = " << exceptionCount
+	   << ", Retunes = " << _retuneCount << std::endl;
     }
   
     inline size_t size() const { return Min.size() - 1; }
@@ -108,6 +120,18 @@ namespace dynamo {
     inline const double& scaleFactor() const { return scale; }
     inline const size_t& exceptionEvents() const { return exceptionCount; }
     inline const size_t& treeSize() const { return NP; }
+    inline const size_t& retuneCount() const { return _retuneCount; }
+
+    virtual void outputStatistics(magnet::xml::XmlStream& XML) const
+    {
+      XML << magnet::xml::tag("Sorter")
+	  << magnet::xml::attr("Type") << FELBoundedPQName<T>::name()
+	  << magnet::xml::attr("ExceptionEvents") << exceptionCount
+	  << magnet::xml::attr("Retunes") << _retuneCount
+	  << magnet::xml::attr("NLists") << nlists
+	  << magnet::xml::attr("ScaleFactor") << scale * Sim->units.unitTime()
+	  << magnet::xml::endtag("Sorter");
+    }
 
     inline std::vector<size_t> getEventCounts() const
     {
@@ -241,6 +265,7 @@ namespace dynamo {
 	     << scale * Sim->units.unitTime() 
 	     << std::endl;
 
+      linearLists.clear();
       linearLists.resize(nlists+1, -1); /*+1 for overflow, -1 for
 					  marking empty*/ 
 
@@ -261,6 +286,7 @@ namespace dynamo {
     
       //Find the next event and place it first so nextEventID() works
       orderNextEvent();
+      resetStatistics();
       if (!quiet)
 	dout << "Ready for simulation." << std::endl;
     }
@@ -322,7 +348,14 @@ namespace dynamo {
     //inline const T& next_Data() const { return Min[CBT[1]].data; }
     inline double next_dt() const { return Min[CBT[1]].data.getdt() - pecTime; }
 
-    inline void sort() { orderNextEvent(); }
+    inline void sort()
+    {
+      orderNextEvent();
+
+      _windowTreeSize += NP;
+      if (++_windowSorts >= _windowLength)
+	checkTuning();
+    }
 
     inline void rescaleTimes(const double& factor)
     {
@@ -337,6 +370,70 @@ namespace dynamo {
     }
 
   private:
+    inline void resetStatistics()
+    {
+      _windowLength = std::max(N, size_t(1000));
+      resetWindow();
+    }
+
+    inline void resetWindow()
+    {
+      _windowSorts = 0;
+      _windowTreeSize = 0;
+      _windowSkipped = 0;
+      _windowExceptions = exceptionCount;
+    }
+
+    /*! \brief Check if the scale of the queue has drifted away from
+        the event rate, and rebuild the queue if it has.
+
+	The scale is set when the queue is built so that, on average,
+	a few events fall in each linear list. If the event rate
+	changes (e.g., during a compression run, or as a system
+	relaxes from its initial configuration) the scale is no longer
+	appropriate. If the lists are too wide, the binary tree of the
+	current list becomes large; too narrow and many empty lists
+	are skipped and events frequently end up in the overflow
+	list. If any of these are observed over a window of sorts, the
+	scale and number of lists are re-derived from the current
+	event times and the lists rebuilt. The cost of a rebuild is
+	O(N), so it is amortised over the window of O(N) events.
+     */
+    inline void checkTuning()
+    {
+      const double meanTreeSize = double(_windowTreeSize) / _windowSorts;
+      const double skippedPerSort = double(_windowSkipped) / _windowSorts;
+      const size_t exceptions = exceptionCount - _windowExceptions;
+
+      if ((meanTreeSize < 32) && (skippedPerSort < 32)
+	  && (exceptions < _windowSorts / 4))
+	{
+	  resetWindow();
+	  return;
+	}
+
+      ++_retuneCount;
+      const double oldScale = scale;
+
+      //Make the stored event times relative to the current time
+      //again, as they are when the queue is first built.
+      BOOST_FOREACH(eventQEntry& dat, Min)
+	dat.data.stream(pecTime);
+      pecTime = 0;
+
+      NP = 0;
+      currentIndex = 0;
+      const size_t windowLength = _windowLength;
+      init(true);
+
+      //If the scale has hardly changed, then the distribution of
+      //events is the cause and not the scale. Back off to avoid
+      //repeatedly rebuilding the queue.
+      if ((scale < 2 * oldScale) && (scale > 0.5 * oldScale))
+	_windowLength = 2 * windowLength;
+      resetWindow();
+    }
+
     ///////////////////////////BOUNDED QUEUE IMPLEMENTATION
     inline void insertInEventQ(int p)
     {
@@ -412,6 +509,7 @@ namespace dynamo {
 	{
 	  /*The current priority queue is exhausted, move on to the
 	    next one*/
+	  ++_windowSkipped;
 
 	  /* change current calendar "date" */
 	  if(++currentIndex==nlists)
@@ -0,0 +1,443 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <dynamo/schedulers/sorters/event.hpp>
+#include <dynamo/schedulers/sorters/sorter.hpp>
+#include <dynamo/schedulers/sorters/heapPEL.hpp>
+#include <dynamo/units/units.hpp>
+#include <dynamo/simulation.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/lexical_cast.hpp>
+#include <magnet/exception.hpp>
+#include <magnet/xmlwriter.hpp>
+#include <string>
+#include <vector>
+#include <cmath>
+
+#ifdef DYNAMO_DEBUG
+#include <boost/math/special_functions/fpclassify.hpp>
+#endif
+
+namespace dynamo {
+  template<size_t Size>
+  class PELMinMax;
+
+  class PELSingleEvent;
+
+  template<class T>
+  struct FELCalendarName
+  {
+    BOOST_STATIC_ASSERT(sizeof(T) == 0);
+  };
+
+  template<>
+  struct FELCalendarName<PELHeap>
+  {
+    inline static std::string name() { return "Calendar"; }
+  };
+
+  template<size_t I>
+  struct FELCalendarName<PELMinMax<I> >
+  {
+    inline static std::string name() { return std::string("CalendarMinMax") + boost::lexical_cast<std::string>(I); }
+  };
+
+  template<>
+  struct FELCalendarName<PELSingleEvent>
+  {
+    inline static std::string name() { return "CalendarSingleEvent"; }
+  };
+
+  /*! \brief An adaptive calendar queue Future Event List.
+
+      Each Particle Event List (PEL) is filed in a "day" (bucket) of
+      a calendar "year" according to the time of its next
+      event. Buckets are unsorted doubly linked lists, so inserting
+      and deleting a PEL (\ref update) is O(1). The next event is
+      found by scanning the current day, which is also O(1) provided
+      the day width is tuned so that only a few PELs are in each day.
+
+      PELs which fall after the current year are kept in an overflow
+      list, which is re-filed when the year wraps. At the same time
+      the stored event times are shifted by the length of the year
+      (in the same manner as the \ref FELBoundedPQ), to keep the
+      stored times small.
+
+      The day width is initially set from the spread of the event
+      times. The queue then monitors the number of PELs examined per
+      search and the number of empty days skipped, and if either
+      grows too large the day width is halved or doubled and the
+      calendar rebuilt. This keeps the queue efficient when the event
+      rate drifts (e.g., during compression).
+   */
+  template<typename T = PELHeap>
+  class FELCalendar: public FEL
+  {
+  private:
+    struct eventQEntry
+    {
+      T data;
+      int next;
+      int previous;
+      int qIndex;
+    };
+
+    std::vector<eventQEntry> Min;
+    std::vector<int> _days;
+
+    size_t N;
+    int _ndays;
+    int _currentDay;
+    double _dayWidth;
+    double pecTime;
+
+    //! The PEL holding the next event, only valid if _nextValid
+    int _nextID;
+    bool _nextValid;
+
+    //Statistics used to tune the day width
+    size_t _searches;
+    size_t _scanned;
+    size_t _skipped;
+
+    //Lifetime statistics
+    size_t _exceptionCount;
+    size_t _resizeCount;
+
+  public:
+    FELCalendar(const dynamo::Simulation* const& SD):
+      FEL(SD, "Calendar"),
+      N(0),
+      _exceptionCount(0),
+      _resizeCount(0)
+    { clear(); }
+
+    ~FELCalendar()
+    {
+      dout << "Exception Events = " << _exceptionCount
+	   << ", Calendar resizes = " << _resizeCount << std::endl;
+    }
+
+    inline size_t size() const { return Min.size(); }
+    inline bool empty() const { return Min.empty(); }
+
+    inline const int& NDays() const { return _ndays; }
+    inline const double& dayWidth() const { return _dayWidth; }
+    inline const size_t& exceptionEvents() const { return _exceptionCount; }
+    inline const size_t& resizeCount() const { return _resizeCount; }
+
+    virtual void outputStatistics(magnet::xml::XmlStream& XML) const
+    {
+      XML << magnet::xml::tag("Sorter")
+	  << magnet::xml::attr("Type") << FELCalendarName<T>::name()
+	  << magnet::xml::attr("ExceptionEvents") << _exceptionCount
+	  << magnet::xml::attr("Resizes") << _resizeCount
+	  << magnet::xml::attr("NDays") << _ndays
+	  << magnet::xml::attr("DayWidth") << _dayWidth / Sim->units.unitTime()
+	  << magnet::xml::endtag("Sorter");
+    }
+
+    void resize(const size_t& a)
+    {
+      clear();
+      N = a;
+      Min.resize(N);
+    }
+
+    void clear()
+    {
+      Min.clear();
+      _days.clear();
+      N = 0;
+      _ndays = 0;
+      _currentDay = 0;
+      _dayWidth = 1;
+      pecTime = 0.0;
+      _nextID = 0;
+      _nextValid = false;
+      resetStatistics();
+    }
+
+    inline void stream(const double& ndt) { pecTime += ndt; }
+
+    void init() { init(false); }
+
+    void rebuild() { init(true); }
+
+    void init(bool quiet)
+    {
+      double minVal(HUGE_VAL), maxVal(-HUGE_VAL);
+      size_t counter(0);
+
+      //Instrument the queue to determine the day width, aiming for
+      //roughly one PEL per day
+      BOOST_FOREACH(const eventQEntry& dat, Min)
+	if (!std::isinf(dat.data.getdt()))
+	  {
+	    minVal = std::min(minVal, dat.data.getdt());
+	    maxVal = std::max(maxVal, dat.data.getdt());
+	    ++counter;
+	  }
+
+      _ndays = std::max(size_t(1000), N);
+
+      if ((counter < 10) || !(maxVal > minVal))
+	{
+	  derr <<
+	    "The event queue doesn't have more than 10 VALID events in it"
+	    "\nThis means the queue cannot be instrumented properly to"
+	    "\ndetermine the optimal day width for the calendar, now"
+	    "\nusing a (probably inefficient) default. The calendar will"
+	    "\nadapt as the simulation runs."
+	       << std::endl;
+	  _dayWidth = 0.1;
+	}
+      else
+	_dayWidth = (maxVal - minVal) / counter;
+
+      if (!quiet)
+	dout << "Number of days = " << _ndays
+	     << ", Day width = " << _dayWidth / Sim->units.unitTime()
+	     << std::endl;
+
+      fileAllEvents();
+
+      if (!quiet)
+	dout << "Ready for simulation." << std::endl;
+    }
+
+    inline void push(const Event& tmpVal, const size_t& pID)
+    {
+#ifdef DYNAMO_DEBUG
+      if (boost::math::isnan(tmpVal.dt))
+	M_throw() << "NaN value pushed into the sorter! Should be Inf I guess?";
+#endif
+
+      tmpVal.dt += pecTime;
+      Min[pID].data.push(tmpVal);
+    }
+
+    inline void update(const size_t& pID)
+    {
+      const int p(pID);
+      deleteFromEventQ(p);
+      insertInEventQ(p);
+
+      if (_nextValid)
+	{
+	  if (p == _nextID)
+	    _nextValid = false;
+	  else if (Min[p].data < Min[_nextID].data)
+	    _nextID = p;
+	}
+    }
+
+    inline void clearPEL(const size_t& ID) { Min[ID].data.clear(); }
+    inline void popNextPELEvent(const size_t& ID) { Min[ID].data.pop(); }
+    inline void popNextEvent() { Min[_nextID].data.pop(); }
+    inline bool nextPELEmpty() const { return Min[_nextID].data.empty(); }
+
+    inline Event copyNextEvent() const
+    {
+      Event retval(Min[_nextID].data.top());
+      retval.dt -= pecTime;
+      return retval;
+    }
+
+    inline size_t next_ID() const { return _nextID; }
+    inline EEventType next_type() const { return Min[_nextID].data.top().type; }
+    inline unsigned long next_collCounter2() const { return Min[_nextID].data.top().collCounter2; }
+    inline size_t next_p2() const { return Min[_nextID].data.top().p2; }
+    inline double next_dt() const { return Min[_nextID].data.getdt() - pecTime; }
+
+    inline void sort()
+    {
+      if (!_nextValid)
+	orderNextEvent();
+    }
+
+    inline void rescaleTimes(const double& factor)
+    {
+      BOOST_FOREACH(eventQEntry& dat, Min)
+	dat.data.rescaleTimes(factor);
+
+      //Scaling the day width too leaves every PEL in its current day
+      pecTime *= factor;
+      _dayWidth *= factor;
+    }
+
+  private:
+    inline void resetStatistics()
+    {
+      _searches = 0;
+      _scanned = 0;
+      _skipped = 0;
+    }
+
+    //! Clear the days and file every PEL into the calendar again.
+    inline void fileAllEvents()
+    {
+      _days.clear();
+      _days.resize(_ndays + 1, -1); //+1 for overflow, -1 for marking empty
+      _currentDay = 0;
+      _nextValid = false;
+      resetStatistics();
+
+      for (int i(0); i < static_cast<int>(N); ++i)
+	insertInEventQ(i);
+
+      if (N) orderNextEvent();
+    }
+
+    inline void insertInEventQ(const int& p)
+    {
+      const double day = Min[p].data.getdt() / _dayWidth;
+
+      //Events before the current day (e.g., negative time events) are
+      //filed in the current day, events after this year overflow
+      int i = (day >= _ndays) ? _ndays : std::max(_currentDay, static_cast<int>(day));
+
+      Min[p].qIndex = i;
+      Min[p].previous = -1;
+      Min[p].next = _days[i];
+      if (_days[i] != -1)
+	Min[_days[i]].previous = p;
+      _days[i] = p;
+    }
+
+    inline void deleteFromEventQ(const int& e)
+    {
+      const int prev = Min[e].previous, next = Min[e].next;
+
+      if (prev == -1)
+	_days[Min[e].qIndex] = next;
+      else
+	Min[prev].next = next;
+
+      if (next != -1)
+	Min[next].previous = prev;
+    }
+
+    /*! \brief Move the calendar on by a year, shifting all of the
+        event times and re-filing the overflow list.
+     */
+    inline void wrapYear()
+    {
+      const double yearLength = _ndays * _dayWidth;
+      BOOST_FOREACH(eventQEntry& dat, Min)
+	dat.data.stream(yearLength);
+      pecTime -= yearLength;
+      _currentDay = 0;
+
+      int e = _days[_ndays];
+      _days[_ndays] = -1;
+      while (e != -1)
+	{
+	  const int eNext = Min[e].next;
+	  insertInEventQ(e);
+	  if (Min[e].qIndex != _ndays)
+	    ++_exceptionCount;
+	  e = eNext;
+	}
+    }
+
+    inline void orderNextEvent()
+    {
+      ++_searches;
+
+      for (;;)
+	{
+	  for (; _currentDay < _ndays; ++_currentDay, ++_skipped)
+	    if (_days[_currentDay] != -1)
+	      {
+		//Scan the current day for the earliest event
+		int best = _days[_currentDay];
+		for (int e = Min[best].next; e != -1; e = Min[e].next)
+		  {
+		    ++_scanned;
+		    if (Min[e].data < Min[best].data)
+		      best = e;
+		  }
+
+		_nextID = best;
+		_nextValid = true;
+		tuneCalendar();
+		return;
+	      }
+
+	  //The year is exhausted
+	  bool finiteOverflow(false);
+	  for (int e = _days[_ndays]; e != -1; e = Min[e].next)
+	    if (!std::isinf(Min[e].data.getdt()))
+	      {
+		finiteOverflow = true;
+		break;
+	      }
+
+	  if (!finiteOverflow)
+	    {
+	      //Only infinite time events remain, any will do
+	      _nextID = _days[_ndays];
+	      _nextValid = true;
+	      return;
+	    }
+
+	  wrapYear();
+	}
+    }
+
+    /*! \brief Halve or double the day width if the calendar is
+        performing badly.
+
+	Too many PELs scanned per search means the days are too wide,
+	too many empty days skipped means they are too narrow.
+     */
+    inline void tuneCalendar()
+    {
+      if (_searches < N) return;
+
+      const double scannedPerSearch = double(_scanned) / _searches;
+      const double skippedPerSearch = double(_skipped) / _searches;
+
+      double factor(1);
+      if (scannedPerSearch > 8)
+	factor = 0.5;
+      else if (skippedPerSearch > 8)
+	factor = 2;
+      else
+	{
+	  resetStatistics();
+	  return;
+	}
+
+      ++_resizeCount;
+
+      //The current day becomes the start of the new year
+      const double shift = _currentDay * _dayWidth;
+      BOOST_FOREACH(eventQEntry& dat, Min)
+	dat.data.stream(shift);
+      pecTime -= shift;
+
+      _dayWidth *= factor;
+      fileAllEvents();
+    }
+
+    virtual void outputXML(magnet::xml::XmlStream& XML) const
+    { XML << magnet::xml::attr("Type") << FELCalendarName<T>::name(); }
+  };
+}
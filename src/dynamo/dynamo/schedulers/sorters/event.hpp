@@ -22,7 +22,10 @@
 #include <dynamo/locals/localEvent.hpp>
 #include <dynamo/globals/global.hpp>
 #include <boost/foreach.hpp>
+#include <boost/static_assert.hpp>
 #include <algorithm>
+#include <limits>
+#include <stdint.h>
 
 namespace dynamo {
   /*! \brief A generic event type, which the more specialised events
@@ -36,46 +39,53 @@ namespace dynamo {
       events cause the system to be moved forward in time and the
       events for the particle are recalculated. This can all be
       handled by the scheduler.
+
+      Millions of these are stored in the event lists, so the record
+      is packed into 24 bytes. The partner/Local/Global ID and the
+      event counter of the partner are stored in 32 bits, and the type
+      in 8 bits. The event counter is
+      only ever compared for equality against the (truncated) event
+      counter of the partner particle, so it may safely wrap around.
    */
   class Event
   {
   public:   
     inline Event():
       dt(HUGE_VAL),
-      collCounter2(std::numeric_limits<unsigned long>::max()),
-      type(NONE),
-      p2(std::numeric_limits<size_t>::max())    
+      collCounter2(std::numeric_limits<uint32_t>::max()),
+      p2(std::numeric_limits<uint32_t>::max()),
+      type(NONE)
     {}
 
     inline Event(const double& ndt, const EEventType& nT, 
 		 const size_t& nID2, const unsigned long & nCC2) throw():
       dt(ndt),
       collCounter2(nCC2),
-      type(nT),
-      p2(nID2)
+      p2(nID2),
+      type(nT)
     {}
 
     inline Event(const IntEvent& coll, const unsigned long& nCC2) throw():
       dt(coll.getdt()),
       collCounter2(nCC2),
-      type(INTERACTION),
-      p2(coll.getParticle2ID())
+      p2(coll.getParticle2ID()),
+      type(INTERACTION)
     {
       if (coll.getType() == RECALCULATE) type = RECALCULATE;
     }
 
     inline Event(const GlobalEvent& coll) throw():
       dt(coll.getdt()),
-      type(GLOBAL),
-      p2(coll.getGlobalID())
+      p2(coll.getGlobalID()),
+      type(GLOBAL)
     {
       if (coll.getType() == RECALCULATE) type = RECALCULATE;
     }
 
     inline Event(const LocalEvent& coll) throw():
       dt(coll.getdt()),
-      type(LOCAL),
-      p2(coll.getLocalID())
+      p2(coll.getLocalID()),
+      type(LOCAL)
     {
       if (coll.getType() == RECALCULATE) type = RECALCULATE;
     }
@@ -89,8 +99,10 @@ namespace dynamo {
     inline void stream(const double& ndt) throw() { dt -= ndt; }
 
     mutable double dt;
-    unsigned long collCounter2;
-    EEventType type;
-    size_t p2;  
+    uint32_t collCounter2;
+    uint32_t p2;
+    EEventType type : 8;
   };
+
+  BOOST_STATIC_ASSERT(sizeof(Event) <= 24);
 }
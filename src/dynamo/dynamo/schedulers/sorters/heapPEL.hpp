@@ -17,36 +17,69 @@
 
 #pragma once
 #include <dynamo/schedulers/sorters/event.hpp>
-#include <queue>
+#include <algorithm>
+#include <functional>
+#include <vector>
 
 namespace dynamo {
-  typedef std::vector<Event> qType;
-  typedef std::priority_queue<Event, qType, 
-			      std::greater<Event> > PELHeap_q_type;
-  class PELHeap: public PELHeap_q_type
+  /*! \brief A Particle Event List which stores every event of a
+      particle in a binary heap.
+
+      Most particles only have a few events at any one time, so the
+      first \ref InlineSize events are stored in the PEL itself. The
+      PELs are stored contiguously in the Future Event Lists, so this
+      avoids a heap allocation per particle and the associated cache
+      miss whenever the next event of a PEL is examined. If more
+      events are pushed, the heap overflows into a std::vector, which
+      is used until the PEL is cleared.
+   */
+  class PELHeap
   {
   public:
-    typedef qType::iterator CRanIt;
-    typedef qType::iterator iterator;
-    typedef qType::const_iterator const_iterator;
-    typedef std::iterator_traits<CRanIt>::difference_type CDiff;
+    static const size_t InlineSize = 4;
+
+    typedef Event* iterator;
+    typedef const Event* const_iterator;
+
+    PELHeap(): _size(0) {}
+
+    PELHeap(const PELHeap& other):
+      _size(other._size),
+      _overflow(other._overflow)
+    { std::copy(other._inline, other._inline + InlineSize, _inline); }
+
+    inline PELHeap& operator=(const PELHeap& other)
+    {
+      _size = other._size;
+      _overflow = other._overflow;
+      std::copy(other._inline, other._inline + InlineSize, _inline);
+      return *this;
+    }
   
-    inline iterator begin() { return c.begin(); }
-    inline const_iterator begin() const { return c.begin(); }
-    inline iterator end() { return c.end(); }
-    inline const_iterator end() const { return c.end(); }
+    inline iterator begin() { return data(); }
+    inline const_iterator begin() const { return data(); }
+    inline iterator end() { return data() + _size; }
+    inline const_iterator end() const { return data() + _size; }
+
+    inline size_t size() const { return _size; }
+    inline bool empty() const { return !_size; }
+
+    inline const Event& top() const { return *data(); }
 
     inline void clear()
-    { c.clear(); }
+    { 
+      _size = 0;
+      _overflow.clear();
+    }
 
     inline bool operator> (const PELHeap& ip) const throw()
     { 
       //If the other is empty this can never be longer
       //If this is empty and the other isn't its always longer
       //Otherwise compare
-      return (ip.c.empty()) 
+      return (ip.empty()) 
 	? false
-	: (empty() || (c.front().dt > ip.c.front().dt)); 
+	: (empty() || (top().dt > ip.top().dt)); 
     }
 
     inline bool operator< (const PELHeap& ip) const throw()
@@ -56,42 +89,70 @@ namespace dynamo {
       //Otherwise compare
       return (empty()) 
 	? false 
-	: (ip.c.empty() || (c.front().dt < ip.c.front().dt)); 
+	: (ip.empty() || (top().dt < ip.top().dt)); 
     }
 
     inline double getdt() const 
     { 
-      return (c.empty()) ? HUGE_VAL : c.front().dt; 
+      return (empty()) ? HUGE_VAL : top().dt; 
     }
   
     inline void stream(const double& ndt) throw()
     {
-      BOOST_FOREACH(Event& dat, c)
+      BOOST_FOREACH(Event& dat, *this)
 	dat.dt -= ndt;
     }
 
     inline void addTime(const double& ndt) throw()
     {
-      BOOST_FOREACH(Event& dat, c)
+      BOOST_FOREACH(Event& dat, *this)
 	dat.dt += ndt;
     }
 
     inline void push(const Event& __x)
     {
-      c.push_back(__x);
-      std::push_heap(c.begin(), c.end(), comp);
+      if (_overflow.empty() && (_size < InlineSize))
+	_inline[_size] = __x;
+      else
+	{
+	  //Move the heap out of the inline storage
+	  if (_overflow.empty())
+	    _overflow.assign(_inline, _inline + _size);
+	  _overflow.push_back(__x);
+	}
+
+      ++_size;
+      std::push_heap(begin(), end(), std::greater<Event>());
+    }
+
+    inline void pop()
+    {
+      std::pop_heap(begin(), end(), std::greater<Event>());
+      --_size;
+      if (!_overflow.empty())
+	_overflow.pop_back();
     }
 
     inline void rescaleTimes(const double& scale) throw()
     { 
-      BOOST_FOREACH(Event& dat, c)
+      BOOST_FOREACH(Event& dat, *this)
 	dat.dt *= scale;
     }
 
     inline void swap(PELHeap& rhs)
     {
-      c.swap(rhs.c);
+      std::swap_ranges(_inline, _inline + InlineSize, rhs._inline);
+      std::swap(_size, rhs._size);
+      _overflow.swap(rhs._overflow);
     }
+
+  private:
+    inline Event* data() { return _overflow.empty() ? _inline : &_overflow[0]; }
+    inline const Event* data() const { return _overflow.empty() ? _inline : &_overflow[0]; }
+
+    Event _inline[InlineSize];
+    size_t _size;
+    std::vector<Event> _overflow;
   };
 }
 
@@ -17,5 +17,6 @@
 
 #include <dynamo/schedulers/sorters/cbt.hpp>
 #include <dynamo/schedulers/sorters/boundedPQ.hpp>
+#include <dynamo/schedulers/sorters/calendar.hpp>
 #include <dynamo/schedulers/sorters/MinMaxHeap.hpp>
 #include <dynamo/schedulers/sorters/SingleEvent.hpp>
@@ -46,6 +46,12 @@ namespace dynamo {
       return shared_ptr<FEL>(new FELBoundedPQ<PELMinMax<7> >(Sim));
     if (std::string(XML.getAttribute("Type")) == FELBoundedPQName<PELMinMax<8> >::name())
       return shared_ptr<FEL>(new FELBoundedPQ<PELMinMax<8> >(Sim));
+    if (std::string(XML.getAttribute("Type")) == FELCalendarName<PELHeap>::name())
+      return shared_ptr<FEL>(new FELCalendar<>(Sim));
+    if (std::string(XML.getAttribute("Type")) == FELCalendarName<PELSingleEvent>::name())
+      return shared_ptr<FEL>(new FELCalendar<PELSingleEvent>(Sim));
+    if (std::string(XML.getAttribute("Type")) == FELCalendarName<PELMinMax<3> >::name())
+      return shared_ptr<FEL>(new FELCalendar<PELMinMax<3> >(Sim));
     else if (std::string(XML.getAttribute("Type")) == std::string("CBT"))
       return shared_ptr<FEL>(new FELCBT(Sim));
     else 
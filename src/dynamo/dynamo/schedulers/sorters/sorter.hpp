@@ -68,6 +68,9 @@ namespace dynamo {
     //! Fetch the next event in the list, 
     virtual Event   copyNextEvent() const               = 0;
 
+    //! Write any statistics collected by the sorter to the output file.
+    virtual void outputStatistics(magnet::xml::XmlStream&) const {}
+
     static shared_ptr<FEL>
     getClass(const magnet::xml::Node&, const dynamo::Simulation*);
 
@@ -27,21 +27,56 @@
 #include <dynamo/topology/topology.hpp>
 #include <dynamo/globals/global.hpp>
 #include <dynamo/interactions/interaction.hpp>
+#include <dynamo/interactions/captures.hpp>
 #include <dynamo/outputplugins/0partproperty/misc.hpp>
 #include <dynamo/globals/PBCSentinel.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/iostreams/device/file.hpp>
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/filter/bzip2.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
 #include <boost/iostreams/chain.hpp>
-#include <boost/iostreams/device/back_inserter.hpp>
-#include <boost/iostreams/copy.hpp>
 #include <dynamo/BC/BC.hpp>
+#include <dynamo/ranges/IDRange.hpp>
+#include <dynamo/schedulers/profiler.hpp>
+#include <dynamo/outputplugins/pipeline.hpp>
+#include <dynamo/particleDataLoader.hpp>
+#include <dynamo/fileCompression.hpp>
+#include <magnet/stream/binary.hpp>
 #include <iomanip>
+#include <sstream>
+#include <map>
 
 //! The configuration file version, a version mismatch prevents an XML file load.
 static const std::string configFileVersion("1.5.0");
 
+//! The first (and last) bytes of a binary configuration file.
+static const char binaryConfigMagic[8] = {'D', 'y', 'n', 'a', 'm', 'O', 'B', 'C'};
+
+//! The binary configuration file layout version.
+static const uint32_t binaryConfigVersion(1);
+
+//! Written in the byte order of the machine, to detect binary
+//! configuration files written on a machine of different endianness.
+static const uint32_t binaryConfigByteOrder(0x01020304);
+
+//! Test if a file name is for a binary configuration file.
+static inline bool isBinaryConfig(const std::string& fileName)
+{ 
+  return dynamo::hasExtension(fileName, ".bin") 
+    || dynamo::hasExtension(fileName, ".bin.bz2")
+    || dynamo::hasExtension(fileName, ".bin.gz");
+}
+
+//! Test the marker bytes of a binary configuration file.
+static void checkBinaryConfigMagic(std::istream& is)
+{
+  char magic[8];
+  magnet::stream::readBinary(is, magic, 8);
+  if (!std::equal(magic, magic + 8, binaryConfigMagic))
+    M_throw() << "Not a binary configuration file, or the file is truncated or corrupt";
+}
+
 namespace dynamo
 {
   Simulation::Simulation():
@@ -59,9 +94,13 @@ namespace dynamo
     lastRunMFT(0.0),
     simID(0),
     replexExchangeNumber(0),
-    status(START)
+    threads(NULL),
+    status(START),
+    _particleClassCount(0)
   {}
 
+  const size_t Simulation::noInteraction;
+
   namespace {
     /*! \brief Hidden functor used for sorting containers of
         shared_ptr's holiding OutputPlugin classes.
@@ -141,6 +180,10 @@ namespace dynamo
     {
       size_t ID=0;
       
+      //The capture maps of the Interactions are built using the
+      //look-up table, so it is built first
+      rebuildInteractionTable();
+
       BOOST_FOREACH(shared_ptr<Interaction>& ptr, interactions)
 	ptr->initialise(ID++);
 
@@ -195,6 +238,9 @@ namespace dynamo
     BOOST_FOREACH(shared_ptr<OutputPlugin> & Ptr, outputPlugins)
       Ptr->initialise();
 
+    if (outputPipeline)
+      outputPipeline->initialise();
+
     _nextPrint = eventCount + eventPrintInterval;
     status = INITIALISED;
   }
@@ -202,11 +248,7 @@ namespace dynamo
   IntEvent 
   Simulation::getEvent(const Particle& p1, const Particle& p2) const
   {
-    BOOST_FOREACH(const shared_ptr<Interaction>& ptr, interactions)
-      if (ptr->isInteraction(p1,p2))
-	return ptr->getEvent(p1,p2);
-    
-    M_throw() << "Could not find the right interaction to test for";
+    return getInteraction(p1, p2)->getEvent(p1, p2);
   }
 
   void 
@@ -235,11 +277,109 @@ namespace dynamo
   const shared_ptr<Interaction>&
   Simulation::getInteraction(const Particle& p1, const Particle& p2) const 
   {
+    //Fall back to a linear search if the table is not available
+    if (_interactionTable.empty()
+	|| (p1.getID() >= _particleClass.size())
+	|| (p2.getID() >= _particleClass.size()))
+      {
+	BOOST_FOREACH(const shared_ptr<Interaction>& ptr, interactions)
+	  if (ptr->isInteraction(p1,p2))
+	    return ptr;
+	
+	M_throw() << "Could not find the interaction requested";
+      }
+
+    const InteractionDispatch& entry
+      = _interactionTable[_particleClass[p1.getID()] * _particleClassCount 
+			  + _particleClass[p2.getID()]];
+
+    BOOST_FOREACH(const size_t& intID, entry.tests)
+      if (interactions[intID]->isInteraction(p1, p2))
+	return interactions[intID];
+
+#ifdef DYNAMO_DEBUG
     BOOST_FOREACH(const shared_ptr<Interaction>& ptr, interactions)
       if (ptr->isInteraction(p1,p2))
-	return ptr;
-  
-    M_throw() << "Could not find the interaction requested";
+	{
+	  if ((entry.match == noInteraction) || (ptr != interactions[entry.match]))
+	    M_throw() << "The Interaction look-up table disagrees with the Interaction ranges for particles " 
+		      << p1.getID() << " and " << p2.getID();
+	  break;
+	}
+#endif
+
+    if (entry.match == noInteraction)
+      M_throw() << "Could not find the interaction requested";
+
+    return interactions[entry.match];
+  }
+
+  void
+  Simulation::rebuildInteractionTable()
+  {
+    _particleClass.clear();
+    _particleClassCount = 0;
+    _interactionTable.clear();
+
+    //Collect the IDRanges which the regular Interaction ranges depend
+    //on, the other ranges are tested pair by pair
+    std::vector<shared_ptr<IDRange> > idranges;
+    std::vector<bool> regular(interactions.size());
+    for (size_t intID(0); intID < interactions.size(); ++intID)
+      {
+	std::vector<shared_ptr<IDRange> > ranges;
+	regular[intID] = interactions[intID]->getRange()->getIDRanges(ranges);
+	if (regular[intID])
+	  idranges.insert(idranges.end(), ranges.begin(), ranges.end());
+      }
+
+    //Sort the particles into classes by the IDRanges they are in
+    typedef std::map<std::vector<bool>, size_t> ClassMap;
+    ClassMap classes;
+    std::vector<size_t> representative;
+    _particleClass.resize(N);
+    BOOST_FOREACH(const Particle& part, particles)
+      {
+	std::vector<bool> signature(idranges.size());
+	for (size_t i(0); i < idranges.size(); ++i)
+	  signature[i] = idranges[i]->isInRange(part);
+
+	std::pair<ClassMap::iterator, bool> 
+	  it = classes.insert(ClassMap::value_type(signature, classes.size()));
+	if (it.second)
+	  representative.push_back(part.getID());
+	_particleClass[part.getID()] = it.first->second;
+      }
+
+    //Each ID range can at most double the number of classes. If
+    //there are too many classes the table is not worth building.
+    static const size_t maxClasses = 256;
+    if (classes.size() > maxClasses)
+      {
+	derr << "Too many particle classes (" << classes.size() 
+	     << ") for an Interaction look-up table, using a linear search" << std::endl;
+	_particleClass.clear();
+	return;
+      }
+
+    _particleClassCount = classes.size();
+    _interactionTable.resize(_particleClassCount * _particleClassCount);
+    for (size_t c1(0); c1 < _particleClassCount; ++c1)
+      for (size_t c2(0); c2 < _particleClassCount; ++c2)
+	{
+	  InteractionDispatch& entry = _interactionTable[c1 * _particleClassCount + c2];
+	  entry.match = noInteraction;
+	  const Particle& p1 = particles[representative[c1]];
+	  const Particle& p2 = particles[representative[c2]];
+	  for (size_t intID(0); intID < interactions.size(); ++intID)
+	    if (!regular[intID])
+	      entry.tests.push_back(intID);
+	    else if (interactions[intID]->isInteraction(p1, p2))
+	      {
+		entry.match = intID;
+		break;
+	      }
+	}
   }
 
   const shared_ptr<Species>& 
@@ -282,29 +422,59 @@ namespace dynamo
     
     namespace io = boost::iostreams;
     
-    dout << "Reading the XML input file into memory" << std::endl;
+    dout << "Reading the input file" << std::endl;
     if (!boost::filesystem::exists(fileName))
       M_throw() << "Could not find the XML file named " << fileName
 		<< "\nPlease check the file exists.";
-    { //This scopes out the file objects
-      
-      //We use the boost iostreams library to load the file into a
-      //string which may be compressed.
+
+    //We use the boost iostreams library to load the file into a
+    //string which may be compressed.
       
-      //We make our filtering iostream
-      io::filtering_istream inputFile;
+    //We make our filtering iostream
+    io::filtering_istream inputFile;
       
-      //Now check if we should add a decompressor filter
-      if (std::string(fileName.end()-8, fileName.end()) == ".xml.bz2")
-	inputFile.push(io::bzip2_decompressor());
-      else if (!(std::string(fileName.end()-4, fileName.end()) == ".xml"))
-	M_throw() << "Unrecognized extension for xml file";
-
-      //Finally, add the file as a source
-      inputFile.push(io::file_source(fileName));
-	  
-      io::copy(inputFile, io::back_inserter(doc.getStoredXMLData()));
-    }
+    //Now check if we should add a decompressor filter
+    if (hasExtension(fileName, ".xml.bz2") || hasExtension(fileName, ".bin.bz2"))
+      inputFile.push(io::bzip2_decompressor());
+    else if (hasExtension(fileName, ".xml.gz") || hasExtension(fileName, ".bin.gz"))
+      inputFile.push(io::gzip_decompressor());
+    else if (!hasExtension(fileName, ".xml") && !hasExtension(fileName, ".bin"))
+      M_throw() << "Unrecognized extension for xml file";
+
+    //Finally, add the file as a source
+    inputFile.push(io::file_source(fileName, std::ios_base::in | std::ios_base::binary));
+
+    const bool binary = isBinaryConfig(fileName);
+    ParticleDataLoader particleData(this);
+
+    if (binary)
+      {
+	//Only the XML header is read here, the particle data follows
+	//it in the file and is read once the Simulation is built
+	checkBinaryConfigMagic(inputFile);
+
+	uint32_t version, byteOrder;
+	magnet::stream::readBinary(inputFile, version);
+	magnet::stream::readBinary(inputFile, byteOrder);
+
+	if (version != binaryConfigVersion)
+	  M_throw() << "Unsupported binary configuration file version " << version
+		    << ", the current version is " << binaryConfigVersion;
+
+	if (byteOrder != binaryConfigByteOrder)
+	  M_throw() << "The binary configuration file was written on a machine with a different byte order"
+		    << "\nPlease convert it to XML on the original machine.";
+
+	uint64_t headerLength;
+	magnet::stream::readBinary(inputFile, headerLength);
+	std::string& header = doc.getStoredXMLData();
+	header.resize(headerLength);
+	magnet::stream::readBinary(inputFile, &header[0], headerLength);
+      }
+    else
+      //The particle data is parsed as the file is decompressed, only
+      //the rest of the file is kept for the DOM parser
+      particleData.load(inputFile, doc.getStoredXMLData());
 
     dout << "Parsing the raw XML" << std::endl;
     doc.parseData();
@@ -331,6 +501,10 @@ namespace dynamo
       {}
 
     _properties << mainNode;
+    
+    if (!binary)
+      _properties.loadParticleData(particleData.getAttributeData(), 
+				   particleData.getParticles().size());
 
     //Load the Primary cell's size
     primaryCellSize << simNode.getNode("SimulationSize");
@@ -385,7 +559,14 @@ namespace dynamo
 
     ptrScheduler = Scheduler::getClass(simNode.getNode("Scheduler"), this);
 
-    dynamics->loadParticleXMLData(mainNode);
+    if (binary)
+      {
+	dynamics->loadParticleBinaryData(mainNode, inputFile);
+	_properties.loadParticleBinaryData(inputFile, N);
+	checkBinaryConfigMagic(inputFile);
+      }
+    else
+      dynamics->loadParticleXMLData(mainNode, particleData);
   
     //Fixes or conversions once system is loaded
     lastRunMFT *= units.unitTime();
@@ -411,12 +592,25 @@ namespace dynamo
     namespace io = boost::iostreams;
     io::filtering_ostream coutputFile;
 
-    if (std::string(fileName.end()-4, fileName.end()) == ".bz2")
-      coutputFile.push(io::bzip2_compressor());
-  
-    coutputFile.push(io::file_sink(fileName));
+    pushCompressor(coutputFile, fileName, threads);
+    coutputFile.push(io::file_sink(fileName, std::ios_base::out | std::ios_base::binary));
+
+    writeXMLfile(coutputFile, isBinaryConfig(fileName), applyBC, round);
+
+    dout << "Config written to " << fileName << std::endl;
+  }
+
+  void
+  Simulation::writeXMLfile(std::ostream& coutputFile, bool binary, bool applyBC, bool round)
+  {
+    if (status < INITIALISED || status == ERROR)
+      M_throw() << "Cannot write out configuration in this state";
+
+    //The XML header of a binary file is written to a string first,
+    //as its length is stored ahead of it
+    std::ostringstream header;
   
-    magnet::xml::XmlStream XML(coutputFile);
+    magnet::xml::XmlStream XML(binary ? static_cast<std::ostream&>(header) : coutputFile);
     XML.setFormatXML(true);
 
     dynamics->updateAllParticles();
@@ -434,7 +628,10 @@ namespace dynamo
     XML << std::scientific
       //This has a minus one due to the digit in front of the decimal
       //An extra one is added if we're rounding
-	<< std::setprecision(std::numeric_limits<double>::digits10 - 1 - round)
+	<< std::setprecision(binary 
+			     //The header of the binary files is written at full precision
+			     ? std::numeric_limits<double>::digits10 + 1
+			     : std::numeric_limits<double>::digits10 - 1 - round)
 	<< magnet::xml::prolog() << magnet::xml::tag("DynamOconfig")
 	<< magnet::xml::attr("version") << configFileVersion
 	<< magnet::xml::tag("Simulation");
@@ -507,11 +704,28 @@ namespace dynamo
 	<< magnet::xml::endtag("Simulation")
 	<< _properties;
 
-    dynamics->outputParticleXMLData(XML, applyBC);
+    if (binary)
+      dynamics->outputParticleBinaryHeader(XML);
+    else
+      dynamics->outputParticleXMLData(XML, applyBC);
 
     XML << magnet::xml::endtag("DynamOconfig");
 
-    dout << "Config written to " << fileName << std::endl;
+    if (binary)
+      {
+	const std::string headerData(header.str());
+	magnet::stream::writeBinary(coutputFile, binaryConfigMagic, 8);
+	magnet::stream::writeBinary(coutputFile, binaryConfigVersion);
+	magnet::stream::writeBinary(coutputFile, binaryConfigByteOrder);
+	magnet::stream::writeBinary(coutputFile, uint64_t(headerData.size()));
+	magnet::stream::writeBinary(coutputFile, headerData.data(), headerData.size());
+
+	dynamics->outputParticleBinaryData(coutputFile, applyBC);
+	_properties.outputParticleBinaryData(coutputFile);
+
+	//The marker is repeated to detect truncated files
+	magnet::stream::writeBinary(coutputFile, binaryConfigMagic, 8);
+      }
 
     //Rescale the properties back to the simulation units
     _properties.rescaleUnit(Property::Units::L, 
@@ -528,10 +742,68 @@ namespace dynamo
   Simulation::signalParticleUpdate
   (const NEventData& pdat) const
   {
+    dynamics->updateParticleSoA(pdat);
+
     BOOST_FOREACH(const particleUpdateFunc& func, _particleUpdateNotify)
       func(pdat);
   }
 
+  void
+  Simulation::reorderParticles(const std::vector<size_t>& order)
+  {
+    if (order.size() != N)
+      M_throw() << "The particle ordering has " << order.size() 
+		<< " entries but there are " << N << " particles";
+
+    {
+      std::vector<bool> found(N, false);
+      BOOST_FOREACH(const size_t& oldID, order)
+	{
+	  if ((oldID >= N) || found[oldID])
+	    M_throw() << "The particle ordering is not a permutation of the particle IDs";
+	  found[oldID] = true;
+	}
+    }
+
+    //The queued event records refer to the old IDs
+    if (outputPipeline)
+      outputPipeline->flush();
+
+    //Get all particles up to date and zero the pecTimes
+    dynamics->updateAllParticles();
+
+    std::vector<Particle> newParticles;
+    newParticles.reserve(N);
+    for (size_t newID(0); newID < N; ++newID)
+      {
+	newParticles.push_back(particles[order[newID]]);
+	newParticles.back()._ID = newID;
+      }
+    particles.swap(newParticles);
+
+    //The particle classes of the Interaction look-up table depend on the IDs
+    rebuildInteractionTable();
+
+    _properties.reorderParticles(order);
+
+    dynamics->reorderParticles(order);
+
+    BOOST_FOREACH(shared_ptr<Interaction>& ptr, interactions)
+      ptr->reorderParticles(order);
+
+    BOOST_FOREACH(shared_ptr<Global>& ptr, globals)
+      ptr->reorderParticles(order);
+
+    BOOST_FOREACH(shared_ptr<System>& ptr, systems)
+      ptr->reorderParticles(order);
+
+    BOOST_FOREACH(shared_ptr<OutputPlugin>& ptr, outputPlugins)
+      ptr->reorderParticles(order);
+
+    //All of the events refer to the old IDs
+    ptrScheduler->rebuildList();
+  }
+
   void 
   Simulation::replexerSwap(Simulation& other)
   {
@@ -568,6 +840,18 @@ namespace dynamo
       part.getVelocity() *= scale2;
     
     ptrScheduler->rescaleTimes(scale2);
+
+    if (dynamics->particleSoAEnabled())
+      {
+	BOOST_FOREACH(const Particle& part, particles)
+	  dynamics->updateParticleSoA(part);
+      }
+
+    if (other.dynamics->particleSoAEnabled())
+      {
+	BOOST_FOREACH(const Particle& part, other.particles)
+	  other.dynamics->updateParticleSoA(part);
+      }
     
     ptrScheduler->rebuildSystemEvents();
     other.ptrScheduler->rebuildSystemEvents();    
@@ -691,6 +975,13 @@ namespace dynamo
       for (iPtr2 = iPtr1 + 1; iPtr2 != particles.end(); ++iPtr2)
 	getInteraction(*iPtr1, *iPtr2)->validateState(*iPtr1, *iPtr2);
 
+    BOOST_FOREACH(const shared_ptr<Interaction>& ptr, interactions)
+      if (const ICapture* capture = dynamic_cast<const ICapture*>(ptr.get()))
+	if (const size_t differences = capture->checkCaptureMap())
+	  derr << "The capture map of Interaction \"" << ptr->getName()
+	       << "\" differs from the configuration for " << differences
+	       << " pairs" << std::endl;
+
     BOOST_FOREACH(const Particle& part, particles)
       BOOST_FOREACH(const shared_ptr<Local>& lcl, locals)
       if (lcl->isInteraction(part))
@@ -706,24 +997,81 @@ namespace dynamo
     namespace io = boost::iostreams;
     io::filtering_ostream coutputFile;
   
-    if (std::string(filename.end()-4, filename.end()) == ".bz2")
-      coutputFile.push(io::bzip2_compressor());
-  
+    pushCompressor(coutputFile, filename, threads);
     coutputFile.push(io::file_sink(filename));
-  
+
+    outputData(coutputFile);
+
+    dout << "Output written to " << filename << std::endl;
+  }
+
+  void
+  Simulation::outputData(std::ostream& coutputFile)
+  {
+    if (status < INITIALISED || status == ERROR)
+      M_throw() << "Cannot output data when not initialised!";
+
     magnet::xml::XmlStream XML(coutputFile);
     XML.setFormatXML(true);
   
     XML << std::setprecision(std::numeric_limits<double>::digits10)
 	<< magnet::xml::prolog() << magnet::xml::tag("OutputData");
   
+    if (outputPipeline)
+      outputPipeline->flush();
+
     //Output the data and delete the outputplugins
     BOOST_FOREACH(shared_ptr<OutputPlugin> & Ptr, outputPlugins)
       Ptr->output(XML);
+
+    if (profiler)
+      profiler->output(XML);
   
     XML << magnet::xml::endtag("OutputData");
+  }
 
-    dout << "Output written to " << filename << std::endl;
+  void
+  Simulation::eventUpdate(const IntEvent& event, const PairEventData& data) const
+  {
+    EventProfiler::Scope scope(profiler.get(), EventProfiler::OUTPUT);
+    if (outputPipeline)
+      outputPipeline->eventUpdate(event, data);
+
+    BOOST_FOREACH(const shared_ptr<OutputPlugin>& Ptr, outputPlugins)
+      Ptr->eventUpdate(event, data);
+  }
+
+  void
+  Simulation::eventUpdate(const GlobalEvent& event, const NEventData& data) const
+  {
+    EventProfiler::Scope scope(profiler.get(), EventProfiler::OUTPUT);
+    if (outputPipeline)
+      outputPipeline->eventUpdate(event, data);
+
+    BOOST_FOREACH(const shared_ptr<OutputPlugin>& Ptr, outputPlugins)
+      Ptr->eventUpdate(event, data);
+  }
+
+  void
+  Simulation::eventUpdate(const LocalEvent& event, const NEventData& data) const
+  {
+    EventProfiler::Scope scope(profiler.get(), EventProfiler::OUTPUT);
+    if (outputPipeline)
+      outputPipeline->eventUpdate(event, data);
+
+    BOOST_FOREACH(const shared_ptr<OutputPlugin>& Ptr, outputPlugins)
+      Ptr->eventUpdate(event, data);
+  }
+
+  void
+  Simulation::eventUpdate(const System& event, const NEventData& data, const double& dt) const
+  {
+    EventProfiler::Scope scope(profiler.get(), EventProfiler::OUTPUT);
+    if (outputPipeline)
+      outputPipeline->eventUpdate(event, data, dt);
+
+    BOOST_FOREACH(const shared_ptr<OutputPlugin>& Ptr, outputPlugins)
+      Ptr->eventUpdate(event, data, dt);
   }
 
   void 
@@ -777,9 +1125,15 @@ namespace dynamo
 	//Periodic work
 	if ((eventCount >= _nextPrint) && !silentMode && outputPlugins.size())
 	  {
+	    if (outputPipeline)
+	      outputPipeline->flush();
+
 	    //Print the screen data plugins
 	    BOOST_FOREACH(shared_ptr<OutputPlugin> & Ptr, outputPlugins)
 	      Ptr->periodicOutput();
+
+	    if (profiler)
+	      profiler->periodicOutput();
 	    
 	    _nextPrint = eventCount + eventPrintInterval;
 	    std::cout << std::endl;
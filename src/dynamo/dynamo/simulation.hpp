@@ -30,6 +30,8 @@
 #include <boost/random/normal_distribution.hpp>
 #include <vector>
 
+namespace magnet { namespace thread { class ThreadPool; } }
+
 namespace dynamo
 {  
   class Scheduler;
@@ -45,6 +47,8 @@ namespace dynamo
   class Global;
   class GlobalEvent;
   class System;
+  class EventProfiler;
+  class OutputPipeline;
 
   class NEventData;
   class PairEventData;
@@ -66,6 +70,29 @@ namespace dynamo
     } ESimulationStatus;
   
   typedef boost::mt19937 baseRNG;
+
+  /*! \brief Permute a container of per-particle data after the
+      particles have been renumbered (see
+      Simulation::reorderParticles).
+
+      Empty containers (e.g., of an uninitialised class) are left
+      unchanged.
+   */
+  template<class T>
+  inline void reorderParticleData(std::vector<T>& data, const std::vector<size_t>& order)
+  {
+    if (data.empty()) return;
+
+    if (data.size() != order.size())
+      M_throw() << "Cannot reorder per-particle data of size " << data.size() 
+		<< " for " << order.size() << " particles";
+
+    std::vector<T> newData;
+    newData.reserve(order.size());
+    BOOST_FOREACH(const size_t& oldID, order)
+      newData.push_back(data[oldID]);
+    data.swap(newData);
+  }
   
   /*! \brief Fundamental collection of the Simulation data.
    
@@ -139,6 +166,23 @@ namespace dynamo
     IntEvent getEvent(const Particle& p1, const Particle& p2) const;
     double getLongestInteraction() const;
 
+    /*! \brief Rebuilds the look-up table used by getInteraction to
+        find the Interaction of a pair of particles.
+
+      The particles are split into classes, where every particle of a
+      class is in the same IDRange-s of the Interaction
+      ranges. Ranges which only depend on these IDRange-s (see
+      IDPairRange::getIDRanges) then apply to all pairs of two
+      classes, so the Interaction of most pairs is a single table
+      look-up. Any Interaction with a range which depends on the
+      particle IDs (e.g., bonds in chains) is still tested pair by
+      pair, but only for the classes it precedes a match in.
+
+      This is called by initialise() and must be called again if the
+      Interactions or their ranges are altered afterwards.
+     */
+    void rebuildInteractionTable();
+
     Container<Local> locals;
 
     Container<Global> globals;
@@ -218,11 +262,20 @@ namespace dynamo
     */
     void outputData(std::string filename = "output.xml.bz2");
 
+    /*! \brief Writes the results of the Simulation as uncompressed
+        XML to the passed stream.
+
+      This allows the results to be rendered into memory and written
+      out later (see \ref SSnapshot).
+    */
+    void outputData(std::ostream& os);
+
     /*! \brief Loads a Simulation from the passed XML file.
 
       \param filename The path to the XML file to load. The filename
      must end in either ".xml" for uncompressed xml files or ".bz2"
-     for bzip2 compressed configuration files.
+     for bzip2 compressed configuration files. Binary configuration
+     files (see \ref writeXMLfile) end in ".bin" or ".bin.bz2".
     */
     void loadXMLfile(std::string filename);
     
@@ -233,13 +286,31 @@ namespace dynamo
       either ".xml" for uncompressed xml files or ".bz2" for bzip2
       compressed configuration files.
 
+      If the filename ends in ".bin" (or ".bin.bz2"), a binary
+      configuration file is written instead. This is an XML header,
+      holding everything but the particle data, followed by the raw
+      particle and per-particle Property data (see \ref
+      Dynamics::outputParticleBinaryData). These files are much
+      faster to read and write and store the data exactly, but they
+      can only be read on a machine with the same byte order.
+
       \param round If true, the data in the XML file will be written
       out at 2 s.f. lower precision to round all the values. This is
       used in the test harness to remove rounding error ready for a
-      comparison to a "correct" configuration file.
+      comparison to a "correct" configuration file. It has no effect
+      on binary files.
     */
     void writeXMLfile(std::string filename, bool applyBC = true, bool round = false);
 
+    /*! \brief Writes the Simulation configuration to the passed
+        stream.
+
+      No compression is applied, the stream receives the contents of
+      an ".xml" file (or a ".bin" file if binary is true). See \ref
+      writeXMLfile(std::string, bool, bool) for the other parameters.
+    */
+    void writeXMLfile(std::ostream& os, bool binary, bool applyBC = true, bool round = false);
+
     /*! \brief The Ensemble of the Simulation. */
     shared_ptr<Ensemble> ensemble;
 
@@ -335,6 +406,34 @@ namespace dynamo
      */
     std::vector<shared_ptr<OutputPlugin> > outputPlugins; 
 
+    //! \brief Pass an Interaction event to all of the OutputPlugin-s.
+    void eventUpdate(const IntEvent&, const PairEventData&) const;
+
+    //! \brief Pass a Global event to all of the OutputPlugin-s.
+    void eventUpdate(const GlobalEvent&, const NEventData&) const;
+
+    //! \brief Pass a Local event to all of the OutputPlugin-s.
+    void eventUpdate(const LocalEvent&, const NEventData&) const;
+
+    //! \brief Pass a System event to all of the OutputPlugin-s.
+    void eventUpdate(const System&, const NEventData&, const double&) const;
+
+    /*! \brief The profiler of the event loop.
+
+      This is NULL (the default) unless profiling has been requested.
+     */
+    shared_ptr<EventProfiler> profiler;
+
+    /*! \brief The pipeline running the OPBatched plugins on a
+        separate thread.
+
+      This is NULL (the default) unless asynchronous output has been
+      requested, in which case the plugins are processed as events
+      occur. It is declared after the outputPlugins so that it is
+      destroyed (and drained) first.
+     */
+    shared_ptr<OutputPipeline> outputPipeline;
+
     /*! \brief The mean free time of the previous simulation run
      
       This is zero in the case that there is no previous simulation
@@ -356,6 +455,15 @@ namespace dynamo
      */
     size_t replexExchangeNumber;
 
+    /*! \brief The ThreadPool available to parallelise the
+        initialisation of the Simulation.
+
+      This is NULL (the default) if the Simulation must not use any
+      threads, e.g., when the Simulation itself is being run in the
+      ThreadPool by the EReplicaExchangeSimulation engine.
+     */
+    magnet::thread::ThreadPool* threads;
+
     /*! \brief The current phase of the Simulation.
      */
     ESimulationStatus status;
@@ -372,6 +480,17 @@ namespace dynamo
     void signalParticleUpdate(const NEventData&) const;
 
     void replexerSwap(Simulation&);
+
+    /*! \brief Renumber the particles of the Simulation.
+
+      The particles, and all of the per-particle data held by the
+      Properties, Dynamics, Interactions, Globals and OutputPlugins
+      are permuted, then the event list is rebuilt.
+
+      \param order The old ID of each particle, indexed by its new
+      ID. This must be a permutation of the particle IDs.
+     */
+    void reorderParticles(const std::vector<size_t>& order);
     
     boost::signals2::signal<void (size_t)>& particle_added_signal()
     { return _particleAddedToSim; }
@@ -380,6 +499,25 @@ namespace dynamo
     { return _particleRemovedFromSim; }
 
   private:    
+    /*! \brief An entry of the Interaction look-up table for a pair
+        of particle classes (see rebuildInteractionTable).
+     */
+    struct InteractionDispatch
+    {
+      //! Interactions which must be tested pair by pair, in order.
+      std::vector<size_t> tests;
+      //! The Interaction of all other pairs (or noInteraction).
+      size_t match;
+    };
+
+    static const size_t noInteraction = ~size_t(0);
+
+    //! The class of each particle in the Interaction look-up table.
+    std::vector<size_t> _particleClass;
+    size_t _particleClassCount;
+    //! The Interaction look-up table, indexed by the pair of classes.
+    std::vector<InteractionDispatch> _interactionTable;
+
     mutable std::vector<particleUpdateFunc> _particleUpdateNotify;
     mutable boost::signals2::signal<void (size_t)> _particleAddedToSim;
     mutable boost::signals2::signal<void (size_t)> _particleRemovedFromSim;
@@ -32,6 +32,12 @@ namespace dynamo {
 
     virtual void initialise(size_t);
 
+    virtual void getIDRanges(std::vector<shared_ptr<IDRange> >& ranges) const
+    {
+      ranges.push_back(range1);
+      ranges.push_back(range2);
+    }
+
     virtual void operator<<(const magnet::xml::Node&);
 
   protected:
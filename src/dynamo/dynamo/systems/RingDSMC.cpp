@@ -87,8 +87,7 @@ namespace dynamo {
 
     dt = tstep;
 
-    BOOST_FOREACH(shared_ptr<OutputPlugin>& Ptr, Sim->outputPlugins)
-      Ptr->eventUpdate(*this, NEventData(), locdt);
+    Sim->eventUpdate(*this, NEventData(), locdt);
 
     //////////////////// T(1,2) operator
     double Event;
@@ -128,8 +127,7 @@ namespace dynamo {
 	    
 	      Sim->ptrScheduler->fullUpdate(p1, p2);
 	    
-	      BOOST_FOREACH(shared_ptr<OutputPlugin>& Ptr, Sim->outputPlugins)
-		Ptr->eventUpdate(*this, SDat, 0.0);
+	      Sim->eventUpdate(*this, SDat, 0.0);
 	    }
 	}
     }
@@ -180,9 +178,7 @@ namespace dynamo {
 	    
 	      Sim->ptrScheduler->fullUpdate(p1, p2);
 	    
-	      BOOST_FOREACH(shared_ptr<OutputPlugin>& Ptr, 
-			     Sim->outputPlugins)
-		Ptr->eventUpdate(*this, SDat, 0.0);
+	      Sim->eventUpdate(*this, SDat, 0.0);
 	    }
 	}
     }
@@ -34,6 +34,9 @@ namespace dynamo {
 
     virtual void initialise(size_t);
 
+    virtual void getIDRanges(std::vector<shared_ptr<IDRange> >& ranges) const
+    { ranges.push_back(range1); }
+
     virtual void operator<<(const magnet::xml::Node&);
 
   protected:
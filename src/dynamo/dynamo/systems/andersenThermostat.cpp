@@ -117,8 +117,7 @@ namespace dynamo {
 
     Sim->ptrScheduler->fullUpdate(part);
   
-    BOOST_FOREACH(shared_ptr<OutputPlugin>& Ptr, Sim->outputPlugins)
-      Ptr->eventUpdate(*this, SDat, locdt);
+    Sim->eventUpdate(*this, SDat, locdt);
 
   }
 
@@ -32,6 +32,9 @@ namespace dynamo {
 
     virtual void initialise(size_t);
 
+    virtual void getIDRanges(std::vector<shared_ptr<IDRange> >& ranges) const
+    { ranges.push_back(range); }
+
     virtual void operator<<(const magnet::xml::Node&);
 
     double getTemperature() const { return Temp; }
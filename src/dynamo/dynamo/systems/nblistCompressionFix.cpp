@@ -102,8 +102,7 @@ namespace dynamo {
 
     Sim->signalParticleUpdate(SDat);
     
-    BOOST_FOREACH(shared_ptr<OutputPlugin>& Ptr, Sim->outputPlugins)
-      Ptr->eventUpdate(*this, SDat, locdt); 
+    Sim->eventUpdate(*this, SDat, locdt); 
   }
 
   void 
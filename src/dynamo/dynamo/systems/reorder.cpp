@@ -0,0 +1,189 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <dynamo/systems/reorder.hpp>
+#include <dynamo/simulation.hpp>
+#include <dynamo/NparticleEventData.hpp>
+#include <dynamo/dynamics/dynamics.hpp>
+#include <dynamo/species/species.hpp>
+#include <dynamo/BC/BC.hpp>
+#include <dynamo/units/units.hpp>
+#include <dynamo/schedulers/scheduler.hpp>
+#include <dynamo/outputplugins/outputplugin.hpp>
+#include <dynamo/globals/socells.hpp>
+#include <dynamo/interactions/interaction.hpp>
+#include <dynamo/locals/local.hpp>
+#include <dynamo/ranges/IDPairRange.hpp>
+#include <magnet/math/morton_number.hpp>
+#include <algorithm>
+#include <cmath>
+
+#ifdef DYNAMO_DEBUG 
+#include <boost/math/special_functions/fpclassify.hpp>
+#endif
+
+namespace dynamo {
+  namespace {
+    //! Throw if the range contains some, but not all, of the particles of a Species.
+    void checkSpeciesRange(const Simulation* sim, const IDRange& range, 
+			   const char* type, const std::string& name)
+    {
+      BOOST_FOREACH(const shared_ptr<Species>& sp, sim->species)
+	{
+	  size_t count(0);
+	  BOOST_FOREACH(const size_t& id, *sp->getRange())
+	    count += range.isInRange(sim->particles[id]);
+
+	  if (count && (count != sp->getRange()->size()))
+	    M_throw() << "The " << type << " \"" << name << "\" acts on part of the Species \"" 
+		      << sp->getName() << "\", the particles cannot be reordered";
+	}
+    }
+  }
+
+  SReorder::SReorder(dynamo::Simulation* nSim, double nPeriod, std::string nName):
+    System(nSim),
+    _reorderCount(0)
+  {
+    if (nPeriod <= 0.0)
+      nPeriod = 1.0;
+
+    nPeriod *= Sim->units.unitTime();
+
+    dt = nPeriod;
+    _period = nPeriod;
+
+    sysName = nName;
+
+    type = NON_EVENT;
+
+    dout << "Particle reordering set for a period of " 
+	 << _period / Sim->units.unitTime() << std::endl;
+  }
+
+  void 
+  SReorder::initialise(size_t nID)
+  { 
+    ID = nID; 
+
+    if (!Sim->topology.empty())
+      M_throw() << "The particles of a system with a Topology cannot be reordered";
+
+    BOOST_FOREACH(const shared_ptr<Global>& glob, Sim->globals)
+      if (std::tr1::dynamic_pointer_cast<GSOCells>(glob))
+	M_throw() << "The single occupancy cells place particles by their ID, the particles cannot be reordered";
+
+    //The particles are only renumbered within their Species, so every
+    //other range of particles must cover whole Species
+    std::vector<shared_ptr<IDRange> > ranges;
+    BOOST_FOREACH(const shared_ptr<Interaction>& interaction, Sim->interactions)
+      {
+	ranges.clear();
+	if (!interaction->getRange()->getIDRanges(ranges))
+	  M_throw() << "The Interaction \"" << interaction->getName() 
+		    << "\" has a range which depends on the particle IDs, the particles cannot be reordered";
+
+	BOOST_FOREACH(const shared_ptr<IDRange>& range, ranges)
+	  checkSpeciesRange(Sim, *range, "Interaction", interaction->getName());
+      }
+
+    BOOST_FOREACH(const shared_ptr<Local>& local, Sim->locals)
+      if (local->getRange())
+	checkSpeciesRange(Sim, *local->getRange(), "Local", local->getName());
+
+    BOOST_FOREACH(const shared_ptr<Global>& glob, Sim->globals)
+      if (glob->getRange())
+	checkSpeciesRange(Sim, *glob->getRange(), "Global", glob->getName());
+
+    BOOST_FOREACH(const shared_ptr<System>& sys, Sim->systems)
+      {
+	ranges.clear();
+	sys->getIDRanges(ranges);
+	BOOST_FOREACH(const shared_ptr<IDRange>& range, ranges)
+	  checkSpeciesRange(Sim, *range, "System", sys->getName());
+      }
+  }
+
+  void
+  SReorder::runEvent() const
+  {
+    double locdt = dt;
+  
+#ifdef DYNAMO_DEBUG 
+    if (boost::math::isnan(dt))
+      M_throw() << "A NAN system event time has been found";
+#endif
+
+    Sim->systemTime += locdt;
+
+    Sim->ptrScheduler->stream(locdt);
+  
+    //dynamics must be updated first
+    Sim->stream(locdt);
+  
+    dt += _period;
+
+    Sim->dynamics->updateAllParticles();
+
+    Sim->eventUpdate(*this, NEventData(), locdt);
+
+    //The Morton grid has roughly one particle per cell, up to the
+    //resolution of the dilated integers
+    const size_t gridSize = std::min(size_t(1024), 
+				     size_t(std::ceil(std::pow(double(Sim->N), 1.0 / 3.0))) + 1);
+
+    std::vector<size_t> order(Sim->N);
+    for (size_t id(0); id < Sim->N; ++id)
+      order[id] = id;
+
+    std::vector<std::pair<size_t, size_t> > keys;
+    std::vector<size_t> slots;
+    BOOST_FOREACH(const shared_ptr<Species>& sp, Sim->species)
+      {
+	keys.clear();
+	slots.clear();
+	BOOST_FOREACH(const size_t& id, *sp->getRange())
+	  {
+	    Vector pos(Sim->particles[id].getPosition());
+	    Sim->BCs->applyBC(pos);
+
+	    size_t coords[3] = {0, 0, 0};
+	    for (size_t iDim(0); iDim < NDIM; ++iDim)
+	      {
+		const double x = (pos[iDim] / Sim->primaryCellSize[iDim] + 0.5) * gridSize;
+		coords[iDim] = std::min(gridSize - 1, size_t(std::max(0.0, x)));
+	      }
+
+	    keys.push_back(std::make_pair(magnet::math::MortonNumber<3>(coords[0], coords[1], coords[2]).getMortonNum(), id));
+	    slots.push_back(id);
+	  }
+
+	//The particles of this species are renumbered using the IDs
+	//of this species, in ascending order
+	std::sort(keys.begin(), keys.end());
+	std::sort(slots.begin(), slots.end());
+	for (size_t i(0); i < slots.size(); ++i)
+	  order[slots[i]] = keys[i].second;
+      }
+
+    ++_reorderCount;
+    dout << "Reordering the particles along a Morton curve (reorder " 
+	 << _reorderCount << ")" << std::endl;
+
+    Sim->reorderParticles(order);
+  }
+}
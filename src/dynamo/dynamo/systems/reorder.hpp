@@ -0,0 +1,58 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <dynamo/systems/system.hpp>
+
+namespace dynamo {
+  /*! \brief A System Event which periodically renumbers the particles
+      along a space-filling (Morton) curve.
+
+      As a simulation runs, particles which are neighbours in space
+      drift apart in memory. This event sorts the particles by the
+      Morton number of their position on a grid of roughly one
+      particle per cell, so that the neighbours of a particle are
+      close to it in memory again (see Simulation::reorderParticles).
+
+      The particles of each Species are only renumbered amongst the
+      IDs of that Species, so the ranges of the Species are
+      unchanged. Any other ranges of IDs (e.g., on Interactions,
+      Locals or Systems) must therefore cover entire Species, which
+      is checked when the event is initialised. Systems
+      with a Topology (e.g., chains) cannot be reordered as their
+      structure depends on the particle IDs.
+   */
+  class SReorder: public System
+  {
+  public:
+    SReorder(dynamo::Simulation*, double, std::string);
+  
+    virtual void runEvent() const;
+
+    virtual void initialise(size_t);
+
+    virtual void operator<<(const magnet::xml::Node&) {}
+
+    const double& getPeriod() const { return _period; }
+
+  protected:
+    virtual void outputXML(magnet::xml::XmlStream&) const {}
+
+    double _period;
+    mutable size_t _reorderCount;
+  };
+}
@@ -112,8 +112,7 @@ namespace dynamo {
     BOOST_FOREACH(const ParticleEventData& PDat, SDat.L1partChanges)
       Sim->ptrScheduler->fullUpdate(Sim->particles[PDat.getParticleID()]);
   
-    BOOST_FOREACH(shared_ptr<OutputPlugin>& Ptr, Sim->outputPlugins)
-      Ptr->eventUpdate(*this, SDat, locdt); 
+    Sim->eventUpdate(*this, SDat, locdt); 
 
     BOOST_FOREACH(shared_ptr<OutputPlugin>& Ptr, Sim->outputPlugins)
       Ptr->temperatureRescale(1.0/currentkT);
@@ -55,6 +55,10 @@ namespace dynamo {
     type = SLEEP;
   }
 
+  void
+  SSleep::reorderParticles(const std::vector<size_t>& order)
+  { reorderParticleData(_lastData, order); }
+
   void
   SSleep::initialise(size_t nID)
   {
@@ -316,7 +320,6 @@ namespace dynamo {
     BOOST_FOREACH(const ParticleEventData& PDat, SDat.L1partChanges)
       Sim->ptrScheduler->fullUpdate(Sim->particles[PDat.getParticleID()]);
     
-    BOOST_FOREACH(shared_ptr<OutputPlugin>& Ptr, Sim->outputPlugins)
-      Ptr->eventUpdate(*this, SDat, locdt); 
+    Sim->eventUpdate(*this, SDat, locdt); 
   }
 }
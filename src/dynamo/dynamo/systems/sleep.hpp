@@ -35,6 +35,11 @@ namespace dynamo {
 
     virtual void initialise(size_t);
 
+    virtual void getIDRanges(std::vector<shared_ptr<IDRange> >& ranges) const
+    { ranges.push_back(_range); }
+
+    virtual void reorderParticles(const std::vector<size_t>&);
+
     virtual void operator<<(const magnet::xml::Node&);
 
   protected:
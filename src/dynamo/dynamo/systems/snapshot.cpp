@@ -23,6 +23,8 @@
 #include <dynamo/units/units.hpp>
 #include <dynamo/schedulers/scheduler.hpp>
 #include <magnet/string/searchreplace.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
 
 #ifdef DYNAMO_DEBUG 
 #include <boost/math/special_functions/fpclassify.hpp>
@@ -32,7 +34,9 @@ namespace dynamo {
   SSnapshot::SSnapshot(dynamo::Simulation* nSim, double nPeriod, std::string nName, bool applyBC):
     System(nSim),
     _applyBC(applyBC),
-    _saveCounter(0)
+    _saveCounter(0),
+    //Two files (the configuration and output data) per snapshot
+    _writer(4)
 
   {
     if (nPeriod <= 0.0)
@@ -72,14 +76,25 @@ namespace dynamo {
     //This is done here as most ticker properties require it
     Sim->dynamics->updateAllParticles();
 
-    BOOST_FOREACH(shared_ptr<OutputPlugin>& Ptr, Sim->outputPlugins)
-      Ptr->eventUpdate(*this, NEventData(), locdt);
+    Sim->eventUpdate(*this, NEventData(), locdt);
   
+    namespace io = boost::iostreams;
+    std::string data;
+    {
+      io::filtering_ostream os(io::back_inserter(data));
+      Sim->writeXMLfile(os, false, _applyBC);
+    }
+
     std::string filename = magnet::string::search_replace("Snapshot.%i.xml.bz2", "%i", boost::lexical_cast<std::string>(_saveCounter));
-    Sim->writeXMLfile(filename, _applyBC);
+    _writer.write(filename, data);
+
+    {
+      io::filtering_ostream os(io::back_inserter(data));
+      Sim->outputData(os);
+    }
     
     filename = magnet::string::search_replace("Snapshot.output.%i.xml.bz2", "%i", boost::lexical_cast<std::string>(_saveCounter++));
-    Sim->outputData(filename);
+    _writer.write(filename, data);
   }
 
   void 
@@ -17,9 +17,17 @@
 
 #pragma once
 #include <dynamo/systems/system.hpp>
+#include <dynamo/asyncFileWriter.hpp>
 
 namespace dynamo {
-  //! \brief A System Event which periodically saves the state of the system.
+  /*! \brief A System Event which periodically saves the state of the system.
+
+    The configuration and output data are rendered into memory inside
+    the event loop, but they are compressed and written to disk by an
+    \ref AsyncFileWriter so that frequent snapshots do not stall the
+    simulation. At most two snapshots are held in memory, if the disk
+    falls further behind the event loop waits for it.
+   */
   class SSnapshot: public System
   {
   public:
@@ -44,5 +52,6 @@ namespace dynamo {
     double _period;
     bool _applyBC;
     mutable size_t _saveCounter;
+    mutable AsyncFileWriter _writer;
   };
 }
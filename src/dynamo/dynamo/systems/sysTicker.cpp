@@ -72,8 +72,7 @@ namespace dynamo {
 	if (ptr) ptr->ticker();
       }
 
-    BOOST_FOREACH(shared_ptr<OutputPlugin>& Ptr, Sim->outputPlugins)
-      Ptr->eventUpdate(*this, NEventData(), locdt);
+    Sim->eventUpdate(*this, NEventData(), locdt);
   }
 
   void 
@@ -24,6 +24,7 @@ namespace dynamo {
   class IntEvent;
   class GlobalEvent;
   class NEventData;
+  class IDRange;
 
   class System: public dynamo::SimBase
   {
@@ -38,6 +39,15 @@ namespace dynamo {
 
     virtual void initialise(size_t) = 0;
 
+    /*! \brief Called when the particle IDs are renumbered (see \ref
+        Simulation::reorderParticles). The new particle i was
+        previously the particle order[i].
+     */
+    virtual void reorderParticles(const std::vector<size_t>& order) {}
+
+    //! \brief Append the ranges of particle IDs this System acts on.
+    virtual void getIDRanges(std::vector<shared_ptr<IDRange> >&) const {}
+
     virtual void operator<<(const magnet::xml::Node&) = 0;
 
     bool operator<(const IntEvent&) const;
@@ -95,8 +95,7 @@ namespace dynamo {
     if (_window->dynamoParticleSync())
       Sim->dynamics->updateAllParticles();
 
-    BOOST_FOREACH(shared_ptr<OutputPlugin>& Ptr, Sim->outputPlugins)
-      Ptr->eventUpdate(*this, NEventData(), dt);
+    Sim->eventUpdate(*this, NEventData(), dt);
   
     _window->simupdateTick(Sim->systemTime / Sim->units.unitTime());
 
@@ -21,6 +21,7 @@
 #include <dynamo/schedulers/include.hpp>
 #include <dynamo/inputplugins/include.hpp>
 #include <magnet/exception.hpp>
+#include <magnet/thread/threadpool.hpp>
 #include <boost/program_options.hpp>
 #include <boost/tokenizer.hpp>
 #include <boost/lexical_cast.hpp>
@@ -36,6 +37,7 @@ main(int argc, char *argv[])
 	    << "under certain conditions. See the licence you obtained with\n"
 	    << "the code\n";
 
+  magnet::thread::ThreadPool threads;
   dynamo::Simulation sim;
 
   ////////////////////////PROGRAM OPTIONS!!!!!!!!!!!!!!!!!!!!!!!
@@ -49,7 +51,7 @@ main(int argc, char *argv[])
 	("help,h", "Produces this message OR if --pack-mode/-m is set, it lists the specific options available for that packer mode.")
 	("out-config-file,o", 
 	 po::value<string>()->default_value("config.out.xml.bz2"), 
-	 "Configuration output file.")
+	 "Configuration output file (a .bin, .bin.bz2 or .bin.gz extension writes the binary format, a .gz extension selects the faster gzip compression over bzip2).")
 	("random-seed,s", po::value<unsigned int>(),
 	 "Seed value for the random number generator.")
 	("rescale-T,r", po::value<double>(), 
@@ -68,6 +70,8 @@ main(int argc, char *argv[])
 	 "rounding errors (used in the test harness).")
 	("unwrapped", "Don't apply the boundary conditions of the system when writing out the particle positions.")
 	("check", "Runs tests on the configuration to ensure the system is not in an invalid state.")
+	("n-threads,N", po::value<unsigned int>(),
+	 "Number of threads used to rebuild the capture maps and to compress the output config file.")
 	;
 
       loadopts.add_options()
@@ -131,6 +135,12 @@ main(int argc, char *argv[])
 
       if (vm.count("random-seed"))
 	sim.ranGenerator.seed(vm["random-seed"].as<unsigned int>());
+
+      if (vm.count("n-threads"))
+	{
+	  threads.setThreadCount(vm["n-threads"].as<unsigned int>());
+	  sim.threads = &threads;
+	}
       
       ////////////////////////Simulation Initialisation!!!!!!!!!!!!!
       //Now load the config
@@ -0,0 +1,161 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*! \file dynatrace.cpp 
+ 
+  \brief Contains the main() function for dynatrace
+
+  dynatrace replays an event trace (written by the EventTrace output
+  plugin) against the configuration the traced run started from, and
+  feeds the events to output plugins. This allows the event based
+  output plugins (e.g., MFT, CollisionMatrix, EventEffects) to be
+  computed after a run, without running the simulation again.
+*/
+
+#include <dynamo/simulation.hpp>
+#include <dynamo/outputplugins/general/eventTrace.hpp>
+#include <magnet/stream/formattedostream.hpp>
+#include <magnet/thread/threadpool.hpp>
+#include <magnet/function/task.hpp>
+#include <magnet/exception.hpp>
+#include <boost/program_options.hpp>
+#include <boost/foreach.hpp>
+#include <iostream>
+
+namespace po = boost::program_options;
+
+int
+main(int argc, char *argv[])
+{
+  std::cout << "dynatrace  Copyright (C) 2011  Marcus N Campbell Bannerman\n"
+	    << "This program comes with ABSOLUTELY NO WARRANTY.\n"
+	    << "This is free software, and you are welcome to redistribute it\n"
+	    << "under certain conditions. See the licence you obtained with\n"
+	    << "the code\n";
+
+  try 
+    {
+      po::options_description helpopts("General Options"), hiddenopts, allopts;
+
+      helpopts.add_options()
+	("help,h", "Produces this message.")
+	("load-plugin,L", po::value<std::vector<std::string> >(), 
+	 "Output plugins to compute from the trace. Plugins which only use the events "
+	 "(e.g., MFT, CollisionMatrix, EventEffects) see the whole run, other plugins "
+	 "only see the initial and final states (e.g., MSD).")
+	("out-data-file,o", po::value<std::string>()->default_value("output.xml.bz2"),
+	 "Output data file.")
+	("n-threads,N", po::value<unsigned int>()->default_value(0),
+	 "Number of threads used to run the output plugins alongside the replay.")
+	("batch-size", po::value<size_t>()->default_value(16384),
+	 "The number of event records passed to the plugins at once.")
+	;
+
+      hiddenopts.add_options()
+	("config-file", po::value<std::string>(), 
+	 "The configuration the traced run started from.")
+	("trace-file", po::value<std::string>(), 
+	 "The event trace file.")
+	;
+
+      allopts.add(helpopts).add(hiddenopts);
+
+      po::positional_options_description p;
+      p.add("config-file", 1);
+      p.add("trace-file", 1);
+      
+      po::variables_map vm;
+      po::store(po::command_line_parser(argc, argv).
+		options(allopts).positional(p).run(), vm);
+      po::notify(vm);
+      
+      if (vm.count("help") || !vm.count("config-file") || !vm.count("trace-file"))
+	{
+	  std::cout << "Usage : dynatrace <OPTIONS>...[CONFIG FILE] [TRACE FILE]\n"
+		    << " Replays an event trace against the configuration the traced run started from,"
+		    << " and writes the output of the plugins loaded.\n"
+		    << helpopts;
+	  return 1;
+	}
+
+      magnet::thread::ThreadPool threads;
+      threads.setThreadCount(vm["n-threads"].as<unsigned int>());
+
+      dynamo::Simulation sim;
+      sim.loadXMLfile(vm["config-file"].as<std::string>());
+      sim.status = dynamo::CONFIG_LOADED;
+      sim.threads = &threads;
+
+      if (vm.count("load-plugin"))
+	{
+	  BOOST_FOREACH(const std::string& plugin, vm["load-plugin"].as<std::vector<std::string> >())
+	    sim.addOutputPlugin(plugin);
+	}
+
+      sim.initialise();
+
+      std::vector<dynamo::OPBatched*> plugins;
+      BOOST_FOREACH(dynamo::shared_ptr<dynamo::OutputPlugin>& ptr, sim.outputPlugins)
+	if (dynamo::OPBatched* plugin = dynamic_cast<dynamo::OPBatched*>(ptr.get()))
+	  plugins.push_back(plugin);
+
+      dynamo::EventTraceReader reader(&sim, vm["trace-file"].as<std::string>());
+      
+      //The plugins process one batch of records in parallel while
+      //the next batch is replayed
+      const size_t batchSize = vm["batch-size"].as<size_t>();
+      std::vector<dynamo::EventRecord> batch, nextBatch;
+      size_t recordCount = 0;
+      reader.read(batch, batchSize);
+      while (!batch.empty())
+	{
+	  const dynamo::EventRecord* begin = &batch[0];
+	  const dynamo::EventRecord* end = begin + batch.size();
+
+	  std::vector<magnet::function::Task*> tasks;
+	  BOOST_FOREACH(dynamo::OPBatched* plugin, plugins)
+	    tasks.push_back(magnet::function::Task::makeTask(&dynamo::OPBatched::eventBatch, 
+							     plugin, begin, end));
+	  threads.queueTasks(tasks);
+
+	  reader.read(nextBatch, batchSize);
+	  threads.wait();
+
+	  recordCount += batch.size();
+	  batch.swap(nextBatch);
+	}
+
+      std::cout << "Replayed " << recordCount << " event records up to a time of " 
+		<< sim.systemTime / sim.units.unitTime() << std::endl;
+
+      sim.outputData(vm["out-data-file"].as<std::string>());
+    }
+  catch (std::exception& cep)
+    {
+      std::cout.flush();
+      magnet::stream::FormattedOStream os(magnet::console::bold()
+					  + magnet::console::red_fg() 
+					  + "Main(): " + magnet::console::reset(), std::cerr);
+      os << cep.what() << std::endl;
+#ifndef DYNAMO_DEBUG
+      os << "Try using the debugging executable for more information on the error." << std::endl;
+#endif
+      return 1;
+    }
+
+  return 0;
+}
@@ -0,0 +1,282 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <magnet/exception.hpp>
+#include <stdint.h>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+namespace magnet {
+  namespace containers {
+    namespace detail {
+      //! \brief The key stored in an empty slot of an OpenHashTable.
+      const uint64_t openHashEmpty = ~uint64_t(0);
+
+      //! \brief Extract the key of a slot of an OpenHashTable.
+      inline const uint64_t& openHashKey(const uint64_t& slot) { return slot; }
+
+      template<class T>
+      inline const uint64_t& openHashKey(const std::pair<uint64_t, T>& slot) { return slot.first; }
+
+      //! \brief Create a slot of an OpenHashTable holding a key.
+      template<class Slot> struct OpenHashSlot;
+
+      template<> struct OpenHashSlot<uint64_t>
+      { static inline uint64_t make(const uint64_t& key) { return key; } };
+
+      template<class T> struct OpenHashSlot<std::pair<uint64_t, T> >
+      { static inline std::pair<uint64_t, T> make(const uint64_t& key) { return std::pair<uint64_t, T>(key, T()); } };
+
+      /*! \brief Scramble the bits of a key (the finaliser of the
+          splitmix64 generator).
+
+	Keys formed from packed integers have most of their entropy in
+	the low bits of each half, so they must be mixed before the
+	table index is taken from them.
+       */
+      inline uint64_t openHashMix(uint64_t x)
+      {
+	x ^= x >> 30;
+	x *= (uint64_t(0xbf58476d) << 32) | uint64_t(0x1ce4e5b9);
+	x ^= x >> 27;
+	x *= (uint64_t(0x94d049bb) << 32) | uint64_t(0x133111eb);
+	x ^= x >> 31;
+	return x;
+      }
+    }
+
+    /*! \brief A hash table of 64 bit integer keys using open
+        addressing.
+
+      The slots are held in a single array whose size is a power of
+      two, and collisions are resolved by linear probing, so a lookup
+      usually touches a single cache line. Erasing a slot shifts the
+      following entries of its probe sequence back into the gap
+      (backward shift deletion), so no tombstones are needed and the
+      table never degrades under repeated insertion and erasure.
+
+      The key ~uint64_t(0) is reserved to mark empty slots.
+
+      \note Inserting or erasing an entry may move other entries, and
+      so invalidates all iterators.
+
+      \tparam Slot Either uint64_t (a set) or std::pair<uint64_t,T> (a
+      map).
+     */
+    template<class Slot>
+    class OpenHashTable
+    {
+      template<class SlotT>
+      class iterator_base
+      {
+      public:
+	typedef std::forward_iterator_tag iterator_category;
+	typedef SlotT value_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef SlotT* pointer;
+	typedef SlotT& reference;
+
+	iterator_base(): _ptr(NULL), _end(NULL) {}
+	iterator_base(SlotT* ptr, SlotT* end): _ptr(ptr), _end(end) { skip(); }
+
+	template<class OtherT>
+	iterator_base(const iterator_base<OtherT>& o): _ptr(o._ptr), _end(o._end) {}
+
+	inline SlotT& operator*() const { return *_ptr; }
+	inline SlotT* operator->() const { return _ptr; }
+	inline iterator_base& operator++() { ++_ptr; skip(); return *this; }
+	inline iterator_base operator++(int) { iterator_base tmp(*this); ++(*this); return tmp; }
+
+	template<class OtherT>
+	inline bool operator==(const iterator_base<OtherT>& o) const { return _ptr == o._ptr; }
+	template<class OtherT>
+	inline bool operator!=(const iterator_base<OtherT>& o) const { return _ptr != o._ptr; }
+
+      private:
+	template<class> friend class iterator_base;
+	friend class OpenHashTable;
+
+	inline void skip() 
+	{ 
+	  while ((_ptr != _end) && (detail::openHashKey(*_ptr) == detail::openHashEmpty))
+	    ++_ptr; 
+	}
+
+	SlotT* _ptr;
+	SlotT* _end;
+      };
+
+    public:
+      typedef Slot value_type;
+      typedef iterator_base<Slot> iterator;
+      typedef iterator_base<const Slot> const_iterator;
+
+      OpenHashTable(): _size(0) {}
+
+      inline size_t size() const { return _size; }
+      inline bool empty() const { return !_size; }
+      //! \brief The number of slots in the table.
+      inline size_t bucket_count() const { return _slots.size(); }
+      inline double load_factor() const { return _slots.empty() ? 0 : double(_size) / _slots.size(); }
+      //! \brief The table is grown before its load factor exceeds this.
+      inline double max_load_factor() const { return 0.5; }
+
+      inline iterator begin() { return iterator(slotsBegin(), slotsEnd()); }
+      inline iterator end() { return iterator(slotsEnd(), slotsEnd()); }
+      inline const_iterator begin() const { return const_iterator(slotsBegin(), slotsEnd()); }
+      inline const_iterator end() const { return const_iterator(slotsEnd(), slotsEnd()); }
+
+      //! \brief Remove all entries and release the table.
+      inline void clear() { std::vector<Slot>().swap(_slots); _size = 0; }
+
+      inline void swap(OpenHashTable& o) { _slots.swap(o._slots); std::swap(_size, o._size); }
+
+      //! \brief Grow the table so it can hold n entries without rehashing.
+      void reserve(size_t n)
+      {
+	size_t slots = 16;
+	while (slots * max_load_factor() < n) slots *= 2;
+	if (slots > _slots.size()) rehash(slots);
+      }
+
+      inline size_t count(const uint64_t& key) const { return find(key) != end(); }
+
+      inline iterator find(const uint64_t& key)
+      {
+	if (_slots.empty()) return end();
+	const size_t i = locate(key);
+	if (detail::openHashKey(_slots[i]) == detail::openHashEmpty) return end();
+	return iterator(&_slots[i], slotsEnd());
+      }
+
+      inline const_iterator find(const uint64_t& key) const
+      { return const_iterator(const_cast<OpenHashTable&>(*this).find(key)); }
+
+      /*! \brief Insert a slot, unless its key is already present.
+
+        \returns An iterator to the slot of the key and whether it was
+        inserted.
+       */
+      std::pair<iterator, bool> insert(const Slot& slot)
+      {
+	const uint64_t& key = detail::openHashKey(slot);
+#ifdef MAGNET_DEBUG
+	if (key == detail::openHashEmpty)
+	  M_throw() << "Cannot insert the reserved empty key";
+#endif
+	if ((_size + 1) > _slots.size() * max_load_factor())
+	  rehash(std::max(size_t(16), 2 * _slots.size()));
+
+	const size_t i = locate(key);
+	const bool inserted = (detail::openHashKey(_slots[i]) == detail::openHashEmpty);
+	if (inserted)
+	  {
+	    _slots[i] = slot;
+	    ++_size;
+	  }
+	return std::make_pair(iterator(&_slots[i], slotsEnd()), inserted);
+      }
+
+      //! \brief Erase a key, returning the number of entries removed.
+      inline size_t erase(const uint64_t& key)
+      {
+	iterator it = find(key);
+	if (it == end()) return 0;
+	erase(it);
+	return 1;
+      }
+
+      //! \brief Erase the entry at an iterator.
+      void erase(iterator it)
+      {
+	const size_t mask = _slots.size() - 1;
+	size_t hole = it._ptr - &_slots[0];
+	--_size;
+
+	//Move entries later in the probe sequence back into the hole,
+	//unless that would take them before their home slot.
+	for (size_t i = (hole + 1) & mask; 
+	     detail::openHashKey(_slots[i]) != detail::openHashEmpty; 
+	     i = (i + 1) & mask)
+	  {
+	    const size_t home = index(detail::openHashKey(_slots[i]));
+	    //Distances along the probe sequence, wrapping around the table
+	    if (((i - home) & mask) >= ((i - hole) & mask))
+	      {
+		_slots[hole] = _slots[i];
+		hole = i;
+	      }
+	  }
+
+	_slots[hole] = emptySlot();
+      }
+
+    protected:
+      std::vector<Slot> _slots;
+      size_t _size;
+
+      static inline Slot emptySlot() { return detail::OpenHashSlot<Slot>::make(detail::openHashEmpty); }
+
+      inline size_t index(const uint64_t& key) const
+      { return detail::openHashMix(key) & (_slots.size() - 1); }
+
+      //! \brief The slot holding a key, or the empty slot where it would go.
+      inline size_t locate(const uint64_t& key) const
+      {
+	const size_t mask = _slots.size() - 1;
+	size_t i = index(key);
+	while ((detail::openHashKey(_slots[i]) != key)
+	       && (detail::openHashKey(_slots[i]) != detail::openHashEmpty))
+	  i = (i + 1) & mask;
+	return i;
+      }
+
+      void rehash(size_t slots)
+      {
+	std::vector<Slot> old(slots, emptySlot());
+	old.swap(_slots);
+
+	for (typename std::vector<Slot>::const_iterator it = old.begin(); it != old.end(); ++it)
+	  if (detail::openHashKey(*it) != detail::openHashEmpty)
+	    _slots[locate(detail::openHashKey(*it))] = *it;
+      }
+
+      inline Slot* slotsBegin() { return _slots.empty() ? NULL : &_slots[0]; }
+      inline Slot* slotsEnd() { return slotsBegin() + _slots.size(); }
+      inline const Slot* slotsBegin() const { return _slots.empty() ? NULL : &_slots[0]; }
+      inline const Slot* slotsEnd() const { return slotsBegin() + _slots.size(); }
+    };
+
+    //! \brief A set of 64 bit integers (see \ref OpenHashTable).
+    typedef OpenHashTable<uint64_t> OpenHashSet;
+
+    //! \brief A map from 64 bit integers to T (see \ref OpenHashTable).
+    template<class T>
+    class OpenHashMap: public OpenHashTable<std::pair<uint64_t, T> >
+    {
+      typedef OpenHashTable<std::pair<uint64_t, T> > Base;
+    public:
+      //! \brief Access the value of a key, inserting a default T if absent.
+      inline T& operator[](const uint64_t& key)
+      { return Base::insert(std::pair<uint64_t, T>(key, T())).first->second; }
+    };
+  }
+}
@@ -22,6 +22,8 @@
 #include <vector>
 #include <utility>
 #include <exception>
+#include <stdexcept>
+#include <algorithm>
 #include <tr1/tuple>
 
 namespace magnet {
@@ -418,6 +420,158 @@ namespace magnet {
       
       Container _correlators;
     };
+
+    /*! \brief Stores a history of samples of a set of values (e.g.,
+        the positions of every particle) at logarithmically spaced
+        intervals, for multiple-tau correlators.
+
+	The samples are kept in several levels. Level \f$l\f$ holds
+	the last \f$p\f$ samples taken at multiples of \f$m^l\f$
+	pushes, where \f$p\f$ is the length and \f$m\f$ the scaling
+	of the history. Correlating the most recent sample of a level
+	against its older samples gives the correlation at lags of
+	\f$m^l\f$ to \f$(p-1)\,m^l\f$ pushes. The samples are not
+	averaged, so the correlations are exact at these lags, only
+	the number of time origins drops at the longer lags.
+
+	Levels are added as they're needed, so the memory and work per
+	value grows with the logarithm of the number of samples, in
+	contrast to the linear growth of a plain Correlator.
+
+	Each level only needs to be correlated from firstStep(), the
+	shorter lags are covered by the lower levels.
+
+	\tparam T The type of the sampled values.
+     */
+    template<class T>
+    class MultiTauHistory
+    {
+      struct Level
+      {
+	Level(size_t length): data(length), head(0), filled(0) {}
+
+	std::vector<std::vector<T> > data;
+	size_t head;
+	size_t filled;
+      };
+
+    public:
+      /*! \brief Constructor.
+
+	\param length The number of samples stored in each level.
+
+	\param scaling The factor between the sampling intervals of
+	each level. This must be less than the length, so that the
+	first sample of a new level can be taken from the level below.
+       */
+      MultiTauHistory(size_t length = 16, size_t scaling = 2) { resize(length, scaling); }
+
+      //! \brief Change the length and scaling, this clears all samples.
+      void resize(size_t length, size_t scaling = 2)
+      {
+	if ((scaling < 2) || (length <= scaling))
+	  throw std::runtime_error("MultiTauHistory requires 2 <= scaling < length");
+
+	_length = length;
+	_scaling = scaling;
+	clear();
+      }
+
+      //! \brief Remove all samples.
+      void clear()
+      {
+	_levels.clear();
+	_count = 0;
+	_updated = 0;
+      }
+
+      /*! \brief Add a new sample.
+	
+	After this call, the first updatedLevels() levels have the new
+	sample at step 0.
+       */
+      void push(const std::vector<T>& sample)
+      {
+	if (_levels.empty())
+	  _levels.push_back(Level(_length));
+
+	_updated = 0;
+	size_t period = 1;
+	for (size_t level(0); !(_count % period); ++level, period *= _scaling)
+	  {
+	    if (level == _levels.size())
+	      {
+		//Only the first sample has been taken at this
+		//interval, and the lower level still holds it.
+		if (!_count) break;
+		_levels.push_back(Level(_length));
+		pushLevel(level, get(level - 1, _scaling));
+	      }
+
+	    pushLevel(level, sample);
+	    ++_updated;
+	  }
+
+	++_count;
+      }
+
+      //! \brief The number of levels the last push() added a sample to.
+      size_t updatedLevels() const { return _updated; }
+
+      //! \brief The number of levels.
+      size_t levels() const { return _levels.size(); }
+
+      //! \brief The number of samples stored in a level.
+      size_t size(size_t level) const { return _levels[level].filled; }
+
+      //! \brief The number of samples stored in each full level.
+      size_t length() const { return _length; }
+
+      //! \brief The first step of a level which is not covered by the level below.
+      size_t firstStep(size_t level) const
+      { return level ? (_length + _scaling - 1) / _scaling : 1; }
+
+      //! \brief The number of pushes between the samples of a level.
+      size_t period(size_t level) const
+      {
+	size_t retval = 1;
+	for (size_t i(0); i < level; ++i)
+	  retval *= _scaling;
+	return retval;
+      }
+
+      /*! \brief Access a sample of a level, step 0 is the most recent
+          sample of that level.
+       */
+      const std::vector<T>& get(size_t level, size_t step) const
+      {
+	const Level& lvl = _levels[level];
+	return lvl.data[(lvl.head + step) % _length];
+      }
+
+      //! \sa get(size_t, size_t) const
+      std::vector<T>& get(size_t level, size_t step)
+      {
+	Level& lvl = _levels[level];
+	return lvl.data[(lvl.head + step) % _length];
+      }
+
+    protected:
+      void pushLevel(size_t level, const std::vector<T>& sample)
+      {
+	Level& lvl = _levels[level];
+	lvl.head = (lvl.head + _length - 1) % _length;
+	//Assignment reuses the storage of the overwritten sample
+	lvl.data[lvl.head] = sample;
+	lvl.filled = std::min(lvl.filled + 1, _length);
+      }
+
+      std::vector<Level> _levels;
+      size_t _length;
+      size_t _scaling;
+      size_t _count;
+      size_t _updated;
+    };
   }
 }
 
@@ -0,0 +1,86 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+#include <limits>
+
+namespace magnet {
+  namespace memory {
+    /*! \brief An STL allocator which returns memory aligned to a
+        fixed boundary.
+
+	This is used to allocate arrays which are streamed by
+	vectorised loops (e.g., SSE/AVX loads require 16/32 byte
+	alignment). The default alignment is a cache line.
+
+	\tparam T The type to allocate.
+	\tparam Alignment The byte boundary to align to, must be a
+	power of two and a multiple of sizeof(void*).
+     */
+    template<class T, size_t Alignment = 64>
+    class AlignedAllocator
+    {
+    public:
+      typedef T value_type;
+      typedef T* pointer;
+      typedef const T* const_pointer;
+      typedef T& reference;
+      typedef const T& const_reference;
+      typedef size_t size_type;
+      typedef ptrdiff_t difference_type;
+
+      template<class U> struct rebind { typedef AlignedAllocator<U, Alignment> other; };
+
+      AlignedAllocator() throw() {}
+      AlignedAllocator(const AlignedAllocator&) throw() {}
+      template<class U> AlignedAllocator(const AlignedAllocator<U, Alignment>&) throw() {}
+
+      inline pointer address(reference x) const { return &x; }
+      inline const_pointer address(const_reference x) const { return &x; }
+
+      inline pointer allocate(size_type n, const void* = 0)
+      {
+	if (n == 0) return 0;
+
+	if (n > max_size()) throw std::bad_alloc();
+
+	void* ptr(0);
+	if (posix_memalign(&ptr, Alignment, n * sizeof(T)))
+	  throw std::bad_alloc();
+
+	return static_cast<pointer>(ptr);
+      }
+
+      inline void deallocate(pointer p, size_type) { free(p); }
+
+      inline size_type max_size() const throw()
+      { return std::numeric_limits<size_type>::max() / sizeof(T); }
+
+      inline void construct(pointer p, const T& val) { new(static_cast<void*>(p)) T(val); }
+      inline void destroy(pointer p) { p->~T(); }
+
+      template<class U>
+      inline bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+
+      template<class U>
+      inline bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+    };
+  }
+}
@@ -0,0 +1,64 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include <magnet/exception.hpp>
+#include <iostream>
+#include <cstddef>
+
+namespace magnet
+{
+  namespace stream {
+    /*! \brief Write the raw bytes of an array of plain data values to
+        a stream.
+
+      No conversion of the byte order is performed, the data can only
+      be read back on a machine of the same endianness.
+     */
+    template<class T>
+    inline void writeBinary(std::ostream& os, const T* data, const size_t count)
+    {
+      if (count)
+	os.write(reinterpret_cast<const char*>(data), sizeof(T) * count);
+
+      if (!os)
+	M_throw() << "Failed to write binary data to the stream";
+    }
+
+    //! \brief Write the raw bytes of a single plain data value to a stream.
+    template<class T>
+    inline void writeBinary(std::ostream& os, const T& val)
+    { writeBinary(os, &val, 1); }
+
+    /*! \brief Read an array of plain data values written by \ref
+        writeBinary from a stream.
+
+      An exception is thrown if the stream ends before all of the
+      values are read.
+     */
+    template<class T>
+    inline void readBinary(std::istream& is, T* data, const size_t count)
+    {
+      if (count && !is.read(reinterpret_cast<char*>(data), sizeof(T) * count))
+	M_throw() << "Unexpected end of the binary data stream";
+    }
+
+    //! \brief Read a single plain data value from a stream.
+    template<class T>
+    inline void readBinary(std::istream& is, T& val)
+    { readBinary(is, &val, 1); }
+  }
+}
@@ -0,0 +1,175 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include <magnet/thread/threadpool.hpp>
+#include <magnet/exception.hpp>
+#include <boost/iostreams/categories.hpp>
+#include <boost/iostreams/operations.hpp>
+#include <bzlib.h>
+#include <vector>
+
+namespace magnet
+{
+  namespace stream {
+    /*! \brief A boost::iostreams output filter which compresses data
+        into the bzip2 format using the threads of a \ref
+        thread::ThreadPool.
+
+      The data is split into blocks which are each compressed into an
+      independent bzip2 stream. The streams are written in order, one
+      after the other. This is the layout written by pbzip2 and it can
+      be read by any bzip2 decompressor which supports concatenated
+      streams (including bzip2 itself and
+      boost::iostreams::bzip2_decompressor).
+
+      Blocks are compressed in batches of one block per thread of the
+      pool, so the memory used is roughly twice the block size per
+      thread. If the pool has no threads the blocks are compressed by
+      the calling thread inside \ref thread::ThreadPool::wait().
+     */
+    class ParallelBzip2Compressor
+    {
+    public:
+      typedef char char_type;
+      struct category
+	: boost::iostreams::multichar_output_filter_tag,
+	  boost::iostreams::closable_tag
+      {};
+
+      /*! \brief Constructor.
+	
+	\param pool The thread pool used to compress the blocks.
+	\param blockSize The number of uncompressed bytes placed in
+	each bzip2 stream. The default matches the largest block of
+	the bzip2 format.
+	\param level The bzip2 block size setting (1-9), which
+	determines the size of the internal bzip2 blocks.
+       */
+      ParallelBzip2Compressor(thread::ThreadPool& pool, 
+			      size_t blockSize = 900000, int level = 9):
+	_pool(&pool), _blockSize(blockSize), _level(level), 
+	_current(0), _written(false)
+      {
+	if (!_blockSize)
+	  M_throw() << "Cannot compress with a zero block size";
+
+	if ((_level < 1) || (_level > 9))
+	  M_throw() << "Invalid bzip2 compression level " << _level;
+      }
+
+      template<class Sink>
+      std::streamsize write(Sink& snk, const char* s, std::streamsize n)
+      {
+	if (_blocks.empty())
+	  _blocks.resize(std::max(_pool->getThreadCount(), size_t(1)));
+
+	std::streamsize remaining(n);
+	while (remaining)
+	  {
+	    std::vector<char>& input = _blocks[_current]._input;
+	    if (input.capacity() < _blockSize)
+	      input.reserve(_blockSize);
+
+	    const size_t count = std::min(size_t(remaining), _blockSize - input.size());
+	    input.insert(input.end(), s, s + count);
+	    s += count;
+	    remaining -= count;
+
+	    if (input.size() == _blockSize)
+	      if (++_current == _blocks.size())
+		flush(snk);
+	  }
+
+	return n;
+      }
+
+      //! \brief Compress and write out any remaining buffered data.
+      template<class Sink>
+      void close(Sink& snk)
+      {
+	if (!_blocks.empty() && !_blocks[_current]._input.empty())
+	  ++_current;
+
+	//An empty input must still produce a (empty) bzip2 stream
+	if (!_written && !_current)
+	  {
+	    _blocks.resize(1);
+	    _current = 1;
+	  }
+
+	flush(snk);
+	_blocks.clear();
+	_written = false;
+      }
+
+    private:
+      struct Block
+      {
+	Block(): _error(BZ_OK) {}
+
+	void compress(int level)
+	{
+	  //The worst case size of a bzip2 stream, as given in the
+	  //libbzip2 documentation
+	  _output.resize(_input.size() + _input.size() / 100 + 601);
+	  unsigned int outputSize = _output.size();
+	  //libbzip2 rejects a NULL source, even for an empty block
+	  char empty;
+	  _error = BZ2_bzBuffToBuffCompress(&_output[0], &outputSize, 
+					    _input.empty() ? &empty : &_input[0], 
+					    _input.size(), level, 0, 0);
+	  _output.resize(outputSize);
+	}
+
+	std::vector<char> _input;
+	std::vector<char> _output;
+	int _error;
+      };
+
+      //! \brief Compress the first _current blocks and write them in order.
+      template<class Sink>
+      void flush(Sink& snk)
+      {
+	for (size_t i(0); i < _current; ++i)
+	  _pool->queueTask(function::Task::makeTask(&Block::compress, &_blocks[i], _level));
+
+	_pool->wait();
+
+	for (size_t i(0); i < _current; ++i)
+	  {
+	    Block& block = _blocks[i];
+	    if (block._error != BZ_OK)
+	      M_throw() << "bzip2 failed to compress a block, error code " << block._error;
+
+	    boost::iostreams::write(snk, &block._output[0], block._output.size());
+	    block._input.clear();
+	    block._output.clear();
+	  }
+
+	_written = _written || _current;
+	_current = 0;
+      }
+
+      thread::ThreadPool* _pool;
+      size_t _blockSize;
+      int _level;
+      std::vector<Block> _blocks;
+      size_t _current;
+      bool _written;
+    };
+  }
+}
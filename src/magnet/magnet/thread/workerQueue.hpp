@@ -0,0 +1,191 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <magnet/thread/thread.hpp>
+#include <magnet/thread/mutex.hpp>
+#include <magnet/exception.hpp>
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace magnet {
+  namespace thread {
+    /*! \brief A bounded queue of jobs which are processed in order
+        by a background thread.
+
+      The derived class implements \ref process, which is called on
+      the worker thread for each job. At most maxQueued jobs are held
+      (including the one being processed), so \ref push blocks while
+      the queue is full and a fast producer cannot use an unbounded
+      amount of memory.
+
+      Jobs are swapped in and out of the queue (using an unqualified
+      swap, so a job type may provide its own), and processed jobs
+      are handed back to the producer by \ref push for reuse.
+
+      If \ref process throws, the error is rethrown in the producer
+      from the next call to \ref push or \ref wait.
+
+      The thread cannot call \ref process until the derived class is
+      constructed, so the derived class must call \ref start from its
+      constructor and \ref stop from its destructor.
+     */
+    template<class T>
+    class WorkerQueue
+    {
+    public:
+      /*! \param maxQueued The largest number of jobs held by the queue.
+	\param failure The description of the error thrown if a job fails.
+       */
+      inline WorkerQueue(size_t maxQueued, const std::string& failure):
+	_maxQueued(std::max(maxQueued, size_t(1))),
+	_failure(failure),
+	_stop(false)
+      {}
+
+      inline virtual ~WorkerQueue() {}
+
+      /*! \brief Queue a job for the worker thread.
+
+	The job is swapped into the queue and replaced by a previously
+	processed job (or a default constructed T).
+       */
+      inline void push(T& job)
+      {
+	ScopedLock lock(_mutex);
+	checkError();
+
+	while (_queue.size() >= _maxQueued)
+	  {
+	    _condition.wait(lock);
+	    checkError();
+	  }
+
+	using std::swap;
+	_queue.push_back(T());
+	swap(_queue.back(), job);
+
+	if (!_free.empty())
+	  {
+	    swap(job, _free.back());
+	    _free.pop_back();
+	  }
+
+	_condition.notify_all();
+      }
+
+      //! \brief Block until every queued job has been processed.
+      inline void wait()
+      {
+	ScopedLock lock(_mutex);
+	while (!_queue.empty() && _error.empty())
+	  _condition.wait(lock);
+	checkError();
+      }
+
+    protected:
+      //! \brief Process a job, called on the worker thread.
+      virtual void process(T& job) = 0;
+
+      //! \brief Start the worker thread.
+      inline void start()
+      { _thread.startTask(function::Task::makeTask(&WorkerQueue::run, this)); }
+
+      /*! \brief Process the remaining jobs and stop the worker thread.
+	
+	\return The errors of any failed jobs which were not rethrown
+	by \ref push or \ref wait.
+       */
+      inline std::string stop()
+      {
+	{
+	  ScopedLock lock(_mutex);
+	  _stop = true;
+	  _condition.notify_all();
+	}
+
+	_thread.join();
+
+	std::string error;
+	error.swap(_error);
+	return error;
+      }
+
+    private:
+      WorkerQueue(const WorkerQueue&);
+      WorkerQueue& operator=(const WorkerQueue&);
+
+      //! Throw any error stored by the worker thread (the lock must be held).
+      inline void checkError()
+      {
+	if (_error.empty()) return;
+	
+	std::string error;
+	error.swap(_error);
+	M_throw() << _failure << "\n" << error;
+      }
+
+      inline void run()
+      {
+	using std::swap;
+	for (;;)
+	  {
+	    T job;
+	    {
+	      ScopedLock lock(_mutex);
+	      while (_queue.empty() && !_stop)
+		_condition.wait(lock);
+
+	      if (_queue.empty()) return;
+	      
+	      //The emptied entry is left at the front of the queue
+	      //until the job is done, so it counts towards maxQueued
+	      swap(job, _queue.front());
+	    }
+
+	    std::string error;
+	    try {
+	      process(job);
+	    } catch (std::exception& e) {
+	      error = e.what();
+	    }
+
+	    ScopedLock lock(_mutex);
+	    _error += error;
+	    _free.push_back(T());
+	    swap(_free.back(), job);
+	    _queue.pop_front();
+	    _condition.notify_all();
+	  }
+      }
+
+      size_t _maxQueued;
+      std::string _failure;
+      std::deque<T> _queue;
+      //! Processed jobs, returned to the producer by \ref push.
+      std::vector<T> _free;
+      bool _stop;
+      std::string _error;
+      Mutex _mutex;
+      //! Signalled whenever the queue changes or the thread must stop.
+      Condition _condition;
+      Thread _thread;
+    };
+  }
+}
@@ -0,0 +1,96 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <magnet/stream/bzip2.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/bzip2.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <iostream>
+#include <cstdlib>
+#include <string>
+
+namespace io = boost::iostreams;
+
+std::string compress(const std::string& data, magnet::thread::ThreadPool& pool, size_t blockSize)
+{
+  std::string compressed;
+  {
+    io::filtering_ostream os;
+    os.push(magnet::stream::ParallelBzip2Compressor(pool, blockSize));
+    os.push(io::back_inserter(compressed));
+    //Write in uneven pieces to cross the block boundaries
+    size_t pos = 0;
+    for (size_t piece = 1; pos < data.size(); piece = (piece * 7) % 4093 + 1)
+      {
+	const size_t count = std::min(piece, data.size() - pos);
+	os.write(data.data() + pos, count);
+	pos += count;
+      }
+  }
+  return compressed;
+}
+
+std::string decompress(const std::string& compressed)
+{
+  std::string data;
+  io::filtering_istream is;
+  is.push(io::bzip2_decompressor());
+  is.push(io::array_source(compressed.data(), compressed.size()));
+  io::copy(is, io::back_inserter(data));
+  return data;
+}
+
+bool test(const std::string& data, size_t threads, size_t blockSize)
+{
+  magnet::thread::ThreadPool pool;
+  pool.setThreadCount(threads);
+  
+  const std::string result = decompress(compress(data, pool, blockSize));
+
+  if (result != data)
+    {
+      std::cerr << "Round trip failed for " << data.size() << " bytes using " 
+		<< threads << " threads and a block size of " << blockSize << "\n";
+      return false;
+    }
+  return true;
+}
+
+int main()
+{
+  //Compressible but not trivially repetitive data
+  std::string data;
+  std::srand(1);
+  for (size_t i(0); i < 3000000; ++i)
+    data.push_back('a' + std::rand() % 8);
+
+  bool pass = true;
+  for (size_t threads(0); threads < 4; threads += 3)
+    {
+      pass &= test("", threads, 900000);
+      pass &= test(data.substr(0, 10), threads, 900000);
+      pass &= test(data.substr(0, 900000), threads, 900000);
+      pass &= test(data, threads, 900000);
+      pass &= test(data.substr(0, 100000), threads, 1000);
+    }
+
+  if (!pass) return 1;
+
+  std::cerr << "All round trips passed\n";
+  return 0;
+}
@@ -0,0 +1,50 @@
+#include <magnet/math/correlators.hpp>
+#include <iostream>
+
+int main()
+{
+  const size_t length = 6, scaling = 3;
+  magnet::math::MultiTauHistory<size_t> history(length, scaling);
+
+  //Each sample holds the push number, so each stored sample can be
+  //checked against the time it should have been taken
+  for (size_t count(0); count < 5000; ++count)
+    {
+      history.push(std::vector<size_t>(1, count));
+
+      size_t expectedUpdates = 1;
+      for (size_t period(scaling); count && !(count % period) && (period <= count); period *= scaling)
+	++expectedUpdates;
+
+      if (history.updatedLevels() != expectedUpdates)
+	{ 
+	  std::cout << "Push " << count << " updated " << history.updatedLevels() 
+		    << " levels, expected " << expectedUpdates << std::endl; 
+	  return 1; 
+	}
+
+      for (size_t level(0); level < history.levels(); ++level)
+	{
+	  const size_t period = history.period(level);
+	  const size_t latest = count - count % period;
+
+	  if (history.size(level) != std::min(length, latest / period + 1))
+	    { std::cout << "Level " << level << " has the wrong size at push " << count << std::endl; return 1; }
+
+	  for (size_t step(0); step < history.size(level); ++step)
+	    if (history.get(level, step)[0] != latest - step * period)
+	      { 
+		std::cout << "Level " << level << " step " << step << " at push " << count 
+			  << " holds sample " << history.get(level, step)[0] 
+			  << ", expected " << latest - step * period << std::endl; 
+		return 1; 
+	      }
+	}
+    }
+
+  //The levels must cover every lag without gaps
+  if (history.firstStep(1) * scaling > length)
+    { std::cout << "The levels do not overlap" << std::endl; return 1; }
+
+  return 0;
+}
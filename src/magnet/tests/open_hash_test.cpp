@@ -0,0 +1,118 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <magnet/containers/open_hash.hpp>
+#include <boost/tr1/unordered_map.hpp>
+#include <iostream>
+#include <cstdlib>
+
+//Pack two IDs into a key, as done for pairs of particles
+uint64_t key(size_t a, size_t b) { return (uint64_t(a) << 32) | b; }
+
+int main()
+{
+  magnet::containers::OpenHashMap<int> map;
+  std::tr1::unordered_map<uint64_t, int> reference;
+
+  //Random insertions, updates and erasures over a small key space
+  //so that long probe sequences are built and broken up
+  std::srand(42);
+  for (size_t step(0); step < 200000; ++step)
+    {
+      const uint64_t k = key(std::rand() % 64, std::rand() % 64);
+      switch (std::rand() % 3)
+	{
+	case 0:
+	  map[k] = step;
+	  reference[k] = step;
+	  break;
+	case 1:
+	  if (map.erase(k) != reference.erase(k))
+	    {
+	      std::cerr << "Erase of key " << k << " disagreed at step " << step << std::endl;
+	      return 1;
+	    }
+	  break;
+	default:
+	  {
+	    magnet::containers::OpenHashMap<int>::iterator it = map.find(k);
+	    if (it != map.end())
+	      {
+		++it->second;
+		++reference[k];
+	      }
+	    else if (reference.count(k))
+	      {
+		std::cerr << "Key " << k << " was lost at step " << step << std::endl;
+		return 1;
+	      }
+	  }
+	}
+
+      if (map.size() != reference.size())
+	{
+	  std::cerr << "Size mismatch at step " << step << std::endl;
+	  return 1;
+	}
+    }
+
+  //Every entry must be found by iteration and by lookup
+  size_t count = 0;
+  for (magnet::containers::OpenHashMap<int>::const_iterator it = map.begin(); it != map.end(); ++it, ++count)
+    if (!reference.count(it->first) || (reference[it->first] != it->second))
+      {
+	std::cerr << "Key " << it->first << " has the wrong value" << std::endl;
+	return 1;
+      }
+
+  if (count != reference.size())
+    {
+      std::cerr << "Iteration visited " << count << " of " << reference.size() << " entries" << std::endl;
+      return 1;
+    }
+
+  if (map.load_factor() > map.max_load_factor())
+    {
+      std::cerr << "Load factor " << map.load_factor() << " is too high" << std::endl;
+      return 1;
+    }
+
+  //The set variant and erasing everything
+  magnet::containers::OpenHashSet set;
+  for (size_t i(0); i < 1000; ++i)
+    if (!set.insert(key(i, i + 1)).second || set.insert(key(i, i + 1)).second)
+      {
+	std::cerr << "Set insertion failed for " << i << std::endl;
+	return 1;
+      }
+
+  for (size_t i(0); i < 1000; ++i)
+    if (!set.erase(key(i, i + 1)) || set.count(key(i, i + 1)))
+      {
+	std::cerr << "Set erasure failed for " << i << std::endl;
+	return 1;
+      }
+
+  if (!set.empty() || (set.begin() != set.end()))
+    {
+      std::cerr << "Set is not empty" << std::endl;
+      return 1;
+    }
+
+  std::cout << "Open hash table tests passed" << std::endl;
+  return 0;
+}
@@ -40,6 +40,156 @@ function testrun {
 	>> dens$dens.dat
 }
 
+#Compare the event rate of the Future Event List (Sorter)
+#implementations on the same configuration
+function sortertest {
+    $dynamod -m 0 -d $dens -C $C > /dev/null
+    
+    for sorter in BoundedPQ BoundedPQMinMax3 CBT Calendar CalendarMinMax3; do
+	bzcat config.out.xml.bz2 \
+	    | xmlstarlet ed -u '//Simulation/Scheduler/Sorter/@Type' -v $sorter \
+	    | bzip2 > sorter.xml.bz2
+	
+	> speedvals
+	for i in $(seq 0 $NUMRUN); do
+	    echo -n "Running test $i for $C cells, $dens density and the $sorter sorter...."
+	    val=$($dynarun sorter.xml.bz2 -c $NCOLL | grep "Avg Events/s" | gawk '{print $3}')
+	    echo $val
+	    echo $val >> speedvals
+	done
+	echo $C $sorter $(cat speedvals | gawk 'BEGIN {sum=0; sqrsum=0} { sum += $1; sqrsum += $1*$1} END {print "Events/s Avg "sum/NR" Dev "sqrt((sqrsum - sum * sum /NR) / NR)}') \
+	    | tee -a sorters.dens$dens.dat
+    done
+    rm -f sorter.xml.bz2
+}
+
+#Measure the cost of the cell transition events on dense systems.
+#Run it with the dynarun variable pointing at the builds to compare.
+function celltest {
+    $dynamod -m 0 -d $dens -C $C > /dev/null
+    
+    > speedvals
+    > cellvals
+    for i in $(seq 0 $NUMRUN); do
+	echo -n "Running test $i for $C cells and $dens density...."
+	val=$($dynarun config.out.xml.bz2 -c $NCOLL | grep "Avg Events/s" | gawk '{print $3}')
+	echo $val
+	echo $val >> speedvals
+	#The fraction of the events which are cell transitions
+	bzcat output.xml.bz2 \
+	    | xmlstarlet sel -t -v '/OutputData/Misc/Duration/@Events' -o " " \
+	    -v 'sum(/OutputData/Misc/EventCounters/Entry[@Type="Global"]/@Count)' -n \
+	    | gawk '{print $2 / $1}' >> cellvals
+    done
+    echo $C $dens $(cat speedvals | gawk 'BEGIN {sum=0; sqrsum=0} { sum += $1; sqrsum += $1*$1} END {print "Events/s Avg "sum/NR" Dev "sqrt((sqrsum - sum * sum /NR) / NR)}') \
+	$(cat cellvals | gawk 'BEGIN {sum=0} { sum += $1} END {print "Cell event fraction "sum/NR}') \
+	| tee -a cells.dat
+}
+
+#Measure the event rate with the scalar and the batched (structure
+#of arrays) event predictors, which both walk the neighbourhood of
+#the particles on every event. Run it with the dynarun variable
+#pointing at the builds to compare.
+function nbtest {
+    $dynamod -m 0 -d $dens -C $C > /dev/null
+
+    for opt in "" "--particle-soa"; do
+	> speedvals
+	for i in $(seq 0 $NUMRUN); do
+	    echo -n "Running test $i for $C cells, $dens density and options \"$opt\"...."
+	    val=$($dynarun config.out.xml.bz2 -c $NCOLL $opt | grep "Avg Events/s" | gawk '{print $3}')
+	    echo $val
+	    echo $val >> speedvals
+	done
+	echo $C $dens "$opt" $(cat speedvals | gawk 'BEGIN {sum=0; sqrsum=0} { sum += $1; sqrsum += $1*$1} END {print "Events/s Avg "sum/NR" Dev "sqrt((sqrsum - sum * sum /NR) / NR)}') \
+	    | tee -a neighbours.dat
+    done
+}
+
+#Measure the cost of the wall events with a large triangle mesh. A
+#corrugated sheet of 2*$M*$M triangles is spliced into a hard sphere
+#configuration (as point particles, to avoid initial overlaps).
+function meshtest {
+    $dynamod -m 0 -d $dens -C $C > /dev/null
+    L=$(bzcat config.out.xml.bz2 | xmlstarlet sel -t -v '//Simulation/SimulationSize/@x')
+
+    gawk -v L=$L -v M=$M 'BEGIN {
+        print "<Local Type=\"TriangleMesh\" Name=\"Sheet\" Elasticity=\"1\" Diameter=\"0\">";
+        print "<IDRange Type=\"All\"/>";
+        print "<Vertices>";
+        for (i = 0; i <= M; ++i)
+          for (j = 0; j <= M; ++j)
+            print -L/2 + i * L / M, -L/2 + j * L / M, 0.1 * sin(6.283185 * 4 * i / M) * sin(6.283185 * 4 * j / M);
+        print "</Vertices>";
+        print "<Elements>";
+        for (i = 0; i < M; ++i)
+          for (j = 0; j < M; ++j)
+            {
+              a = i * (M + 1) + j;
+              print a, a + M + 1, a + 1;
+              print a + 1, a + M + 1, a + M + 2;
+            }
+        print "</Elements>";
+        print "</Local>";
+    }' > mesh.xml
+
+    bzcat config.out.xml.bz2 | gawk '
+        /<Locals\/>/ { print "<Locals>"; system("cat mesh.xml"); print "</Locals>"; next }
+        /<\/Locals>/ { system("cat mesh.xml") }
+        { print }' | bzip2 > mesh.xml.bz2
+
+    > speedvals
+    for i in $(seq 0 $NUMRUN); do
+	echo -n "Running test $i for $C cells, $dens density and a $M x $M mesh...."
+	val=$($dynarun mesh.xml.bz2 -c $NCOLL | grep "Avg Events/s" | gawk '{print $3}')
+	echo $val
+	echo $val >> speedvals
+    done
+    echo $C $M $(cat speedvals | gawk 'BEGIN {sum=0; sqrsum=0} { sum += $1; sqrsum += $1*$1} END {print "Events/s Avg "sum/NR" Dev "sqrt((sqrsum - sum * sum /NR) / NR)}') \
+	| tee -a mesh.dat
+    rm -f mesh.xml mesh.xml.bz2
+}
+
+#Triangle mesh mode, run as "./speed.sh mesh"
+if [ "$1" == "mesh" ]; then
+    dens=0.5
+    C=20
+    for M in 10 40 160; do
+	meshtest
+    done
+    exit 0
+fi
+
+#Neighbour walk mode, run as "./speed.sh neighbours"
+if [ "$1" == "neighbours" ]; then
+    for dens in 0.5 1.0; do
+	for C in 10 30; do
+	    nbtest
+	done
+    done
+    exit 0
+fi
+
+#Cell transition mode, run as "./speed.sh cells"
+if [ "$1" == "cells" ]; then
+    for dens in 0.9 1.0 1.1; do
+	for C in 20 40 60; do
+	    celltest
+	done
+    done
+    exit 0
+fi
+
+#Sorter comparison mode, run as "./speed.sh sorters"
+if [ "$1" == "sorters" ]; then
+    for dens in 0.5 0.9; do
+	for C in 10 20 40 60; do
+	    sortertest
+	done
+    done
+    exit 0
+fi
+
 for elas in 1.0; do # 0.4 0.5 0.6 0.7 0.8 0.9 
     for dens in 0.8; do
 	#> dens$dens.dat
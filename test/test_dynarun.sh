@@ -17,6 +17,7 @@
 
 Dynarun="../bin/dynarun"
 Dynamod="../bin/dynamod"
+Dynatrace="../bin/dynatrace"
 
 #Next is the name of XML starlet
 Xml="xml"
@@ -29,6 +30,10 @@ if [ ! -x $Dynamod ]; then
     echo "Could not find dynamod, have you built it?"
 fi
 
+if [ ! -x $Dynatrace ]; then 
+    echo "Could not find dynatrace, have you built it?"
+fi
+
 which $Xml || Xml="xmlstarlet"
 
 which $Xml || `echo "Could not find XMLStarlet"; exit`
@@ -38,6 +43,45 @@ which gawk || `echo "Could not find gawk"; exit`
 #We create a local copy of the executables, so that recompilation won't break running tests
 cp $Dynamod ./dynamod
 cp $Dynarun ./dynarun
+cp $Dynatrace ./dynatrace
+
+function AsyncReplexTest {
+    #Every temperature of an asynchronous replica exchange must run
+    #all of its intervals and attempt an exchange at each step it has
+    #a partner. The two hot temperatures run many more events in an
+    #interval, so the cold ones run ahead and wait at different steps.
+    temperature=(0.01 0.02 25 50)
+    for i in 0 1 2 3; do
+	./dynamod -s 1 -m 0 -C 5 -T ${temperature[$i]} \
+	    -o config.$i.start.xml.bz2 > /dev/null 2>&1
+    done
+
+    timeout 600 ./dynarun --engine 2 -N 4 --replex-swap-mode 5 -i 1 -f 20 \
+	config.*.start.xml.bz2 > /dev/null 2>&1
+
+    #The coldest temperature needs 20 intervals, plus the first
+    #(empty) interval. The pairs alternate as in swap mode 1.
+    if [ ! -e replex.stats ] || ! gawk -v steps=21 -v nTemps=4 '
+	/^T Runs/ { table = 1; next }
+	table && NF {
+	    attempts = 0
+	    for (s = 0; s < steps; ++s) {
+		first = (s % 2) ? 0 : 1
+		if (row < first) continue
+		if (((row - first) % 2) && (row - 1 >= 0)) ++attempts
+		else if (!((row - first) % 2) && (row + 1 < nTemps)) ++attempts
+	    }
+	    if (($2 != steps) || ($8 != attempts) || ($9 > $8)) failed = 1
+	    ++row
+	}
+	END { exit (failed || (row != nTemps)) }' replex.stats; then
+	echo "AsyncReplexTest -: FAILED"
+	exit 1
+    fi
+
+    rm -f config.*.start.xml.bz2 config.*.end.xml.bz2 output.*.xml.bz2 *.dat replex.stats
+    echo "AsyncReplexTest -: PASSED"
+}
 
 function HS_replex_test {
     for i in $(seq 0 2); do
@@ -370,12 +414,165 @@ function ThermostatTest {
 	tmp.xml.bz2 run.log
 }
 
+function BinaryConfigTest {
+    #Each configuration is passed through the binary configuration
+    #files and must come back unaltered. The lines are sorted before
+    #the comparison as the order of the capture map entries is not
+    #fixed.
+    for mode in 0 1 9 26; do
+	./dynamod -s 1 -m $mode -o ref.xml.bz2 > /dev/null 2>&1
+	./dynamod ref.xml.bz2 -o ref.xml > /dev/null 2>&1
+	./dynamod ref.xml.bz2 -o config.bin > /dev/null 2>&1
+	./dynamod config.bin -o config.bin.bz2 > /dev/null 2>&1
+	./dynamod config.bin.bz2 -o test.xml > /dev/null 2>&1
+
+	if [ ! -e test.xml ] || ! cmp -s <(sort ref.xml) <(sort test.xml); then
+	    echo "BinaryConfigTest -: FAILED for packing mode $mode"
+	    exit 1
+	fi
+
+	rm -f ref.xml.bz2 ref.xml config.bin config.bin.bz2 test.xml
+    done
+
+    echo "BinaryConfigTest -: PASSED"
+}
+
+function CaptureMapTest {
+    #The capture map of a square well fluid is rebuilt from the grid
+    #of cells (with and without threads). It must match the map kept
+    #up to date by the events and, through --check, a test of every
+    #pair of particles.
+    ./dynamod -s 1 -m 1 -C 5 -o start.xml > /dev/null 2>&1
+    ./dynarun -f 2.5 start.xml -o run.xml > /dev/null 2>&1
+    sed -e '/<CaptureMap>/,/<\/CaptureMap>/d' run.xml > nomap.xml
+    grep "<Pair" run.xml | sort > ref.map
+
+    for threads in 1 2; do
+	./dynamod -N $threads --check nomap.xml -o test.xml > run.log 2>&1
+	grep "<Pair" test.xml | sort > test.map
+
+	if [ ! -s ref.map ] || grep -q "capture map" run.log || ! cmp -s ref.map test.map; then
+	    echo "CaptureMapTest -: FAILED with $threads threads"
+	    exit 1
+	fi
+    done
+
+    rm -f start.xml run.xml nomap.xml test.xml ref.map test.map run.log
+    echo "CaptureMapTest -: PASSED"
+}
+
+function EmptyParticleDataTest {
+    #A configuration without particles has a self-closing ParticleData
+    #tag, which must be loaded and written back unaltered
+    ./dynamod -s 1 -m 0 -C 2 -o ref.xml > /dev/null 2>&1
+    sed -e '/<ParticleData>/,/<\/ParticleData>/c\  <ParticleData/>' ref.xml > empty.xml
+    ./dynamod empty.xml -o test.xml > /dev/null 2>&1
+
+    if [ ! -e test.xml ] || ! cmp -s empty.xml test.xml; then
+	echo "EmptyParticleDataTest -: FAILED"
+	exit 1
+    fi
+
+    rm -f ref.xml empty.xml test.xml
+    echo "EmptyParticleDataTest -: PASSED"
+}
+
+function CompressionTest {
+    #A configuration written by the parallel bzip2 compressor must
+    #match the serial bzip2 output once decompressed, and must survive
+    #a pass through the gzip files.
+    ./dynamod -s 1 -m 0 -C 10 -o ref.xml > /dev/null 2>&1
+    ./dynarun -c 1 ref.xml -o serial.xml > /dev/null 2>&1
+    ./dynarun -c 1 -N 2 ref.xml -o parallel.xml.bz2 --out-data-file output.xml.gz > /dev/null 2>&1
+    ./dynamod parallel.xml.bz2 -o direct.xml > /dev/null 2>&1
+    ./dynamod parallel.xml.bz2 -o config.xml.gz > /dev/null 2>&1
+    ./dynamod config.xml.gz -o test.xml > /dev/null 2>&1
+
+    if [ ! -e parallel.xml.bz2 ] || ! cmp -s <(bzcat parallel.xml.bz2) serial.xml \
+	|| ! cmp -s direct.xml test.xml || ! zcat output.xml.gz > /dev/null 2>&1; then
+	echo "CompressionTest -: FAILED"
+	exit 1
+    fi
+
+    rm -f ref.xml serial.xml parallel.xml.bz2 output.xml.gz direct.xml \
+	config.xml.gz test.xml output.xml.bz2
+    echo "CompressionTest -: PASSED"
+}
+
+function SnapshotTest {
+    #The snapshots are written by a background thread, they must all
+    #be complete once dynarun exits
+    ./dynamod -s 1 -m 0 > /dev/null 2>&1
+    ./dynarun -c 100000 config.out.xml.bz2 --snapshot 0.5 > /dev/null 2>&1
+
+    for i in 0 1 2 3; do
+	if ! bzip2 -t Snapshot.$i.xml.bz2 > /dev/null 2>&1 \
+	    || ! bzip2 -t Snapshot.output.$i.xml.bz2 > /dev/null 2>&1 \
+	    || ! ./dynamod Snapshot.$i.xml.bz2 -o test.xml > /dev/null 2>&1; then
+	    echo "SnapshotTest -: FAILED for snapshot $i"
+	    exit 1
+	fi
+    done
+
+    rm -f Snapshot.*.xml.bz2 config.out.xml.bz2 config.end.xml.bz2 \
+	output.xml.bz2 test.xml
+    echo "SnapshotTest -: PASSED"
+}
+
+function AsyncOutputTest {
+    #The output plugins run on the analysis thread must give the same
+    #results as when they are run by the event loop
+    ./dynamod -s 1 -m 1 -C 7 > /dev/null 2>&1
+    for mode in sync async; do
+	flag=""
+	if [ $mode = async ]; then flag="--async-output"; fi
+	./dynarun -c 200000 config.out.xml.bz2 $flag -L MFT -L CollisionMatrix \
+	    -L EventEffects -o config.$mode.xml.bz2 --out-data-file output.$mode.xml \
+	    > /dev/null 2>&1
+	sed -n -e '/<MFT>/,/<\/MFT>/p' -e '/<CollCounters>/,/<\/CollCounters>/p' \
+	    -e '/<EventEffects>/,/<\/EventEffects>/p' output.$mode.xml > plugins.$mode.xml
+    done
+
+    if [ ! -s plugins.sync.xml ] || ! cmp -s plugins.sync.xml plugins.async.xml; then
+	echo "AsyncOutputTest -: FAILED"
+	exit 1
+    fi
+
+    rm -f config.out.xml.bz2 config.sync.xml.bz2 config.async.xml.bz2 \
+	output.sync.xml output.async.xml plugins.sync.xml plugins.async.xml
+    echo "AsyncOutputTest -: PASSED"
+}
+
+function EventTraceTest {
+    #Replaying the event trace of a run must give the same event
+    #statistics as the run itself. The snapshots write the output of
+    #the plugins partway through the run.
+    ./dynamod -s 1 -m 1 -C 7 > /dev/null 2>&1
+    ./dynarun -c 200000 config.out.xml.bz2 -L EventTrace -L MFT -L CollisionMatrix \
+	--snapshot 2 -o config.end.xml.bz2 --out-data-file output.run.xml > /dev/null 2>&1
+    ./dynatrace config.out.xml.bz2 eventtrace.gz -N 2 -L MFT -L CollisionMatrix \
+	-o output.trace.xml > /dev/null 2>&1
+    for run in run trace; do
+	sed -n -e '/<MFT>/,/<\/MFT>/p' -e '/<CollCounters>/,/<\/CollCounters>/p' \
+	    output.$run.xml > plugins.$run.xml
+    done
+
+    if [ ! -s plugins.run.xml ] || ! cmp -s plugins.run.xml plugins.trace.xml; then
+	echo "EventTraceTest -: FAILED"
+	exit 1
+    fi
+
+    rm -f config.out.xml.bz2 config.end.xml.bz2 eventtrace.gz Snapshot.*.xml.bz2 \
+	output.run.xml output.trace.xml plugins.run.xml plugins.trace.xml
+    echo "EventTraceTest -: PASSED"
+}
+
 function HardSphereTest {
     > run.log
 
     ./dynamod -s 1 -m 0 &> run.log    
-    ./dynarun -c 500000 config.out.xml.bz2 >> run.log 2>&1
-    ./dynarun -c 1000000 config.out.xml.bz2 >> run.log 2>&1
+    ./dynarun -c 500000 config.out.xml.bz2 $1 >> run.log 2>&1
+    ./dynarun -c 1000000 config.out.xml.bz2 $1 >> run.log 2>&1
     
     if [ -e output.xml.bz2 ]; then
 	if [ $(bzcat output.xml.bz2 \
@@ -400,8 +597,8 @@ function SquareWellTest {
     > run.log
 
     ./dynamod -s1 -m 1 -T 1 &> run.log    
-    ./dynarun -c 3000000 config.out.xml.bz2 >> run.log 2>&1
-    ./dynarun -c 1000000 config.out.xml.bz2 >> run.log 2>&1
+    ./dynarun -c 3000000 config.out.xml.bz2 $1 >> run.log 2>&1
+    ./dynarun -c 1000000 config.out.xml.bz2 $1 >> run.log 2>&1
     
     MFT="0.036"
 
@@ -723,6 +920,10 @@ echo "Testing basic system, zero + infinite time events, hard sphere, PBC, Neigh
 cannon "NeighbourList" "CBT"
 echo "Testing basic system, zero + infinite time events, hard sphere, PBC, Neighbour lists + scheduler, globals, boundedPQ"
 cannon "NeighbourList" "BoundedPQ"
+echo "Testing basic system, zero + infinite time events, hard spheres, PBC, Dumb Scheduler, Calendar"
+cannon "Dumb" "Calendar"
+echo "Testing basic system, zero + infinite time events, hard sphere, PBC, Neighbour lists + scheduler, globals, Calendar"
+cannon "NeighbourList" "Calendar"
 
 echo ""
 echo "INTERACTIONS+Dynamod Systems"
@@ -732,6 +933,32 @@ echo "Testing binary hard spheres, NeighbourLists and BoundedPQ's"
 BinarySphereTest "Cells2"
 echo "Testing Square Wells, Thermostats, NeighbourLists and BoundedPQ's"
 SquareWellTest
+echo "Testing Hard Spheres with the batched event predictors"
+HardSphereTest "--particle-soa"
+echo "Testing Square Wells with the batched event predictors"
+SquareWellTest "--particle-soa"
+echo "Testing Square Wells with a parallel event list build"
+SquareWellTest "-N 2"
+echo "Testing Square Wells with periodic particle reordering"
+SquareWellTest "--reorder 10"
+echo "Testing the capture map rebuild on a grid of cells"
+CaptureMapTest
+echo "Testing Square Wells with the event loop profiler"
+SquareWellTest "--profile"
+echo "Testing Hard Spheres with the multiple-tau MSD correlator"
+HardSphereTest "-L MSDCorrelator:Length=10"
+echo "Testing the binary configuration files"
+BinaryConfigTest
+echo "Testing configuration files without particles"
+EmptyParticleDataTest
+echo "Testing the parallel bzip2 and gzip compressed files"
+CompressionTest
+echo "Testing the background snapshot writer"
+SnapshotTest
+echo "Testing the batched output plugins on the analysis thread"
+AsyncOutputTest
+echo "Testing the event trace writer and replay"
+EventTraceTest
 echo "Testing infinitely heavy particles"
 HeavySphereTest
 echo "Testing Lines, NeighbourLists and BoundedPQ's"
@@ -788,3 +1015,7 @@ echo "Testing replica exchange of hard spheres"
 HS_replex_test "NeighbourList"
 echo "Testing replica exchange of hard spheres with 3 threads"
 HS_replex_test "NeighbourList" "-N3"
+echo "Testing asynchronous replica exchange of hard spheres with 3 threads"
+HS_replex_test "NeighbourList" "-N3 --replex-swap-mode 5"
+echo "Testing asynchronous replica exchange with unequal interval costs"
+AsyncReplexTest